@@ -4,6 +4,7 @@
 #include <stdexcept>
 
 #include "F1InputState.hpp"
+#include "tkf1/F1Device.hpp"
 
 /**
  * Representation of a Traktor Kontrol F1 HID device
@@ -22,14 +23,10 @@ public:
 	 * Representation of data to be sent to the device
 	 *
 	 * As Traktor Kontrol F1 only supports setting LEDs as HID output, the
-	 * elements represent the LED brightness values (ranging vom 0x00 to 0x7f).
+	 * elements represent the LED brightness values (ranging vom 0x00 to 0x7f)
+	 * and the characters of the segment display.
 	 */
-	struct output
-	{
-		constexpr static uint8_t report_id{0x80};
-		std::array<std::array<uint8_t, 3>, 16> matrix_btns;
-		std::array<uint8_t, 4> stop_btns;
-	};
+	using output = F1Device::OutputState;
 
 	/**
 	 * Create a F1HidDev representing the hidraw device at the given file
@@ -58,6 +55,8 @@ public:
 	 * This method waits until the Traktor Kontrol F1 sends new data (i.e. the
 	 * inputs on the F1 change). It writes the new state into an internal cache
 	 * which can be retrieved using {@link read_cached()}.
+	 *
+	 * The report is decoded by the shared {@link F1Device::decode_input()}.
 	 */
 	const input& read();
 	/**
@@ -74,6 +73,8 @@ public:
 
 	/**
 	 * Write the given output to the Traktor Kontrol F1
+	 *
+	 * The output is encoded by the shared {@link F1Device::encode_output()}.
 	 */
 	void write(const output& out) const;
 
@@ -85,8 +86,8 @@ public:
 	 * internal representation. This representation can then be assigned to an
 	 * {@link output} object to be sent to the F1.
 	 */
-	constexpr static std::array<uint8_t, 3> rgb2color(uint8_t r, uint8_t g,
-	                                                  uint8_t b)
+	constexpr static F1Device::ButtonColor rgb2color(uint8_t r, uint8_t g,
+	                                                 uint8_t b)
 	{
 		return {b, r, g};
 	}
@@ -1,62 +1,50 @@
 #include "F1InputState.hpp"
 
-F1InputChange operator-(const F1InpuState& new_state,
-                        const F1InpuState& old_state)
+namespace
 {
-	constexpr static bool OFF{false};
-	constexpr static bool ON{true};
-
-	F1InputChange diff;
+template <size_t N>
+void diff_buttons(const std::bitset<N>& new_btns,
+                  const std::bitset<N>& old_btns,
+                  F1InputMask<N>& pressed,
+                  F1InputMask<N>& released)
+{
+	const F1InputMask<N> new_mask{new_btns};
+	const F1InputMask<N> old_mask{old_btns};
+	pressed = new_mask & ~old_mask;
+	released = old_mask & ~new_mask;
+}
 
-	for (size_t i = 0; i < new_state.matrix_btns.size(); ++i) {
-		auto old_btn_state = old_state.matrix_btns[i];
-		auto new_btn_state = new_state.matrix_btns[i];
-		if (old_btn_state == OFF && new_btn_state == ON) {
-			diff.pressed_buttons.matrix.push_back(i);
-		} else if (old_btn_state == ON && new_btn_state == OFF) {
-			diff.released_buttons.matrix.push_back(i);
+template <size_t N>
+void diff_encoders(const std::array<uint16_t, N>& new_values,
+                   const std::array<uint16_t, N>& old_values,
+                   F1EncoderChange<N>& change)
+{
+	for (size_t i = 0; i < N; ++i) {
+		if (new_values[i] != old_values[i]) {
+			change.set(i, new_values[i]);
 		}
 	}
+}
+} // namespace
 
-	for (size_t i = 0; i < new_state.special_btns.size(); ++i) {
-		auto old_btn_state = old_state.special_btns[i];
-		auto new_btn_state = new_state.special_btns[i];
-		if (old_btn_state == OFF && new_btn_state == ON) {
-			diff.pressed_buttons.special.push_back(i);
-		} else if (old_btn_state == ON && new_btn_state == OFF) {
-			diff.released_buttons.special.push_back(i);
-		}
-	}
+F1InputChange operator-(const F1InpuState& new_state,
+                        const F1InpuState& old_state)
+{
+	F1InputChange diff;
 
-	for (size_t i = 0; i < new_state.stop_btns.size(); ++i) {
-		auto old_btn_state = old_state.stop_btns[i];
-		auto new_btn_state = new_state.stop_btns[i];
-		if (old_btn_state == OFF && new_btn_state == ON) {
-			diff.pressed_buttons.stop.push_back(i);
-		} else if (old_btn_state == ON && new_btn_state == OFF) {
-			diff.released_buttons.stop.push_back(i);
-		}
-	}
+	diff_buttons(new_state.matrix_btns, old_state.matrix_btns,
+	             diff.pressed_buttons.matrix, diff.released_buttons.matrix);
+	diff_buttons(new_state.special_btns, old_state.special_btns,
+	             diff.pressed_buttons.special, diff.released_buttons.special);
+	diff_buttons(new_state.stop_btns, old_state.stop_btns,
+	             diff.pressed_buttons.stop, diff.released_buttons.stop);
 
 	diff.wheel_diff = new_state.wheel - old_state.wheel;
 
 	diff.wheel = new_state.wheel;
 
-	for (size_t i = 0; i < new_state.knobs.size(); ++i) {
-		auto old_knob_state = old_state.knobs.at(i);
-		auto new_knob_state = new_state.knobs.at(i);
-		if (new_knob_state != old_knob_state) {
-			diff.knobs.push_back({i, new_knob_state});
-		}
-	}
-
-	for (size_t i = 0; i < new_state.faders.size(); ++i) {
-		auto old_fader_state = old_state.faders.at(i);
-		auto new_fader_state = new_state.faders.at(i);
-		if (new_fader_state != old_fader_state) {
-			diff.faders.push_back({i, new_fader_state});
-		}
-	}
+	diff_encoders(new_state.knobs, old_state.knobs, diff.knobs);
+	diff_encoders(new_state.faders, old_state.faders, diff.faders);
 
 	return diff;
 }
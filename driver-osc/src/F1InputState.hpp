@@ -6,9 +6,15 @@
 #pragma once
 
 #include <array>
+#include <bit>
 #include <bitset>
+#include <cstddef>
 #include <cstdint>
-#include <vector>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "tkf1/F1Device.hpp"
 
 enum class F1InputButtonIdx : uint8_t
 {
@@ -18,9 +24,11 @@ enum class F1InputButtonIdx : uint8_t
 /**
  * Representation of the input as received by the Traktor Kontrol F1
  *
- * This struct provides the input as it is received from the F1 in a prepared
- * form (i.e. correct endianness, bitsets instead of integers, correct names
- * instead of offsets).
+ * This is the input state of the shared tkf1 library (see
+ * {@link F1Device::InputState}), so both drivers decode reports the same way.
+ * It provides the input as it is received from the F1 in a prepared form (i.e.
+ * correct endianness, bitsets instead of integers, correct names instead of
+ * offsets).
  *
  * Members in this class represent the buttons which conform to their names,
  * i.e. matrix represents all buttons of the button matrix, stop represents all
@@ -33,15 +41,205 @@ enum class F1InputButtonIdx : uint8_t
  * the rest of the hardware. To avoid further processing complexity in the
  * backend, all of these buttons are represented using a single array.
  */
-struct F1InpuState
+using F1InpuState = F1Device::InputState;
+
+/**
+ * Fixed-size set of input indices (e.g. pressed buttons), stored as bitmask
+ *
+ * Iterating the mask yields the indices of all set bits in ascending order.
+ * Neither creating, combining nor iterating masks allocates, and iteration
+ * only touches set bits (using std::countr_zero).
+ */
+template <size_t N>
+class F1InputMask
 {
-	uint8_t report_id;
-	std::bitset<16> matrix_btns;
-	std::bitset<9> special_btns;
-	std::bitset<4> stop_btns;
-	uint8_t wheel;
-	std::array<uint16_t, 4> knobs;
-	std::array<uint16_t, 4> faders;
+public:
+	using word = uint32_t;
+	static_assert(N <= std::numeric_limits<word>::digits);
+	constexpr static word ALL{N == std::numeric_limits<word>::digits
+	                            ? ~word{0}
+	                            : (word{1} << N) - 1};
+
+	/**
+	 * Iterator over the indices of the set bits
+	 */
+	class iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = uint8_t;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = uint8_t;
+
+		constexpr iterator() = default;
+		constexpr explicit iterator(word bits) : bits(bits)
+		{}
+
+		constexpr uint8_t operator*() const noexcept
+		{
+			return static_cast<uint8_t>(std::countr_zero(bits));
+		}
+		constexpr iterator& operator++() noexcept
+		{
+			bits &= bits - 1;
+			return *this;
+		}
+		constexpr iterator operator++(int) noexcept
+		{
+			iterator old = *this;
+			++*this;
+			return old;
+		}
+		constexpr bool operator==(const iterator&) const noexcept = default;
+
+	private:
+		word bits{0};
+	};
+
+	constexpr F1InputMask() = default;
+	constexpr explicit F1InputMask(word bits) : bits(bits & ALL)
+	{}
+	explicit F1InputMask(const std::bitset<N>& bitset)
+	    : bits(static_cast<word>(bitset.to_ulong()))
+	{}
+
+	constexpr void set(size_t i) noexcept
+	{
+		bits |= word{1} << i;
+	}
+	constexpr void reset(size_t i) noexcept
+	{
+		bits &= ~(word{1} << i);
+	}
+	constexpr bool test(size_t i) const noexcept
+	{
+		return (bits >> i) & 1U;
+	}
+	constexpr bool empty() const noexcept
+	{
+		return bits == 0;
+	}
+	constexpr size_t size() const noexcept
+	{
+		return std::popcount(bits);
+	}
+	constexpr word to_word() const noexcept
+	{
+		return bits;
+	}
+
+	constexpr iterator begin() const noexcept
+	{
+		return iterator{bits};
+	}
+	constexpr iterator end() const noexcept
+	{
+		return iterator{};
+	}
+
+	constexpr F1InputMask operator~() const noexcept
+	{
+		return F1InputMask{~bits};
+	}
+	constexpr F1InputMask operator&(F1InputMask o) const noexcept
+	{
+		return F1InputMask{bits & o.bits};
+	}
+	constexpr F1InputMask operator|(F1InputMask o) const noexcept
+	{
+		return F1InputMask{bits | o.bits};
+	}
+	constexpr F1InputMask operator^(F1InputMask o) const noexcept
+	{
+		return F1InputMask{bits ^ o.bits};
+	}
+	constexpr bool operator==(const F1InputMask&) const noexcept = default;
+
+private:
+	word bits{0};
+};
+
+/**
+ * Fixed-size set of changed encoder values (knobs or faders)
+ *
+ * Iterating yields (index, new value) pairs of all changed encoders in
+ * ascending order.
+ */
+template <size_t N>
+class F1EncoderChange
+{
+public:
+	using value_type = std::pair<uint8_t, uint16_t>;
+
+	class iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = F1EncoderChange::value_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = value_type;
+
+		constexpr iterator() = default;
+		constexpr iterator(typename F1InputMask<N>::iterator it,
+		                   const std::array<uint16_t, N>* values)
+		    : it(it), values(values)
+		{}
+
+		constexpr value_type operator*() const noexcept
+		{
+			return {*it, (*values)[*it]};
+		}
+		constexpr iterator& operator++() noexcept
+		{
+			++it;
+			return *this;
+		}
+		constexpr iterator operator++(int) noexcept
+		{
+			iterator old = *this;
+			++it;
+			return old;
+		}
+		constexpr bool operator==(const iterator& o) const noexcept
+		{
+			return it == o.it;
+		}
+
+	private:
+		typename F1InputMask<N>::iterator it;
+		const std::array<uint16_t, N>* values{nullptr};
+	};
+
+	/**
+	 * Mark encoder i as changed to the given value
+	 */
+	constexpr void set(size_t i, uint16_t value) noexcept
+	{
+		changed.set(i);
+		values[i] = value;
+	}
+	constexpr bool empty() const noexcept
+	{
+		return changed.empty();
+	}
+	constexpr size_t size() const noexcept
+	{
+		return changed.size();
+	}
+
+	constexpr iterator begin() const noexcept
+	{
+		return {changed.begin(), &values};
+	}
+	constexpr iterator end() const noexcept
+	{
+		return {changed.end(), &values};
+	}
+
+	F1InputMask<N> changed;
+	std::array<uint16_t, N> values{};
 };
 
 /**
@@ -51,24 +249,27 @@ struct F1InpuState
  * Any unchanged values should be left out.
  * The only exception to this is wheel, where the change of input means
  * by wheel_diff != 0.
+ *
+ * All members have a fixed size, so creating and copying changes never
+ * allocates.
  */
 struct F1InputChange
 {
 	struct btn_diff
 	{
-		std::vector<uint8_t> matrix;
-		std::vector<uint8_t> stop;
-		std::vector<uint8_t> special;
+		F1InputMask<F1Device::MATRIX_BUTTONS_NUM> matrix;
+		F1InputMask<F1Device::STOP_BUTTONS_NUM> stop;
+		F1InputMask<F1Device::SPECIAL_BUTTONS_NUM> special;
 	};
 
 	btn_diff pressed_buttons;
 	btn_diff released_buttons;
 
-	int8_t wheel_diff;
-	uint8_t wheel;
+	int8_t wheel_diff{0};
+	uint8_t wheel{0};
 
-	std::vector<std::pair<uint8_t, uint16_t>> knobs;
-	std::vector<std::pair<uint8_t, uint16_t>> faders;
+	F1EncoderChange<F1Device::KNOBS_NUM> knobs;
+	F1EncoderChange<F1Device::FADERS_NUM> faders;
 };
 
 /**
@@ -1,20 +1,18 @@
+#include <algorithm>
 #include <cassert>
 
-#ifndef NDEBUG
-#include <iomanip>
-#endif
-
 #include <jack/midiport.h>
+#include <jack/ringbuffer.h>
 
 #include "F1InputState.hpp"
 #include "JackClient.hpp"
 
-#include "debug.hpp"
+#include "Log.hpp"
 
 void JackClient::connect()
 {
 	assert(!is_connected());
-	debug("Connecting JackClient");
+	LOG_DEBUG("Connecting JackClient");
 
 	jack_status_t status;
 	jack_client_t* client =
@@ -25,7 +23,7 @@ void JackClient::connect()
 		  + std::to_string(status));
 	jack_client.reset(client);
 
-	debug("Registering callbacks");
+	LOG_DEBUG("Registering callbacks");
 	int res = jack_set_process_callback(jack_client.get(), process_cb, this);
 	if (res != 0) {
 		throw JackClientException(
@@ -33,7 +31,7 @@ void JackClient::connect()
 		  + std::to_string(res));
 	}
 
-	debug("Registering out port");
+	LOG_DEBUG("Registering out port");
 	jack_port_t* out = jack_port_register(jack_client.get(),
 	                                      OUT_PORT_NAME,
 	                                      JACK_DEFAULT_MIDI_TYPE,
@@ -43,7 +41,7 @@ void JackClient::connect()
 		throw JackClientException("Failed to create jack port!");
 	out_port.reset(out);
 
-	debug("Activating client");
+	LOG_DEBUG("Activating client");
 	res = jack_activate(client);
 	if (res != 0) {
 		throw JackClientException(
@@ -55,7 +53,7 @@ void JackClient::connect()
 void JackClient::disconnect()
 {
 	assert(is_connected());
-	debug("Disconnecting JackClient");
+	LOG_DEBUG("Disconnecting JackClient");
 	int res = jack_deactivate(jack_client.get());
 	assert(res == 0);
 	res = jack_client_close(jack_client.get());
@@ -65,13 +63,13 @@ void JackClient::disconnect()
 
 void JackClient::push_event(const F1InputChange& event)
 {
-	debug("Pushing event");
+	LOG_DEBUG("Pushing event");
 	{
 		byte_t note_on = MIDI_NOTE_ON | midi_channel;
 		assert(note_on & 0x80);
 		byte_t vel = MIDI_NOTE_ON_VEL;
 		assert((vel & 0x80) == 0);
-		for (auto& btn : event.pressed_buttons.matrix) {
+		for (const auto btn : event.pressed_buttons.matrix) {
 			byte_t key = MIDI_NOTE::MATRIX_BASE + btn;
 			assert((key & 0x80) == 0);
 
@@ -83,7 +81,7 @@ void JackClient::push_event(const F1InputChange& event)
 		assert(note_off & 0x80);
 		byte_t vel = MIDI_NOTE_OFF_VEL;
 		assert((vel & 0x80) == 0);
-		for (auto& btn : event.released_buttons.matrix) {
+		for (const auto btn : event.released_buttons.matrix) {
 			byte_t key = MIDI_NOTE::MATRIX_BASE + btn;
 			assert((key & 0x80) == 0);
 
@@ -98,106 +96,83 @@ void JackClient::push_event(const F1InputChange& event)
 		byte_t cc_off = MIDI_CC_OFF;
 		assert((cc_off & 0x80) == 0);
 
-		for (auto& btn : event.pressed_buttons.stop) {
+		for (const auto btn : event.pressed_buttons.stop) {
 			byte_t cc_controller = MIDI_CONTROLLER::STOP[btn];
 			assert((cc_controller & 0x80) == 0);
 
 			write_midi(cc, cc_controller, cc_on);
 		}
-		for (auto& btn : event.released_buttons.stop) {
+		for (const auto btn : event.released_buttons.stop) {
 			byte_t cc_controller = MIDI_CONTROLLER::STOP[btn];
 			assert((cc_controller & 0x80) == 0);
 
 			write_midi(cc, cc_controller, cc_off);
 		}
-		for (auto& btn : event.pressed_buttons.special) {
+		for (const auto btn : event.pressed_buttons.special) {
 			byte_t cc_controller = MIDI_CONTROLLER::SPECIAL[btn];
 			assert((cc_controller & 0x80) == 0);
 
 			write_midi(cc, cc_controller, cc_on);
 		}
-		for (auto& btn : event.released_buttons.special) {
+		for (const auto btn : event.released_buttons.special) {
 			byte_t cc_controller = MIDI_CONTROLLER::SPECIAL[btn];
 			assert((cc_controller & 0x80) == 0);
 
 			write_midi(cc, cc_controller, cc_off);
 		}
 	}
-}
 
-inline void JackClient::write_midi(byte_t status, byte_t v1, byte_t v2)
-{
-	jack_ringbuffer_t* rb = input_buf.get();
-	JackClient::byte_t midi_event[] = {status, v1, v2};
-	size_t bytes_written =
-	  jack_ringbuffer_write(rb, reinterpret_cast<const char*>(midi_event), 3);
-	assert(bytes_written == 3);
-	created_midi_bytes += 3;
-#ifndef NDEBUG
-	const auto fmtflags = std::cout.flags();
-	std::cout << std::hex << std::setfill('0') << std::setw(2)
-	          << static_cast<int>(status) << ' ' << std::setw(2)
-	          << static_cast<int>(v1) << ' ' << std::setw(2)
-	          << static_cast<int>(v2) << '\n';
-	std::cout.flags(fmtflags);
-#endif
-	debug(std::string{"CM:\t"} + std::to_string(created_midi_bytes) + "\tSM:\t"
-	      + std::to_string(sent_midi_bytes) + "\tBS:\t"
-	      + std::to_string(bytes_in_input_buffer()));
+	if (dropped > 0) {
+		LOG_WARNING("Dropped {} MIDI messages, the buffer is full", dropped);
+		dropped = 0;
+	}
 }
 
-inline size_t JackClient::bytes_in_input_buffer() const
+inline void JackClient::write_midi(byte_t status, byte_t v1, byte_t v2)
 {
-	return jack_ringbuffer_read_space(input_buf.get());
+	// Never wait for the process thread
+	if (input_buf.full()) {
+		++dropped;
+		return;
+	}
+	input_buf.push({status, v1, v2});
 }
 
 int JackClient::process_cb(jack_nframes_t nframes, void* userdata)
 {
 	auto& jc = *reinterpret_cast<JackClient*>(userdata);
 	assert(&jc);
-	jack_ringbuffer_t* in_buf = jc.input_buf.get();
-	assert(in_buf);
 	void* out_buf = jack_port_get_buffer(jc.out_port.get(), nframes);
 	assert(out_buf);
 	jack_midi_clear_buffer(out_buf);
-	if (jc.bytes_in_input_buffer() == 0)
-		return 0;
-
-	size_t bytes_to_send = jc.bytes_in_input_buffer();
-	debug(std::string{"Writing MIDI ("} + std::to_string(bytes_to_send)
-	      + " bytes)");
-
-	// jack_midi_data_t* data_buf =
-	//  jack_midi_event_reserve(out_buf, 0, bytes_to_send);
-	// if (!data_buf) {
-	//	debug("Cannot reserve buffer for MIDI event");
-	//	return 1;
-	//}
-	// size_t bytes_read = jack_ringbuffer_read(
-	//  in_buf, reinterpret_cast<char*>(data_buf), bytes_to_send);
-	// if (bytes_read != bytes_to_send) {
-	//	debug("Didn't read enough event bytes!");
-	//	return 2;
-	//}
-	//
-	for (size_t i = 0; i < bytes_to_send;) {
-		byte_t midi_event[3];
-		size_t read_bytes =
-		  jack_ringbuffer_read(in_buf, reinterpret_cast<char*>(midi_event), 3);
-		if (read_bytes != 3) {
-			debug("Didn't read enough event bytes!");
-			return 2;
-		}
-		int write_res = jack_midi_event_write(out_buf, 0, midi_event, 3);
-		if (write_res != 0) {
-			debug("MIDI write failed");
-			return 2;
-		}
 
-		i += read_bytes;
+	jack_ringbuffer_t* ringbuf = jc.input_buf.data();
+	std::array<jack_ringbuffer_data_t, 2> read_vec{};
+	jack_ringbuffer_get_read_vector(ringbuf, read_vec.data());
+
+	constexpr size_t msg_size = std::tuple_size_v<midi_message>;
+	const size_t available = (read_vec[0].len + read_vec[1].len) / msg_size;
+	const size_t events = std::min(available, MAX_EVENTS_PER_CYCLE);
+
+	// A message may wrap around the end of the ring buffer, in which case it
+	// is split over both parts of the read vector
+	size_t offset = 0;
+	size_t written = 0;
+	for (; written < events; ++written) {
+		jack_midi_data_t* event =
+		  jack_midi_event_reserve(out_buf, 0, msg_size);
+		// The port buffer is full, the rest is sent in the next cycle
+		if (!event)
+			break;
+
+		for (size_t i = 0; i < msg_size; ++i, ++offset) {
+			event[i] = offset < read_vec[0].len
+			             ? read_vec[0].buf[offset]
+			             : read_vec[1].buf[offset - read_vec[0].len];
+		}
 	}
 
-	jc.sent_midi_bytes += bytes_to_send;
+	jack_ringbuffer_read_advance(ringbuf, written * msg_size);
 
 	return 0;
 }
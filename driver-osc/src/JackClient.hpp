@@ -8,7 +8,8 @@
 #include <string_view>
 
 #include <jack/jack.h>
-#include <jack/ringbuffer.h>
+
+#include "io/Ringbuffer.hpp"
 
 class NonSignal;
 struct F1InputChange;
@@ -27,15 +28,21 @@ public:
 	  std::unique_ptr<jack_client_t, std::function<void(jack_client_t*)>>;
 	using jack_port_ptr =
 	  std::unique_ptr<jack_port_t, std::function<void(jack_port_t*)>>;
-	using jack_ringbuffer_ptr =
-	  std::unique_ptr<jack_ringbuffer_t,
-	                  std::function<void(jack_ringbuffer_t*)>>;
 	using byte_t = uint8_t;
+	using midi_message = std::array<byte_t, 3>;
 
 	constexpr static jack_options_t JACK_OPTIONS{
 	  JackOptions::JackNoStartServer};
 	constexpr static const char* OUT_PORT_NAME{"out"};
+	/** Capacity of the outbound ring buffer in MIDI messages */
 	constexpr static size_t INPUT_BUF_SIZE{256};
+	/**
+	 * Maximum number of MIDI messages written in one process cycle
+	 *
+	 * This bounds the work done in the realtime thread. Messages exceeding it
+	 * stay in the ring buffer until the next cycle.
+	 */
+	constexpr static size_t MAX_EVENTS_PER_CYCLE{64};
 
 	constexpr static byte_t MIDI_NOTE_OFF{0x80};
 	constexpr static byte_t MIDI_NOTE_ON{0x90};
@@ -71,6 +78,9 @@ public:
 
 	/**
 	 * Initiate the connetion to the JACK server
+	 *
+	 * Events pushed with {@link push_event()} are buffered while connecting
+	 * or disconnecting, so this may be called concurrently with it.
 	 */
 	void connect();
 	/**
@@ -83,6 +93,15 @@ public:
 		return jack_client.get() != nullptr;
 	}
 
+	/**
+	 * Set the client name used by the next {@link connect()}
+	 */
+	inline void set_client_name(std::string_view name)
+	{
+		assert(!is_connected());
+		client_name = name;
+	}
+
 	inline void set_channel(uint8_t channel)
 	{
 		midi_channel = channel;
@@ -92,7 +111,8 @@ public:
 	 * Push events to the outbound MIDI event ring buffer
 	 *
 	 * This method only pushes MIDI events for values that actually have
-	 * changed. Other values don't generate events.
+	 * changed. Other values don't generate events. Events which don't fit
+	 * into the ring buffer anymore are dropped and reported with a warning.
 	 */
 	void push_event(const F1InputChange& changes);
 
@@ -100,7 +120,6 @@ private:
 	inline void write_midi(JackClient::byte_t status,
 	                       JackClient::byte_t v1,
 	                       JackClient::byte_t v2);
-	inline size_t bytes_in_input_buffer() const;
 
 	static int process_cb(jack_nframes_t nframes, void* userdata);
 
@@ -111,13 +130,11 @@ private:
 		                         jack_port_unregister(jack_client.get(), port);
 		                       assert(res == 0);
 	                       }};
-	jack_ringbuffer_ptr input_buf{jack_ringbuffer_create(INPUT_BUF_SIZE),
-	                              jack_ringbuffer_free};
+	Ringbuffer<midi_message> input_buf{INPUT_BUF_SIZE};
+	/** Messages dropped by the running {@link push_event()} call */
+	size_t dropped{0};
 
 	uint8_t midi_channel{0};
-
-	size_t created_midi_bytes{0};
-	size_t sent_midi_bytes{0};
 };
 
 class JackClientException : public std::runtime_error
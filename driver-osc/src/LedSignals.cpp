@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <string>
+
+#include "LedSignals.hpp"
+
+namespace
+{
+constexpr std::array<const char*, 3> COLOR_NAMES{"/red", "/green", "/blue"};
+
+F1Device::Brightness to_brightness(float value)
+{
+	return static_cast<F1Device::Brightness>(
+	  std::lround(std::clamp(value, 0.f, 1.f) * F1Device::FULL_BRIGHTNESS));
+}
+
+NonSignal in_signal(std::string path, float max = 1.f)
+{
+	return {std::move(path), 0.f, max, 0.f, NonSignal::Direction::IN};
+}
+} // namespace
+
+NonSignalList LedSignals::signals()
+{
+	NonSignalList signals;
+	signals.reserve(LED_SIGNALS_NUM);
+
+	for (size_t i = 0; i < F1Device::MATRIX_BUTTONS_NUM; ++i) {
+		for (const auto* color : COLOR_NAMES) {
+			signals.push_back(
+			  in_signal(OSC_LED_MTX + std::to_string(i) + color));
+		}
+	}
+	for (size_t i = 0; i < F1Device::STOP_BUTTONS_NUM; ++i) {
+		signals.push_back(in_signal(OSC_LED_STOP + std::to_string(i)));
+	}
+	for (size_t i = 0; i < F1Device::SPECIAL_BUTTONS_NUM; ++i) {
+		signals.push_back(in_signal(OSC_LED_SPECIAL + std::to_string(i)));
+	}
+	signals.push_back(
+	  in_signal(OSC_LED_SEGMENT, F1Device::MAX_SEGMENT_NUM - 1));
+	signals.push_back(in_signal(std::string{OSC_LED_SEGMENT} + "/brightness"));
+
+	assert(signals.size() == LED_SIGNALS_NUM);
+	return signals;
+}
+
+void LedSignals::apply(F1Device::OutputState& state, size_t signal,
+                       float value)
+{
+	if (signal < LED_STOP) {
+		// F1 colors are stored as BRG
+		auto& [b, r, g] = state.matrix_btns.at((signal - LED_MATRIX) / 3);
+		std::array<F1Device::Brightness*, 3> channels{&r, &g, &b};
+		*channels.at((signal - LED_MATRIX) % 3) = to_brightness(value);
+	} else if (signal < LED_SPECIAL) {
+		state.stop_btns.at(signal - LED_STOP) = to_brightness(value);
+	} else if (signal < LED_SEGMENT) {
+		state.special_btns.at(signal - LED_SPECIAL) = to_brightness(value);
+	} else if (signal == LED_SEGMENT) {
+		const auto num = static_cast<uint8_t>(std::lround(std::clamp(
+		  value, 0.f, static_cast<float>(F1Device::MAX_SEGMENT_NUM - 1))));
+		const auto [left, right] = F1Device::num_to_segments(num);
+		state.segment_left_char = left;
+		state.segment_right_char = right;
+	} else if (signal == LED_SEGMENT_BRIGHTNESS) {
+		state.segment_left_brightness = to_brightness(value);
+		state.segment_right_brightness = to_brightness(value);
+	}
+}
@@ -0,0 +1,60 @@
+/**
+ * @file
+ *
+ * @brief Inbound signals which control the LEDs of the Traktor Kontrol F1
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "NonSignal.hpp"
+#include "tkf1/F1Device.hpp"
+
+/**
+ * Mapping of inbound Non signals to the LED state of the F1
+ *
+ * Each LED is controlled by one IN signal (three for the RGB matrix buttons),
+ * so Non peers can drive the LEDs directly via OSC:
+ *
+ *   * /kontrolf1/led/mtx/N/red, .../green, .../blue: color of a matrix button
+ *   * /kontrolf1/led/stop/N: brightness of a stop button
+ *   * /kontrolf1/led/special/N: brightness of a special button
+ *   * /kontrolf1/led/segment: number shown on the segment display
+ *   * /kontrolf1/led/segment/brightness: brightness of the segment display
+ *
+ * Brightness and color values range from 0 to 1.
+ */
+class LedSignals
+{
+public:
+	/**
+	 * Indices of the inbound signals, in the order of {@link signals()}
+	 */
+	enum LedSignal : size_t
+	{
+		LED_MATRIX = 0,
+		LED_STOP = LED_MATRIX + F1Device::MATRIX_BUTTONS_NUM * 3,
+		LED_SPECIAL = LED_STOP + F1Device::STOP_BUTTONS_NUM,
+		LED_SEGMENT = LED_SPECIAL + F1Device::SPECIAL_BUTTONS_NUM,
+		LED_SEGMENT_BRIGHTNESS,
+		LED_SIGNALS_NUM
+	};
+
+	constexpr static const char* OSC_LED_MTX{"/kontrolf1/led/mtx/"};
+	constexpr static const char* OSC_LED_STOP{"/kontrolf1/led/stop/"};
+	constexpr static const char* OSC_LED_SPECIAL{"/kontrolf1/led/special/"};
+	constexpr static const char* OSC_LED_SEGMENT{"/kontrolf1/led/segment"};
+
+	/**
+	 * Return all inbound LED signals, ordered by their index
+	 */
+	static NonSignalList signals();
+
+	/**
+	 * Apply the value of an inbound signal to the output state
+	 *
+	 * Values outside the range of the signal are clamped.
+	 */
+	static void apply(F1Device::OutputState& state, size_t signal,
+	                  float value);
+};
@@ -0,0 +1,62 @@
+#include "LedWriter.hpp"
+#include "Log.hpp"
+
+namespace
+{
+/**
+ * Time after which the writer checks whether it should stop
+ */
+constexpr std::chrono::seconds IDLE_WAIT{1};
+} // namespace
+
+LedWriter::LedWriter(F1HidDev dev, const F1HidDev::output& initial)
+    : dev(dev), input(initial), remote(RemoteState{initial, {}, {}}),
+      writer(&LedWriter::run, this)
+{
+	notifier.notify();
+}
+
+LedWriter::~LedWriter()
+{
+	running = false;
+	notifier.notify();
+	writer.join();
+}
+
+F1HidDev::output LedWriter::current()
+{
+	const RemoteState& set_remotely = remote.latest();
+	const F1HidDev::output& lit = input.latest();
+
+	F1HidDev::output output = set_remotely.output;
+	for (size_t i = 0; i < output.matrix_btns.size(); i++) {
+		if (!set_remotely.matrix_btns[i])
+			output.matrix_btns[i] = lit.matrix_btns[i];
+	}
+	for (size_t i = 0; i < output.stop_btns.size(); i++) {
+		if (!set_remotely.stop_btns[i])
+			output.stop_btns[i] = lit.stop_btns[i];
+	}
+	return output;
+}
+
+void LedWriter::run()
+{
+	clock::time_point last_write{};
+
+	while (running) {
+		if (!notifier.wait_until(clock::now() + IDLE_WAIT) || !running)
+			continue;
+
+		// Changes arriving during the pause are written together
+		std::this_thread::sleep_until(last_write + MIN_WRITE_INTERVAL);
+
+		try {
+			dev.write(current());
+		}
+		catch (F1HidDevException& e) {
+			LOG_ERROR("Failed to write LEDs: {}", e.what());
+		}
+		last_write = clock::now();
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <thread>
+
+#include "F1HidDev.hpp"
+#include "rt/Notifier.hpp"
+#include "rt/SharedFrame.hpp"
+
+/**
+ * Rate-limited writer of the LED state of a Traktor Kontrol F1
+ *
+ * The LEDs are changed by two threads: the HID input thread lights up buttons
+ * while they are pressed ({@link update_input()}) and the OSC server thread
+ * sets LEDs remotely ({@link update_remote()}). Each of them modifies its own
+ * copy of the LED state and publishes it as a complete frame, so neither ever
+ * waits for the other one or for the device.
+ *
+ * A dedicated writer thread combines the latest frames of both and writes
+ * them to the device. Changes arriving faster than the device can take them
+ * are merged, so at most one report is written per {@link
+ * MIN_WRITE_INTERVAL}.
+ */
+class LedWriter
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	/**
+	 * LED state set via OSC
+	 *
+	 * Matrix and stop buttons set remotely no longer light up on button
+	 * presses. All other LEDs are only ever set remotely.
+	 */
+	struct RemoteState
+	{
+		F1HidDev::output output;
+		std::bitset<F1Device::MATRIX_BUTTONS_NUM> matrix_btns;
+		std::bitset<F1Device::STOP_BUTTONS_NUM> stop_btns;
+	};
+
+	/**
+	 * Minimum time between two writes to the device
+	 */
+	constexpr static std::chrono::milliseconds MIN_WRITE_INTERVAL{10};
+
+	/**
+	 * Start the writer thread for the given device
+	 *
+	 * The initial state is written once immediately.
+	 */
+	explicit LedWriter(F1HidDev dev, const F1HidDev::output& initial = {});
+	LedWriter(const LedWriter&) = delete;
+	~LedWriter();
+
+	/**
+	 * Modify the LEDs lit by button presses and schedule a write
+	 *
+	 * This must only be called from the HID input thread.
+	 */
+	template <typename F>
+	void update_input(F&& modify)
+	{
+		input.update(std::forward<F>(modify));
+		notifier.notify();
+	}
+
+	/**
+	 * Modify the remotely set LEDs and schedule a write
+	 *
+	 * This must only be called from the OSC server thread.
+	 */
+	template <typename F>
+	void update_remote(F&& modify)
+	{
+		remote.update(std::forward<F>(modify));
+		notifier.notify();
+	}
+
+private:
+	void run();
+	/**
+	 * Combine the latest frames of both threads
+	 *
+	 * This is only called from the writer thread.
+	 */
+	F1HidDev::output current();
+
+	F1HidDev dev;
+
+	rt::SharedFrame<F1HidDev::output> input;
+	rt::SharedFrame<RemoteState> remote;
+
+	rt::Notifier notifier;
+	std::atomic<bool> running{true};
+	std::thread writer;
+};
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "Log.hpp"
+
+namespace
+{
+/**
+ * Number of attempts to take the producer lock before dropping a record
+ */
+constexpr int MAX_LOCK_ATTEMPTS{64};
+
+/**
+ * Time after which the printer checks whether it should stop
+ */
+constexpr std::chrono::seconds IDLE_WAIT{1};
+
+constexpr std::string_view PLACEHOLDER{"{}"};
+
+std::string_view level_tag(LogLevel level)
+{
+	switch (level) {
+	case LogLevel::debug:
+		return "[DBG]";
+	case LogLevel::info:
+		return "[INF]";
+	case LogLevel::warning:
+		return "[WRN]";
+	case LogLevel::error:
+		return "[ERR]";
+	case LogLevel::off:
+		break;
+	}
+	return "[???]";
+}
+} // namespace
+
+std::string LogRecord::message() const
+{
+	std::string msg;
+	std::string_view fmt{format};
+	size_t arg = 0;
+
+	for (size_t pos = fmt.find(PLACEHOLDER);
+	     pos != std::string_view::npos && arg < args_num;
+	     pos = fmt.find(PLACEHOLDER)) {
+		msg.append(fmt.substr(0, pos));
+		fmt.remove_prefix(pos + PLACEHOLDER.size());
+
+		const Arg& a = args[arg++];
+		switch (a.type) {
+		case ArgType::INT:
+			msg += std::to_string(a.value.i);
+			break;
+		case ArgType::UINT:
+			msg += std::to_string(a.value.u);
+			break;
+		case ArgType::FLOAT:
+			msg += std::to_string(a.value.f);
+			break;
+		case ArgType::TEXT:
+			msg.append(text.data() + a.value.text.offset,
+			           a.value.text.length);
+			break;
+		}
+	}
+	msg.append(fmt);
+
+	return msg;
+}
+
+void LogRecord::add_text(Arg& arg, std::string_view str) noexcept
+{
+	const size_t length = std::min(str.size(), TEXT_SIZE - text_size);
+	std::copy_n(str.data(), length, text.data() + text_size);
+
+	arg.type = ArgType::TEXT;
+	arg.value.text = {text_size, static_cast<uint16_t>(length)};
+	text_size += length;
+}
+
+Logger::Logger(std::ostream& out) : out(out), printer(&Logger::run, this)
+{}
+
+Logger::~Logger()
+{
+	stop();
+}
+
+Logger& Logger::instance()
+{
+	// The logger is never destroyed, so objects logging from their
+	// destructors during exit don't outlive it
+	static Logger* logger = []() {
+		auto* l = new Logger(std::clog);
+		std::atexit([]() { instance().stop(); });
+		return l;
+	}();
+	return *logger;
+}
+
+void Logger::push(const LogRecord& record) noexcept
+{
+	for (int attempt = 0;
+	     producer_lock.test_and_set(std::memory_order_acquire);
+	     ++attempt) {
+		if (attempt == MAX_LOCK_ATTEMPTS) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+
+	if (queue.full()) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+	} else {
+		queue.push(record);
+	}
+	producer_lock.clear(std::memory_order_release);
+
+	notifier.notify();
+}
+
+void Logger::stop()
+{
+	running = false;
+	notifier.notify();
+	if (printer.joinable())
+		printer.join();
+
+	print_pending();
+}
+
+void Logger::run()
+{
+	while (running) {
+		notifier.wait_until(std::chrono::steady_clock::now() + IDLE_WAIT);
+		print_pending();
+	}
+}
+
+void Logger::print_pending()
+{
+	while (!queue.empty()) {
+		const LogRecord record = queue.pop();
+		out << level_tag(record.level) << ' ' << record.file << ':'
+		    << record.line << ": " << record.message() << '\n';
+	}
+
+	if (const size_t n = dropped.exchange(0, std::memory_order_relaxed)) {
+		out << level_tag(LogLevel::warning) << " Dropped " << n
+		    << " log messages\n";
+	}
+	out.flush();
+}
@@ -0,0 +1,226 @@
+/**
+ * @file
+ *
+ * @brief Asynchronous logging with compile-time level filtering
+ *
+ * Messages are logged with the LOG_DEBUG(), LOG_INFO(), LOG_WARNING() and
+ * LOG_ERROR() macros, e.g.
+ *
+ *     LOG_DEBUG("Connecting {} to peer {}", path, client_id);
+ *
+ * Messages below {@link MIN_LOG_LEVEL} are removed at compile time, including
+ * the evaluation of their arguments. Enabled messages only copy their
+ * arguments into a fixed-size record, which is formatted and printed by a
+ * background thread, so logging never allocates or blocks the caller.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+#include "io/Ringbuffer.hpp"
+#include "rt/Notifier.hpp"
+
+enum class LogLevel : uint8_t
+{
+	debug,
+	info,
+	warning,
+	error,
+	off
+};
+
+/**
+ * Lowest level of messages which are compiled in
+ *
+ * This is set with the LOG_LEVEL CMake option and defaults to debug in debug
+ * builds and to info otherwise.
+ */
+#ifndef KONTROLF1_LOG_LEVEL
+#ifdef DEBUG
+#define KONTROLF1_LOG_LEVEL debug
+#else
+#define KONTROLF1_LOG_LEVEL info
+#endif
+#endif
+constexpr LogLevel MIN_LOG_LEVEL{LogLevel::KONTROLF1_LOG_LEVEL};
+
+#define LOG_AT(level, format, ...)                                            \
+	do {                                                                      \
+		if constexpr ((level) >= MIN_LOG_LEVEL) {                             \
+			Logger::instance().write(level, __FILE__, __LINE__,               \
+			                         "" format __VA_OPT__(, ) __VA_ARGS__);   \
+		}                                                                     \
+	} while (false)
+
+#define LOG_DEBUG(...) LOG_AT(LogLevel::debug, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogLevel::info, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_AT(LogLevel::warning, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::error, __VA_ARGS__)
+
+/**
+ * A log message with its unformatted arguments
+ *
+ * The format string is a string literal, in which each "{}" is replaced by
+ * the next argument. Integers and floating point numbers are stored as they
+ * are, strings are copied into a small text buffer and truncated if it is
+ * full.
+ */
+struct LogRecord
+{
+	constexpr static size_t MAX_ARGS{4};
+	constexpr static size_t TEXT_SIZE{128};
+
+	enum class ArgType : uint8_t
+	{
+		INT,
+		UINT,
+		FLOAT,
+		TEXT
+	};
+
+	struct Text
+	{
+		uint16_t offset;
+		uint16_t length;
+	};
+
+	struct Arg
+	{
+		ArgType type;
+		union
+		{
+			int64_t i;
+			uint64_t u;
+			double f;
+			Text text;
+		} value;
+	};
+
+	template <typename... Args>
+	LogRecord(LogLevel level,
+	          const char* file,
+	          unsigned line,
+	          const char* format,
+	          const Args&... args) noexcept
+	    : level(level), file(file), line(line), format(format)
+	{
+		static_assert(sizeof...(Args) <= MAX_ARGS, "Too many log arguments");
+		(add(args), ...);
+	}
+	LogRecord() = default;
+
+	/**
+	 * Format the message, without level, file or line
+	 */
+	std::string message() const;
+
+	LogLevel level{LogLevel::debug};
+	const char* file{""};
+	unsigned line{0};
+	const char* format{""};
+
+	uint8_t args_num{0};
+	std::array<Arg, MAX_ARGS> args{};
+
+	uint16_t text_size{0};
+	std::array<char, TEXT_SIZE> text{};
+
+private:
+	template <typename T>
+	void add(const T& value) noexcept
+	{
+		Arg& arg = args[args_num++];
+		if constexpr (std::is_same_v<T, bool>) {
+			add_text(arg, value ? "true" : "false");
+		} else if constexpr (std::is_same_v<T, char>) {
+			add_text(arg, {&value, 1});
+		} else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+			arg.type = ArgType::INT;
+			arg.value.i = value;
+		} else if constexpr (std::is_integral_v<T>) {
+			arg.type = ArgType::UINT;
+			arg.value.u = value;
+		} else if constexpr (std::is_floating_point_v<T>) {
+			arg.type = ArgType::FLOAT;
+			arg.value.f = value;
+		} else {
+			static_assert(std::is_convertible_v<const T&, std::string_view>,
+			              "Unsupported log argument type");
+			add_text(arg, std::string_view{value});
+		}
+	}
+
+	void add_text(Arg& arg, std::string_view str) noexcept;
+};
+
+/**
+ * Background writer of log records
+ *
+ * Any thread may write records. They are put into a lock-free ring buffer and
+ * printed by a dedicated thread. Writing never waits: if the ring is full or
+ * another thread is writing for too long, the record is dropped and counted,
+ * and the number of dropped records is printed later.
+ */
+class Logger
+{
+public:
+	/**
+	 * Capacity of the log ring in records
+	 */
+	constexpr static size_t QUEUE_SIZE{256};
+
+	/**
+	 * Start a logger printing to the given stream
+	 */
+	explicit Logger(std::ostream& out);
+	Logger(const Logger&) = delete;
+	~Logger();
+
+	/**
+	 * Return the process-wide logger printing to std::clog
+	 *
+	 * It is stopped at exit, after printing all pending records.
+	 */
+	static Logger& instance();
+
+	template <typename... Args>
+	inline void write(LogLevel level,
+	                  const char* file,
+	                  unsigned line,
+	                  const char* format,
+	                  const Args&... args) noexcept
+	{
+		push(LogRecord{level, file, line, format, args...});
+	}
+
+	void push(const LogRecord& record) noexcept;
+
+	/**
+	 * Print all pending records and stop the background thread
+	 *
+	 * Records written afterwards are no longer printed.
+	 */
+	void stop();
+
+private:
+	void run();
+	void print_pending();
+
+	std::ostream& out;
+
+	Ringbuffer<LogRecord> queue{QUEUE_SIZE};
+	std::atomic_flag producer_lock;
+	std::atomic<size_t> dropped{0};
+
+	rt::Notifier notifier;
+	std::atomic<bool> running{true};
+	std::thread printer;
+};
@@ -1,15 +1,20 @@
+#include <cstring>
+#include <memory>
+
+#include <netdb.h>
+
 #include "NonPeer.hpp"
 #include "NonSessionHandler.hpp"
 
 #define DBG_MODULE_NAME "NSH"
-#include "debug.hpp"
+#include "Log.hpp"
 
 void NonPeer::fetch_signal_list()
 {
 	assert(addr.is_valid());
 	assert(osc_server.is_valid());
 
-	debug(std::string{"Fetching /signal/list from "} + addr.url() + '\n');
+	LOG_DEBUG("Fetching /signal/list from {}", addr.url());
 	int res =
 	  addr.send_from(osc_server, NonSessionHandler::OSC_SIGNAL_LIST, "");
 	assert(res >= 0);
@@ -17,18 +22,73 @@ void NonPeer::fetch_signal_list()
 
 void NonPeer::register_signal(const NonSignal& sig)
 {
-	debug(std::string{"Registering signal "} + sig.path + ":"
-	      + std::to_string(sig.min) + "/" + std::to_string(sig.max) + "/"
-	      + std::to_string(sig.default_value) + '\n');
+	LOG_DEBUG("Registering signal {}:{}/{}/{}", sig.path, sig.min, sig.max,
+	          sig.default_value);
 	signals.push_back(sig);
 }
 
+bool NonPeer::has_signal(std::string_view path) const noexcept
+{
+	for (const auto& signal : signals) {
+		if (signal.path == path)
+			return true;
+	}
+	return false;
+}
+
 void NonPeer::send(lo::Bundle& bundle)
 {
-	debug(std::string{"Sending bundle to peer "} + addr.url() + '\n');
+	LOG_DEBUG("Sending bundle to peer {}", addr.url());
 #ifdef DEBUG
 	bundle.print();
 #endif
 	assert(bundle.is_valid());
 	addr.send_from(osc_server, bundle);
 }
+
+bool NonPeer::send(std::span<const std::byte> datagram) const
+{
+	if (sock_addr_len == 0)
+		return false;
+
+	ssize_t res = ::sendto(osc_server.socket_fd(), datagram.data(),
+	                       datagram.size(), 0,
+	                       reinterpret_cast<const sockaddr*>(&sock_addr),
+	                       sock_addr_len);
+	return res == static_cast<ssize_t>(datagram.size());
+}
+
+void NonPeer::resolve()
+{
+	if (addr.protocol() != LO_UDP) {
+		LOG_DEBUG("Peer {} does not use UDP", addr.url());
+		return;
+	}
+
+	// Use the address family of the server socket, so sendto() works
+	sockaddr_storage server_addr{};
+	socklen_t server_addr_len = sizeof(server_addr);
+	int res = ::getsockname(osc_server.socket_fd(),
+	                        reinterpret_cast<sockaddr*>(&server_addr),
+	                        &server_addr_len);
+	if (res != 0)
+		return;
+
+	addrinfo hints{};
+	hints.ai_family = server_addr.ss_family;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_flags = AI_V4MAPPED;
+
+	addrinfo* result{nullptr};
+	res = ::getaddrinfo(addr.hostname().c_str(), addr.port().c_str(), &hints,
+	                    &result);
+	if (res != 0 || !result) {
+		LOG_DEBUG("Failed to resolve peer {}", addr.url());
+		return;
+	}
+	std::unique_ptr<addrinfo, decltype(&::freeaddrinfo)> result_ptr(
+	  result, ::freeaddrinfo);
+
+	std::memcpy(&sock_addr, result->ai_addr, result->ai_addrlen);
+	sock_addr_len = result->ai_addrlen;
+}
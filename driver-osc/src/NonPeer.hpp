@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstddef>
+#include <span>
 #include <string_view>
 #include <vector>
 
+#include <sys/socket.h>
+
 #include <lo/lo_cpp.h>
 
 #include "NonSignal.hpp"
@@ -29,13 +33,17 @@ public:
 	    , client_version(client_version)
 	    , addr(url.data())
 	    , osc_server(osc_server)
-	{}
+	{
+		resolve();
+	}
 	inline NonPeer(const NonPeer& src)
 	    : client_id(src.client_id)
 	    , client_name(src.client_name)
 	    , client_version(src.client_version)
 	    , addr(src.addr.url())
 	    , osc_server(src.osc_server)
+	    , sock_addr(src.sock_addr)
+	    , sock_addr_len(src.sock_addr_len)
 	{}
 	inline ~NonPeer() = default;
 
@@ -85,17 +93,41 @@ public:
 	 */
 	void register_signal(const NonSignal& sig);
 
+	/**
+	 * Check, if the peer has offered a signal with the given path
+	 */
+	bool has_signal(std::string_view path) const noexcept;
+
 	/**
 	 * Send a raw lo::Bundle to the peer via OSC.
 	 */
 	void send(lo::Bundle& msg_bundle);
+	/**
+	 * Send a serialized OSC packet to the peer
+	 *
+	 * The packet is sent from the socket of the OSC server to the address
+	 * which was resolved when the peer was created, so sending does neither
+	 * allocate nor resolve anything. Only UDP peers are supported, which is
+	 * what NSM uses.
+	 *
+	 * @return false if the peer has no resolved UDP address or sending failed
+	 */
+	bool send(std::span<const std::byte> datagram) const;
 
 private:
+	/**
+	 * Resolve the peer's URL to a socket address matching the OSC server
+	 */
+	void resolve();
+
 	std::string client_id;
 	std::string client_name;
 	std::string client_version;
 	lo::Address addr;
 	lo::ServerThread& osc_server;
 
+	sockaddr_storage sock_addr{};
+	socklen_t sock_addr_len{0};
+
 	NonSignalList signals;
 };
@@ -8,30 +8,41 @@
 #define DBG_MODULE_NAME "NSH"
 
 #include "config.h"
-#include "debug.hpp"
+#include "Log.hpp"
+
+namespace
+{
+/**
+ * Time after which the sender thread checks whether it should stop
+ */
+constexpr std::chrono::seconds SENDER_IDLE_WAIT{1};
+} // namespace
 
-#ifdef DEBUG
 NonSessionHandler::~NonSessionHandler()
 {
-	debug("Destroying NSH\n");
+	LOG_DEBUG("Destroying NSH");
+	sender_running = false;
+	sender_notifier.notify();
+	sender.join();
+#ifdef DEBUG
 	s2c_thread.stop();
-}
 #endif
+}
 
 template <>
 void NonSessionHandler::handle_reply(std::string_view path)
 {
 	if (path == OSC_SIGNAL_LIST) {
-		debug("Received signal list end\n");
+		LOG_DEBUG("Received signal list end");
 		if (session_state != State::PEER_AWAIT_SIGNAL_LIST) {
-			debug("Received out of time signal list end. Ignoring it\n");
+			LOG_DEBUG("Received out of time signal list end. Ignoring it");
 			return;
 		}
 
 		assert(current_handshaking_peer != peers.end());
-		debug(std::string{"Completed signal exchange with peer "}
-		      + current_handshaking_peer->second.address().url() + '\n');
-		debug("State transition: RUNNING\n");
+		LOG_DEBUG("Completed signal exchange with peer {}",
+		          current_handshaking_peer->second.address().url());
+		LOG_DEBUG("State transition: RUNNING");
 		session_state = State::RUNNING;
 		handshaked_peers++;
 	}
@@ -44,19 +55,19 @@ void NonSessionHandler::handle_reply(std::string_view path,
                                      std::string_view arg3)
 {
 	if (path == NSM_ANNOUNCE) {
-		debug("Received announce reply\n");
+		LOG_DEBUG("Received announce reply");
 		if (session_state == State::HANDSHAKE_AWAIT_REPLY) {
 			assert_server_announce_matches_required_capabilities(arg3);
 
 			handshake_complete = true;
 
-			debug("handle_reply(): Step state machine\n");
+			LOG_DEBUG("handle_reply(): Step state machine");
 			step_state_machine();
 		} else {
-			debug("State transition: FAILED\n");
+			LOG_DEBUG("State transition: FAILED");
 			session_state = State::FAILED;
 
-			debug("handle_reply(): Step state machine\n");
+			LOG_DEBUG("handle_reply(): Step state machine");
 			step_state_machine();
 		}
 	}
@@ -67,14 +78,14 @@ void NonSessionHandler::handle_error(std::string_view path, int32_t error_code,
                                      std::string_view message)
 {
 	if (path == NSM_ANNOUNCE) {
-		debug(std::string{"Received NSM session failure with error "}
-		      + std::to_string(error_code) + " and message " + message.data());
+		LOG_DEBUG("Received NSM session failure with error {} and message {}",
+		          error_code, message);
 		handshake_complete = false;
 
-		debug("State transition: FAILED\n");
+		LOG_DEBUG("State transition: FAILED");
 		session_state = State::FAILED;
 
-		debug("handle_error(): Step state machine\n");
+		LOG_DEBUG("handle_error(): Step state machine");
 		step_state_machine();
 	}
 }
@@ -82,98 +93,160 @@ void NonSessionHandler::handle_error(std::string_view path, int32_t error_code,
 void NonSessionHandler::start_session()
 {
 	if (handshake_complete) {
-		debug("State transition: HELLO_START\n");
+		LOG_DEBUG("State transition: HELLO_START");
 		session_state = State::HELLO_START;
 	} else {
-		debug("State transition: HANDSHAKE_START\n");
+		LOG_DEBUG("State transition: HANDSHAKE_START");
 		session_state = State::HANDSHAKE_START;
 	}
 
-	debug("start_session(): Step state machine\n");
+	LOG_DEBUG("start_session(): Step state machine");
 	step_state_machine();
 }
 
 void NonSessionHandler::broadcast_input_event(const F1InputChange& changes)
 {
-	debug("Sending input event\n");
-	lo::Bundle bundle;
-	std::vector<lo::Message> messages;
+	LOG_DEBUG("Sending input event");
 
 	if (jack_midi) {
 		assert(jack);
 		jack->push_event(changes);
 	}
 
-	for (const auto& btn : changes.pressed_buttons.matrix) {
-		auto& msg = messages.emplace_back();
-		std::string path = std::string{OSC_SIG_MTX} + std::to_string(btn);
-		msg.add_float(OSC_BTN_PRESSED);
-		assert(msg.is_valid());
-		bundle.add(path, msg);
+	for (const auto btn : changes.pressed_buttons.matrix) {
+		queue_signal_value(SIG_MATRIX + btn, OSC_BTN_PRESSED);
+	}
+	for (const auto btn : changes.released_buttons.matrix) {
+		queue_signal_value(SIG_MATRIX + btn, OSC_BTN_RELEASED);
 	}
 
-	for (const auto& btn : changes.released_buttons.matrix) {
-		auto& msg = messages.emplace_back();
-		std::string path = std::string{OSC_SIG_MTX} + std::to_string(btn);
-		msg.add_float(OSC_BTN_RELEASED);
-		assert(msg.is_valid());
-		bundle.add(path, msg);
+	for (const auto btn : changes.pressed_buttons.stop) {
+		queue_signal_value(SIG_STOP + btn, OSC_BTN_PRESSED);
+	}
+	for (const auto btn : changes.released_buttons.stop) {
+		queue_signal_value(SIG_STOP + btn, OSC_BTN_RELEASED);
 	}
 
-	for (const auto& btn : changes.pressed_buttons.stop) {
-		auto& msg = messages.emplace_back();
-		std::string path = std::string{OSC_SIG_STOP} + std::to_string(btn);
-		msg.add_float(OSC_BTN_PRESSED);
-		assert(msg.is_valid());
-		bundle.add(path, msg);
+	for (const auto btn : changes.pressed_buttons.special) {
+		queue_signal_value(SIG_SPECIAL + btn, OSC_BTN_PRESSED);
+	}
+	for (const auto btn : changes.released_buttons.special) {
+		queue_signal_value(SIG_SPECIAL + btn, OSC_BTN_RELEASED);
 	}
 
-	for (const auto& btn : changes.released_buttons.stop) {
-		auto& msg = messages.emplace_back();
-		std::string path = std::string{OSC_SIG_STOP} + std::to_string(btn);
-		msg.add_float(OSC_BTN_RELEASED);
-		assert(msg.is_valid());
-		bundle.add(path, msg);
+	for (const auto knob : changes.knobs) {
+		queue_signal_value(SIG_KNOB + knob.first,
+		                   knob.second / F1Default::KNOB_MAX);
 	}
 
-	for (const auto& btn : changes.pressed_buttons.special) {
-		auto& msg = messages.emplace_back();
-		std::string path = std::string{OSC_SIG_SPECIAL} + std::to_string(btn);
-		msg.add_float(OSC_BTN_PRESSED);
-		assert(msg.is_valid());
-		bundle.add(path, msg);
+	for (const auto fader : changes.faders) {
+		queue_signal_value(SIG_FADER + fader.first,
+		                   fader.second / F1Default::FADER_MAX);
 	}
 
-	for (const auto& btn : changes.released_buttons.special) {
-		auto& msg = messages.emplace_back();
-		std::string path = std::string{OSC_SIG_SPECIAL} + std::to_string(btn);
-		msg.add_float(OSC_BTN_RELEASED);
-		assert(msg.is_valid());
-		bundle.add(path, msg);
+	sender_notifier.notify();
+}
+
+void NonSessionHandler::queue_signal_value(size_t signal, float value)
+{
+	if (signal_queue.full()) {
+		LOG_DEBUG("Signal queue full, dropping value");
+		return;
 	}
+	signal_queue.push({signal, value});
+}
 
-	for (const auto& knob : changes.knobs) {
-		auto& msg = messages.emplace_back();
-		std::string path =
-		  std::string{OSC_SIG_KNOB} + std::to_string(knob.first);
-		msg.add_float(knob.second / F1Default::KNOB_MAX);
-		assert(msg.is_valid());
-		bundle.add(path, msg);
+void NonSessionHandler::publish_routes()
+{
+	auto table = std::make_unique<RouteTable>();
+	for (const auto& [client_id, subscriptions] : routes) {
+		auto peer = peers.find(client_id);
+		if (peer == peers.end() || subscriptions.none())
+			continue;
+		table->push_back({peer->second, subscriptions});
 	}
+	route_table.publish(std::move(table));
+}
 
-	for (const auto& fader : changes.faders) {
-		auto& msg = messages.emplace_back();
-		std::string path =
-		  std::string{OSC_SIG_FADER} + std::to_string(fader.first);
-		msg.add_float(fader.second / F1Default::FADER_MAX);
-		assert(msg.is_valid());
-		bundle.add(path, msg);
+void NonSessionHandler::run_sender()
+{
+	using clock = std::chrono::steady_clock;
+
+	while (sender_running) {
+		if (!sender_notifier.wait_until(clock::now() + SENDER_IDLE_WAIT))
+			continue;
+
+		size_t count{0};
+		while (!signal_queue.empty() && count < pending_values.size()) {
+			pending_values[count++] = signal_queue.pop();
+		}
+		if (count > 0)
+			send_values({pending_values.data(), count});
 	}
+}
 
-	assert(bundle.is_valid());
+void NonSessionHandler::send_values(std::span<const SignalValue> values)
+{
+	const auto table = route_table.read(SENDER_READER);
 
-	for (auto& peer : peers) {
-		peer.second.send(bundle);
+	for (const auto& route : *table) {
+		bundle.clear();
+		for (const auto& value : values) {
+			if (route.subscriptions[value.signal])
+				add_signal_value(route.peer, value.signal, value.value);
+		}
+
+		if (!bundle.empty())
+			send_bundle(route.peer);
+	}
+}
+
+NonSessionHandler::SignalPaths NonSessionHandler::make_signal_paths()
+{
+	SignalPaths paths;
+
+	auto intern = [&paths](size_t offset, size_t count, const char* prefix) {
+		for (size_t i = 0; i < count; ++i) {
+			paths.at(offset + i) =
+			  OscPath{std::string{prefix} + std::to_string(i)};
+		}
+	};
+	intern(SIG_MATRIX, F1Device::MATRIX_BUTTONS_NUM, OSC_SIG_MTX);
+	intern(SIG_STOP, F1Device::STOP_BUTTONS_NUM, OSC_SIG_STOP);
+	intern(SIG_SPECIAL, F1Device::SPECIAL_BUTTONS_NUM, OSC_SIG_SPECIAL);
+	intern(SIG_KNOB, F1Device::KNOBS_NUM, OSC_SIG_KNOB);
+	intern(SIG_FADER, F1Device::FADERS_NUM, OSC_SIG_FADER);
+
+	return paths;
+}
+
+std::optional<size_t> NonSessionHandler::find_signal(
+  std::string_view path) const
+{
+	for (size_t i = 0; i < signal_paths.size(); ++i) {
+		if (signal_paths[i].str() == path)
+			return i;
+	}
+	return std::nullopt;
+}
+
+void NonSessionHandler::add_signal_value(const NonPeer& peer, size_t signal,
+                                         float value)
+{
+	if (bundle.add_float(signal_paths[signal], value))
+		return;
+
+	send_bundle(peer);
+	bundle.clear();
+	[[maybe_unused]] bool added =
+	  bundle.add_float(signal_paths[signal], value);
+	assert(added);
+}
+
+void NonSessionHandler::send_bundle(const NonPeer& peer)
+{
+	if (!peer.send(bundle.datagram())) {
+		LOG_DEBUG("Failed to send bundle to peer {}", peer.address().url());
 	}
 }
 
@@ -186,15 +259,15 @@ void NonSessionHandler::step_state_machine()
 
 	switch (current_session_state) {
 	case State::FAILED:
-		debug("State: FAILED\n");
+		LOG_DEBUG("State: FAILED");
 		break;
 	case State::NO_SESSION: {
-		debug("State: NO_SESSION\n");
+		LOG_DEBUG("State: NO_SESSION");
 		break;
 	}
 
 	case State::HANDSHAKE_START: {
-		debug("State: HANDSHAKE_START\n");
+		LOG_DEBUG("State: HANDSHAKE_START");
 
 		session_state = State::HANDSHAKE_AWAIT_REPLY;
 		send_announce();
@@ -203,7 +276,7 @@ void NonSessionHandler::step_state_machine()
 	}
 
 	case State::HANDSHAKE_AWAIT_REPLY: {
-		debug("State: HANDSHAKE_AWAIT_REPLY\n");
+		LOG_DEBUG("State: HANDSHAKE_AWAIT_REPLY");
 
 		if (handshake_complete) {
 			session_state = State::SESSION_AWAIT_OPEN;
@@ -213,7 +286,7 @@ void NonSessionHandler::step_state_machine()
 	}
 
 	case State::SESSION_AWAIT_OPEN: {
-		debug("State: SESSION_AWAIT_OPEN\n");
+		LOG_DEBUG("State: SESSION_AWAIT_OPEN");
 
 		if (!project_opened)
 			break;
@@ -224,24 +297,24 @@ void NonSessionHandler::step_state_machine()
 	}
 
 	case State::HELLO_START: {
-		debug("State: HELLO_START\n");
+		LOG_DEBUG("State: HELLO_START");
 
 		send_hello();
 
-		debug("State transition: RUNNING\n");
+		LOG_DEBUG("State transition: RUNNING");
 		session_state = State::RUNNING;
 		rerun_state_machine_immediately = true;
 		break;
 	}
 
 	case State::PEER_AWAIT_SIGNAL_LIST: {
-		debug("State: PEER_AWAIT_SIGNAL_LIST\n");
+		LOG_DEBUG("State: PEER_AWAIT_SIGNAL_LIST");
 		send_signal_list();
 		break;
 	}
 
 	case State::RUNNING: {
-		debug("State: RUNNING\n");
+		LOG_DEBUG("State: RUNNING");
 		if (handshaked_peers < peers.size()) {
 			if (current_handshaking_peer == peers.end()) {
 				current_handshaking_peer = peers.begin();
@@ -249,7 +322,7 @@ void NonSessionHandler::step_state_machine()
 				++current_handshaking_peer;
 			}
 
-			debug("State transition: PEER_AWAIT_SIGNAL_LIST\n");
+			LOG_DEBUG("State transition: PEER_AWAIT_SIGNAL_LIST");
 			session_state = State::PEER_AWAIT_SIGNAL_LIST;
 
 			rerun_state_machine_immediately = true;
@@ -258,14 +331,14 @@ void NonSessionHandler::step_state_machine()
 	}
 
 	default:
-		debug("Invalid state!\n");
+		LOG_DEBUG("Invalid state!");
 		throw std::runtime_error(
 		  "NonSessionHandler::step_state_machine(): State not implemented!");
 	}
 
 	if (rerun_state_machine_immediately) {
 		lock.unlock();
-		debug("step_state_machine(): Rerun\n");
+		LOG_DEBUG("step_state_machine(): Rerun");
 		step_state_machine();
 	}
 }
@@ -274,17 +347,17 @@ void NonSessionHandler::register_callbacks()
 {
 #ifdef DEBUG
 	s2c_thread.set_callbacks(
-	  []() { debug("lo::ServerThread s2c initialized\n"); }, []() {});
+	  []() { LOG_DEBUG("lo::ServerThread s2c initialized"); }, []() {});
 #endif
 
 	s2c_thread.add_method("/reply", "s", [this](lo::Message msg) {
-		debug("Received /reply\n");
+		LOG_DEBUG("Received /reply");
 		auto* argv = msg.argv();
 		std::string_view path = reinterpret_cast<const char*>(&argv[0]->s);
 		handle_reply(path);
 	});
 	s2c_thread.add_method("/reply", "ssss", [this](lo::Message msg) {
-		debug("Received /reply\n");
+		LOG_DEBUG("Received /reply");
 		auto** argv = msg.argv();
 		std::string_view path = reinterpret_cast<const char*>(&argv[0]->s);
 		std::string_view arg1 = reinterpret_cast<const char*>(&argv[1]->s);
@@ -293,7 +366,7 @@ void NonSessionHandler::register_callbacks()
 		handle_reply(path, arg1, arg2, arg3);
 	});
 	s2c_thread.add_method("/reply", "ssfff", [this](lo::Message msg) {
-		debug("Received /reply\n");
+		LOG_DEBUG("Received /reply");
 		auto** argv = msg.argv();
 		std::string_view path = reinterpret_cast<const char*>(&argv[0]->s);
 		std::string_view arg1 = reinterpret_cast<const char*>(&argv[1]->s);
@@ -303,12 +376,12 @@ void NonSessionHandler::register_callbacks()
 		if (path == OSC_SIGNAL_LIST) {
 			handle_signal_list_reply(arg1, arg2, arg3, arg4);
 		} else {
-			debug("Not implemented / Invalid signal\n");
+			LOG_DEBUG("Not implemented / Invalid signal");
 			assert(false);
 		}
 	});
 	s2c_thread.add_method("/error", "sis", [this](lo::Message msg) {
-		debug("Received /error\n");
+		LOG_DEBUG("Received /error");
 		auto** argv = msg.argv();
 		std::string_view path = reinterpret_cast<const char*>(&argv[0]->s);
 		int32_t error_code = argv[1]->i;
@@ -316,7 +389,7 @@ void NonSessionHandler::register_callbacks()
 		handle_error(path, error_code, message);
 	});
 	s2c_thread.add_method(NSM_OPEN, "sss", [this](lo::Message msg) {
-		debug(std::string{"Received "} + NSM_OPEN + '\n');
+		LOG_DEBUG("Received {}", NSM_OPEN);
 		auto** argv = msg.argv();
 		std::string_view project_path =
 		  reinterpret_cast<const char*>(&argv[0]->s);
@@ -326,15 +399,41 @@ void NonSessionHandler::register_callbacks()
 		handle_open(project_path, display_name, client_id);
 	});
 	s2c_thread.add_method(NSM_SAVE, "", [this](lo::Message msg) {
-		debug(std::string{"Received "} + NSM_SAVE + '\n');
+		LOG_DEBUG("Received {}", NSM_SAVE);
 		handle_save();
 	});
 	s2c_thread.add_method(OSC_SIGNAL_LIST, "", [this](lo::Message msg) {
-		debug(std::string{"Received "} + OSC_SIGNAL_LIST + '\n');
+		LOG_DEBUG("Received {}", OSC_SIGNAL_LIST);
 		handle_signal_list(msg.source());
 	});
+	s2c_thread.add_method(OSC_SIGNAL_CONNECT, "ss", [this](lo::Message msg) {
+		LOG_DEBUG("Received {}", OSC_SIGNAL_CONNECT);
+		auto** argv = msg.argv();
+		std::string_view source = reinterpret_cast<const char*>(&argv[0]->s);
+		std::string_view dest = reinterpret_cast<const char*>(&argv[1]->s);
+		handle_signal_connect(source, dest, true);
+	});
+	s2c_thread.add_method(OSC_SIGNAL_DISCONNECT, "ss", [this](lo::Message msg) {
+		LOG_DEBUG("Received {}", OSC_SIGNAL_DISCONNECT);
+		auto** argv = msg.argv();
+		std::string_view source = reinterpret_cast<const char*>(&argv[0]->s);
+		std::string_view dest = reinterpret_cast<const char*>(&argv[1]->s);
+		handle_signal_connect(source, dest, false);
+	});
+	if (input_handler) {
+		size_t in_signal{0};
+		for (const auto& signal : signals) {
+			if (signal.direction != NonSignal::Direction::IN)
+				continue;
+			s2c_thread.add_method(
+			  signal.path, "f", [this, in_signal](lo::Message msg) {
+				  input_handler(in_signal, msg.argv()[0]->f);
+			  });
+			++in_signal;
+		}
+	}
 	s2c_thread.add_method(NSM_HELLO, "ssss", [this](lo::Message msg) {
-		debug(std::string{"Received hello\n"});
+		LOG_DEBUG("Received hello");
 		std::string_view peer_url =
 		  reinterpret_cast<const char*>(&msg.argv()[0]->s);
 		std::string_view peer_name =
@@ -346,7 +445,7 @@ void NonSessionHandler::register_callbacks()
 
 		if (peer_is_known(peer_client_id)) {
 			// TODO Update URL
-			debug("Feature not implemented\n");
+			LOG_DEBUG("Feature not implemented");
 			assert(false);
 		} else {
 			peers.emplace(peer_client_id,
@@ -359,7 +458,7 @@ void NonSessionHandler::register_callbacks()
 
 void NonSessionHandler::send_announce()
 {
-	debug(std::string{"send_announce(): Sending "} + NSM_ANNOUNCE + '\n');
+	LOG_DEBUG("send_announce(): Sending {}", NSM_ANNOUNCE);
 	c2s_addr.send_from(s2c_thread, NSM_ANNOUNCE, "sssiii", NSM_CLIENT_NAME,
 	                   NSM_CLIENT_CAPABILITIES, executable_name.data(),
 	                   NON_API_VERSION_MAJOR, NON_API_VERSION_MINOR,
@@ -368,7 +467,7 @@ void NonSessionHandler::send_announce()
 
 void NonSessionHandler::send_hello()
 {
-	debug("send_hello(): Sending hello\n");
+	LOG_DEBUG("send_hello(): Sending hello");
 	c2s_addr.send_from(s2c_thread, NSM_BROADCAST, "sssss", NSM_HELLO,
 	                   static_cast<lo::Address>(*this).url().c_str(),
 	                   NSM_CLIENT_NAME, KONTROLF1_VERSION, client_id.c_str());
@@ -391,12 +490,15 @@ void NonSessionHandler::handle_open(std::string_view project_path,
 
 	try {
 		if (jack_midi) {
-			debug("NonSessionHandler::handle_open(): Connecting JackClient");
-			jack.reset(new JackClient(client_id));
+			LOG_DEBUG(
+			  "NonSessionHandler::handle_open(): Connecting JackClient");
+			if (jack->is_connected())
+				jack->disconnect();
+			jack->set_client_name(client_id);
 			jack->connect();
 		}
 
-		debug("NonSessionHandler::handle_open(): Sending /reply\n");
+		LOG_DEBUG("NonSessionHandler::handle_open(): Sending /reply");
 		c2s_addr.send_from(s2c_thread, "/reply", "ss", NSM_OPEN, "NOP");
 
 		project_opened = true;
@@ -417,7 +519,7 @@ void NonSessionHandler::handle_open(std::string_view project_path,
 void NonSessionHandler::handle_save()
 {
 	// We have nothing to save, yet
-	debug("NonSessionHandler::handle_save(): Sending /reply\n");
+	LOG_DEBUG("NonSessionHandler::handle_save(): Sending /reply");
 	c2s_addr.send_from(s2c_thread, "/reply", "ss", NSM_SAVE, "NOP");
 }
 
@@ -448,7 +550,7 @@ void NonSessionHandler::handle_signal_list(const lo::Address& peer)
 
 	assert(bundle.is_valid());
 
-	debug(std::string{"Sending signal bundle to "} + peer.url() + '\n');
+	LOG_DEBUG("Sending signal bundle to {}", peer.url());
 #ifdef DEBUG
 	bundle.print();
 #endif
@@ -465,6 +567,30 @@ void NonSessionHandler::handle_signal_list_reply(std::string_view signal_path,
 	peer.register_signal({signal_path.data(), min, max, default_value});
 }
 
+void NonSessionHandler::handle_signal_connect(std::string_view source_path,
+                                              std::string_view dest_path,
+                                              bool connect)
+{
+	auto signal = find_signal(source_path);
+	if (!signal) {
+		LOG_DEBUG("Ignoring connection of unknown signal {}", source_path);
+		return;
+	}
+
+	for (const auto& [client_id, peer] : peers) {
+		if (!peer.has_signal(dest_path))
+			continue;
+
+		LOG_DEBUG("{} {} to peer {}", connect ? "Connecting" : "Disconnecting",
+		          source_path, client_id);
+		routes[client_id].set(*signal, connect);
+		publish_routes();
+		return;
+	}
+
+	LOG_DEBUG("Ignoring connection to unknown signal {}", dest_path);
+}
+
 void NonSessionHandler::assert_server_announce_matches_required_capabilities(
   std::string_view capabilities)
 {
@@ -473,11 +599,10 @@ void NonSessionHandler::assert_server_announce_matches_required_capabilities(
 	     NonSessionHandler::NSM_REQUIRED_SERVER_CAPABILITIES) {
 		size_t found_pos = capabilities.find(required_cap);
 		if (found_pos == std::string_view::npos) {
-			debug(
-			  std::string{"NonSessionHandler::assert_server_announce_matches_"
-			              "required_capabilities(): Missing capability "}
-			  + required_cap + '\n');
-			debug("State transition: FAILED\n");
+			LOG_DEBUG("NonSessionHandler::assert_server_announce_matches_"
+			          "required_capabilities(): Missing capability {}",
+			          required_cap);
+			LOG_DEBUG("State transition: FAILED");
 			session_state = State::FAILED;
 		}
 	}
@@ -1,11 +1,17 @@
 #pragma once
 
 #include <atomic>
+#include <bitset>
 #include <cassert>
+#include <functional>
 #include <map>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 #include <iostream>
 
@@ -13,6 +19,11 @@
 
 #include "JackClient.hpp"
 #include "NonPeer.hpp"
+#include "OscPacket.hpp"
+#include "io/Ringbuffer.hpp"
+#include "rt/Notifier.hpp"
+#include "rt/Rcu.hpp"
+#include "tkf1/F1Device.hpp"
 
 struct F1InputChange;
 class JackClient;
@@ -56,6 +67,8 @@ public:
 	constexpr static const char* NSM_OPEN{"/nsm/client/open"};
 	constexpr static const char* NSM_SAVE{"/nsm/client/save"};
 	constexpr static const char* OSC_SIGNAL_LIST{"/signal/list"};
+	constexpr static const char* OSC_SIGNAL_CONNECT{"/signal/connect"};
+	constexpr static const char* OSC_SIGNAL_DISCONNECT{"/signal/disconnect"};
 
 	constexpr static const char* NSM_CLIENT_NAME{"traktor-kontrol-f1-mapper"};
 	constexpr static const char* NSM_CLIENT_CAPABILITIES{"switch"};
@@ -77,6 +90,29 @@ public:
 	constexpr static float OSC_BTN_PRESSED{1.f};
 	constexpr static float OSC_BTN_RELEASED{0.f};
 
+	/**
+	 * Capacity of the queue of signal values waiting to be sent
+	 */
+	constexpr static size_t SIGNAL_QUEUE_SIZE{1024};
+
+	/**
+	 * Indices of the outbound signals, in the order of F1Default::signals
+	 */
+	enum SignalIndex : size_t
+	{
+		SIG_MATRIX = 0,
+		SIG_STOP = SIG_MATRIX + F1Device::MATRIX_BUTTONS_NUM,
+		SIG_SPECIAL = SIG_STOP + F1Device::STOP_BUTTONS_NUM,
+		SIG_KNOB = SIG_SPECIAL + F1Device::SPECIAL_BUTTONS_NUM,
+		SIG_FADER = SIG_KNOB + F1Device::KNOBS_NUM,
+		SIGNALS_NUM = SIG_FADER + F1Device::FADERS_NUM
+	};
+
+	/**
+	 * Set of outbound signals a peer has connected to
+	 */
+	using Subscriptions = std::bitset<SIGNALS_NUM>;
+
 	/**
 	 * States of the internal state machine
 	 */
@@ -92,31 +128,43 @@ public:
 		FAILED
 	};
 
+	/**
+	 * Handler for values received on inbound signals
+	 *
+	 * The first argument is the index of the signal among the inbound
+	 * signals, i.e. the signals with {@link NonSignal::Direction::IN}, in the
+	 * order they have been passed to the constructor.
+	 */
+	using InputHandler = std::function<void(size_t signal, float value)>;
+
 	/**
 	 * Create a new instance and OSC server thread
+	 *
+	 * Values received on inbound signals are passed to input_handler, which
+	 * is called from the OSC server thread.
 	 */
 	template <typename string_type>
 	inline NonSessionHandler(const string_type& c2s_addr,
 	                         std::string_view executable_name,
 	                         const NonSignalList& signals = {},
-	                         bool jack_midi = false)
+	                         bool jack_midi = false,
+	                         InputHandler input_handler = {})
 	    : s2c_thread(nullptr)
 	    , c2s_addr(c2s_addr)
 	    , executable_name(executable_name)
 	    , signals(signals)
 	    , jack_midi(jack_midi)
+	    , jack(jack_midi ? std::make_unique<JackClient>(NSM_CLIENT_NAME)
+	                     : nullptr)
+	    , input_handler(std::move(input_handler))
 	{
 		assert(s2c_thread.is_valid());
 		register_callbacks();
 		s2c_thread.start();
+		sender = std::thread(&NonSessionHandler::run_sender, this);
 	}
 	NonSessionHandler(const NonSessionHandler&) = delete;
-	// FIXME: Why do we have these two destructors?
-#ifndef DEBUG
-	inline ~NonSessionHandler() = default;
-#else
 	~NonSessionHandler();
-#endif
 
 	/**
 	 * Return an address to send messages to or from the internal OSC server
@@ -167,11 +215,26 @@ public:
 	}
 
 	/**
-	 * Broadcast an input event to all Non Peers
+	 * Return the outbound signals the peer with the given client id has
+	 * connected to
+	 */
+	inline Subscriptions subscriptions(const std::string& client_id) const
+	{
+		auto route = routes.find(client_id);
+		return route == routes.end() ? Subscriptions{} : route->second;
+	}
+
+	/**
+	 * Send an input event to all Non Peers connected to the changed signals
+	 *
+	 * Each peer receives a single bundle with the values of the signals it
+	 * has connected to (see {@link handle_signal_connect()}). Peers without
+	 * connections to the changed signals receive nothing.
 	 *
-	 * This is the default way to send input events to Non Peers, but maybe we
-	 * can improve this by keeping track of which input is associated with with
-	 * signals.
+	 * This method only queues the changed values for the sender thread, so
+	 * it neither blocks on a lock nor on the network and can be called from
+	 * the HID thread. Only one thread may call it at a time. If the queue is
+	 * full, values are dropped.
 	 */
 	void broadcast_input_event(const F1InputChange& changes);
 
@@ -240,6 +303,17 @@ private:
 	                              float min,
 	                              float max,
 	                              float default_value);
+	/**
+	 * Handle incoming /signal/connect and /signal/disconnect
+	 *
+	 * A peer connects one of its signals (dest_path) to one of our outbound
+	 * signals (source_path). The peer is looked up by the signal lists
+	 * received from all peers and the route table is updated accordingly.
+	 * Connections to unknown signals or peers are ignored.
+	 */
+	void handle_signal_connect(std::string_view source_path,
+	                           std::string_view dest_path,
+	                           bool connect);
 	//@}
 
 	/// @name Misc methods
@@ -250,6 +324,69 @@ private:
 	inline bool peer_is_known(const std::string& client_id) const;
 	//@}
 
+	/// @name Outbound signals
+	//@{
+	using SignalPaths = std::array<OscPath, SIGNALS_NUM>;
+
+	struct SignalValue
+	{
+		size_t signal;
+		float value;
+	};
+
+	/**
+	 * Immutable snapshot of a peer and the signals it has connected to
+	 */
+	struct Route
+	{
+		NonPeer peer;
+		Subscriptions subscriptions;
+	};
+	using RouteTable = std::vector<Route>;
+
+	/**
+	 * Reader slot of the sender thread in {@link route_table}
+	 */
+	constexpr static size_t SENDER_READER{0};
+
+	static SignalPaths make_signal_paths();
+	std::optional<size_t> find_signal(std::string_view path) const;
+
+	void queue_signal_value(size_t signal, float value);
+	/**
+	 * Publish a new route table snapshot built from peers and routes
+	 *
+	 * This must be called from the OSC server thread whenever routes
+	 * changes.
+	 */
+	void publish_routes();
+
+	/**
+	 * Main loop of the sender thread
+	 *
+	 * It waits for queued signal values and sends them to all peers of the
+	 * current route table snapshot.
+	 */
+	void run_sender();
+	void send_values(std::span<const SignalValue> values);
+	/**
+	 * Add a signal value to the bundle for the given peer
+	 *
+	 * If the bundle is full, it is sent and a new one is started.
+	 */
+	void add_signal_value(const NonPeer& peer, size_t signal, float value);
+	void send_bundle(const NonPeer& peer);
+
+	const SignalPaths signal_paths{make_signal_paths()};
+	/**
+	 * Subscribed outbound signals by peer client id
+	 *
+	 * Only accessed from the OSC server thread, the sender thread uses
+	 * {@link route_table} instead.
+	 */
+	std::map<std::string, Subscriptions> routes;
+	//@}
+
 	/// @name OSC/Non Stuff
 	//@{
 	lo::ServerThread s2c_thread;
@@ -274,6 +411,29 @@ private:
 	/// @name Jack Stuff
 	//@{
 	bool jack_midi;
-	std::unique_ptr<JackClient> jack;
+	/**
+	 * MIDI output, if enabled
+	 *
+	 * It is created along with the handler and never replaced: the HID thread
+	 * pushes events to it in {@link broadcast_input_event()} while the OSC
+	 * server thread connects it in {@link handle_open()}.
+	 */
+	const std::unique_ptr<JackClient> jack;
+	//@}
+
+	InputHandler input_handler;
+
+	/// @name Sender thread
+	//@{
+	Ringbuffer<SignalValue> signal_queue{SIGNAL_QUEUE_SIZE};
+	rt::Rcu<RouteTable, 1> route_table{std::make_unique<const RouteTable>()};
+	rt::Notifier sender_notifier;
+	std::atomic<bool> sender_running{true};
+
+	// Only used by the sender thread
+	std::array<SignalValue, SIGNAL_QUEUE_SIZE> pending_values;
+	OscBundleWriter bundle;
+
+	std::thread sender;
 	//@}
 };
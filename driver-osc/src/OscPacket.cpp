@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "OscPacket.hpp"
+
+namespace
+{
+constexpr std::string_view BUNDLE_TAG{"#bundle\0", 8};
+// The time tag 1 means "immediately"
+constexpr uint32_t TIME_TAG_SECONDS{0};
+constexpr uint32_t TIME_TAG_FRACTION{1};
+constexpr std::string_view FLOAT_TYPE_TAG{",f\0\0", 4};
+
+constexpr size_t padded(size_t size)
+{
+	return (size + 4) & ~size_t{3};
+}
+
+inline std::span<const std::byte> as_bytes(std::string_view str)
+{
+	return std::as_bytes(std::span{str.data(), str.size()});
+}
+} // namespace
+
+OscPath::OscPath(std::string_view path)
+    : length(path.size()), size(padded(path.size()))
+{
+	if (size > MAX_SIZE)
+		throw std::length_error{std::string{"OSC path too long: "}
+		                        + std::string{path}};
+
+	std::memcpy(data.data(), path.data(), path.size());
+}
+
+void OscBundleWriter::clear() noexcept
+{
+	size = 0;
+	messages = 0;
+	put(as_bytes(BUNDLE_TAG));
+	put_int32(TIME_TAG_SECONDS);
+	put_int32(TIME_TAG_FRACTION);
+}
+
+bool OscBundleWriter::add_float(const OscPath& path, float value) noexcept
+{
+	const auto path_bytes = path.bytes();
+	const size_t message_size =
+	  path_bytes.size() + FLOAT_TYPE_TAG.size() + sizeof(uint32_t);
+	if (size + sizeof(uint32_t) + message_size > buf.size())
+		return false;
+
+	put_int32(static_cast<uint32_t>(message_size));
+	put(path_bytes);
+	put(as_bytes(FLOAT_TYPE_TAG));
+	put_int32(std::bit_cast<uint32_t>(value));
+	++messages;
+
+	return true;
+}
+
+void OscBundleWriter::put_int32(uint32_t value) noexcept
+{
+	// OSC uses big endian
+	for (int shift = 24; shift >= 0; shift -= 8) {
+		buf[size++] = static_cast<std::byte>(value >> shift);
+	}
+}
+
+void OscBundleWriter::put(std::span<const std::byte> bytes) noexcept
+{
+	std::copy(bytes.begin(), bytes.end(), buf.begin() + size);
+	size += bytes.size();
+}
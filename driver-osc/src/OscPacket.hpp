@@ -0,0 +1,112 @@
+/**
+ * @file
+ *
+ * @brief Allocation-free serialization of outbound OSC bundles
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+/**
+ * An OSC address pattern in its serialized form
+ *
+ * The path is NUL-terminated and padded to a multiple of four bytes once when
+ * the object is created, so it can be copied into a packet as a whole.
+ */
+class OscPath
+{
+public:
+	/**
+	 * Maximum size of a serialized path, including padding
+	 */
+	constexpr static size_t MAX_SIZE{32};
+
+	OscPath() = default;
+	/**
+	 * Intern the given path
+	 *
+	 * @throws std::length_error if the path does not fit into MAX_SIZE bytes
+	 */
+	explicit OscPath(std::string_view path);
+
+	inline std::span<const std::byte> bytes() const noexcept
+	{
+		return {data.data(), size};
+	}
+
+	inline std::string_view str() const noexcept
+	{
+		return {reinterpret_cast<const char*>(data.data()), length};
+	}
+
+private:
+	std::array<std::byte, MAX_SIZE> data{};
+	size_t length{0};
+	size_t size{0};
+};
+
+/**
+ * An OSC bundle serialized into a fixed-size datagram buffer
+ *
+ * The bundle is cleared with {@link clear()} and filled with single-float
+ * messages using {@link add_float()}. Nothing is allocated on the way, so the
+ * same writer can be reused for every input change. The serialized bundle can
+ * be sent to any number of peers as it is.
+ *
+ * All bundles are to be dispatched immediately.
+ */
+class OscBundleWriter
+{
+public:
+	/**
+	 * Size of the datagram buffer
+	 *
+	 * This is the largest UDP payload which is not fragmented on an
+	 * Ethernet link. A bundle with all signals of the F1 fits easily.
+	 */
+	constexpr static size_t MAX_DATAGRAM_SIZE{1472};
+
+	inline OscBundleWriter()
+	{
+		clear();
+	}
+
+	/**
+	 * Remove all messages from the bundle
+	 */
+	void clear() noexcept;
+
+	/**
+	 * Append a message with a single float argument
+	 *
+	 * @return false if the message does not fit into the datagram, in which
+	 * case the bundle is left unchanged
+	 */
+	bool add_float(const OscPath& path, float value) noexcept;
+
+	inline bool empty() const noexcept
+	{
+		return messages == 0;
+	}
+
+	/**
+	 * Return the serialized bundle
+	 */
+	inline std::span<const std::byte> datagram() const noexcept
+	{
+		return {buf.data(), size};
+	}
+
+private:
+	void put_int32(uint32_t value) noexcept;
+	void put(std::span<const std::byte> bytes) noexcept;
+
+	std::array<std::byte, MAX_DATAGRAM_SIZE> buf{};
+	size_t size{0};
+	size_t messages{0};
+};
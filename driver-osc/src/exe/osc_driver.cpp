@@ -15,10 +15,12 @@
 
 #include "F1HidDev.hpp"
 #include "JackClient.hpp"
+#include "LedSignals.hpp"
+#include "LedWriter.hpp"
 #include "NonSessionHandler.hpp"
 
 #define DBG_MODULE_NAME "DRV_EXE"
-#include "debug.hpp"
+#include "Log.hpp"
 
 namespace
 {
@@ -36,7 +38,7 @@ namespace colors
 	constexpr float lightness_on{1.f};
 	constexpr float lightness_off{.2f};
 
-	constexpr std::array<std::array<uint8_t, 3>, 16> mtx{
+	constexpr std::array<F1Device::ButtonColor, 16> mtx{
 	  rgb2c(0x00, 0x00, 0x7f), rgb2c(0x7f, 0x00, 0x10), rgb2c(0x00, 0x7f, 0x00),
 	  rgb2c(0x7f, 0x7f, 0x00), rgb2c(0x00, 0x00, 0x7f), rgb2c(0x7f, 0x00, 0x10),
 	  rgb2c(0x00, 0x7f, 0x00), rgb2c(0x7f, 0x7f, 0x00), rgb2c(0x00, 0x00, 0x7f),
@@ -44,11 +46,23 @@ namespace colors
 	  rgb2c(0x00, 0x00, 0x7f), rgb2c(0x7f, 0x00, 0x10), rgb2c(0x00, 0x7f, 0x00),
 	  rgb2c(0x7f, 0x7f, 0x00),
 	};
+
+	constexpr F1Device::ButtonColor dim(F1Device::ButtonColor color,
+	                                    float lightness)
+	{
+		const auto [b, r, g] = color;
+		return {static_cast<uint8_t>(b * lightness),
+		        static_cast<uint8_t>(r * lightness),
+		        static_cast<uint8_t>(g * lightness)};
+	}
 } // namespace colors
 
 void drop_privileges();
 int exec_driver(int fd, const char* nsm_url, std::string_view exe_name);
-void set_colors(F1HidDev dev, const F1InputChange& input = {});
+F1HidDev::output initial_colors();
+void set_colors(LedWriter& leds, const F1InputChange& input);
+void set_remote_led(LedWriter::RemoteState& remote, size_t signal,
+                    float value);
 } // namespace
 
 int main(int argc, char** argv)
@@ -63,13 +77,11 @@ int main(int argc, char** argv)
 	int fd;
 
 	for (size_t i = 0;; i++) {
-		debug(std::string{"Trying "} + HIDRAW_PREFIX + std::to_string(i)
-		      + '\n');
+		LOG_DEBUG("Trying {}{}", HIDRAW_PREFIX, i);
 		std::string path = std::string{HIDRAW_PREFIX} + std::to_string(i);
 		fd = open(path.c_str(), O_RDWR);
 
-		debug(std::string{"  open() returned with code "} + std::to_string(fd)
-		      + '\n');
+		LOG_DEBUG("  open() returned with code {}", fd);
 		if (fd < 0) {
 			std::clog << "Failed to open " << HIDRAW_PREFIX << i << '\n'
 			          << strerror(errno) << '\n';
@@ -81,7 +93,7 @@ int main(int argc, char** argv)
 			}
 		}
 
-		debug("  Retrieving devinfo\n");
+		LOG_DEBUG("  Retrieving devinfo");
 		hidraw_devinfo devinfo;
 		int res = ioctl(fd, HIDIOCGRAWINFO, &devinfo);
 
@@ -107,7 +119,7 @@ int main(int argc, char** argv)
 			}
 		}
 
-		debug("  Device mismatch. Trying next device.\n");
+		LOG_DEBUG("  Device mismatch. Trying next device.");
 		close(fd);
 	}
 }
@@ -116,7 +128,7 @@ namespace
 {
 void drop_privileges()
 {
-	debug("Dropping privileges");
+	LOG_DEBUG("Dropping privileges");
 	if (setgid(getgid()) == -1) {
 		std::cerr << "Failed to drop group!\n";
 		exit(1);
@@ -129,14 +141,24 @@ void drop_privileges()
 
 int exec_driver(int fd, const char* nsm_url, std::string_view exe_name)
 {
-	debug("Starting driver core\n");
+	LOG_DEBUG("Starting driver core");
 
 	F1HidDev dev(fd);
+	LedWriter leds(dev, initial_colors());
 	std::unique_ptr<NonSessionHandler> nsh;
 	std::unique_ptr<JackClient> jack;
 	if (nsm_url) {
-		nsh = std::make_unique<NonSessionHandler>(
-		  nsm_url, exe_name, F1Default::signals, true);
+		NonSignalList signals = F1Default::signals;
+		for (auto& signal : LedSignals::signals()) {
+			signals.push_back(signal);
+		}
+		auto on_led_signal = [&leds](size_t signal, float value) {
+			leds.update_remote([signal, value](LedWriter::RemoteState& remote) {
+				set_remote_led(remote, signal, value);
+			});
+		};
+		nsh = std::make_unique<NonSessionHandler>(nsm_url, exe_name, signals,
+		                                          true, on_led_signal);
 	} else {
 		jack = std::make_unique<JackClient>("Traktor Kontrol F1");
 	}
@@ -156,39 +178,29 @@ int exec_driver(int fd, const char* nsm_url, std::string_view exe_name)
 		jack->connect();
 	}
 
-	set_colors(dev);
-
-	std::bitset<4> stop_buttons;
+	F1InputMask<F1Device::STOP_BUTTONS_NUM> stop_buttons;
 
 	F1InpuState last{};
 
 	while (true) {
 		F1InpuState current = dev.read();
-		debug("Received input event\n");
+		LOG_DEBUG("Received input event");
 
 		F1InputChange input_diff = current - last;
 
-		decltype(input_diff.pressed_buttons.stop) new_pressed_stop;
-		decltype(input_diff.released_buttons.stop) new_released_stop;
-
-		for (auto& btn : input_diff.pressed_buttons.stop) {
-			stop_buttons.flip(btn);
-			if (stop_buttons[btn]) {
-				new_pressed_stop.push_back(btn);
-			} else {
-				new_released_stop.push_back(btn);
-			}
-		}
-
-		input_diff.pressed_buttons.stop = new_pressed_stop;
-		input_diff.released_buttons.stop = new_released_stop;
+		// Stop buttons act as toggles: every press flips the button state,
+		// which is reported as a press or a release
+		const auto toggled = input_diff.pressed_buttons.stop;
+		stop_buttons = stop_buttons ^ toggled;
+		input_diff.pressed_buttons.stop = toggled & stop_buttons;
+		input_diff.released_buttons.stop = toggled & ~stop_buttons;
 
 		if (nsh) {
 			nsh->broadcast_input_event(input_diff);
 		} else {
 			jack->push_event(input_diff);
 		}
-		set_colors(dev, input_diff);
+		set_colors(leds, input_diff);
 
 		last = current;
 	}
@@ -196,63 +208,61 @@ int exec_driver(int fd, const char* nsm_url, std::string_view exe_name)
 	return 0;
 }
 
-void set_colors(F1HidDev dev, const F1InputChange& input)
+F1HidDev::output initial_colors()
 {
-	static F1HidDev::output output;
-	static bool first_time{true};
-	if (first_time) {
-		debug("[KontrolF1] Setting initial button colors\n");
-		first_time = false;
-		for (size_t i = 0; i < 16; i++) {
-			auto color = colors::mtx.at(i);
-			for (auto& c : color) {
-				c *= colors::lightness_off;
-			}
-			output.matrix_btns.at(i) = color;
-		}
-
-		for (size_t i = 0; i < 4; i++) {
-			output.stop_btns.at(i) = 0x7f * colors::lightness_off;
-		}
+	LOG_DEBUG("[KontrolF1] Setting initial button colors");
+	F1HidDev::output output;
+	for (size_t i = 0; i < 16; i++) {
+		output.matrix_btns.at(i) =
+		  colors::dim(colors::mtx.at(i), colors::lightness_off);
+	}
 
-		dev.write(output);
+	for (size_t i = 0; i < 4; i++) {
+		output.stop_btns.at(i) = 0x7f * colors::lightness_off;
 	}
 
-	for (auto& btn : input.pressed_buttons.matrix) {
-		debug(std::string{"[KontrolF1] Turning on lights for matrix button "}
-		      + std::to_string(btn) + '\n');
-		auto color = colors::mtx[btn];
-		for (size_t i = 0; i < color.size(); ++i) {
-			color[i] *= colors::lightness_on;
-		}
+	return output;
+}
 
-		output.matrix_btns[btn] = color;
-	}
+void set_colors(LedWriter& leds, const F1InputChange& input)
+{
+	leds.update_input([&input](F1HidDev::output& output) {
+		for (const auto btn : input.pressed_buttons.matrix) {
+			LOG_DEBUG("[KontrolF1] Turning on lights for matrix button {}",
+			          btn);
+			output.matrix_btns[btn] =
+			  colors::dim(colors::mtx[btn], colors::lightness_on);
+		}
 
-	for (auto& btn : input.released_buttons.matrix) {
-		debug(std::string{"[KontrolF1] Turning off lights for matrix button "}
-		      + std::to_string(btn) + '\n');
-		auto color = colors::mtx[btn];
-		for (size_t i = 0; i < color.size(); ++i) {
-			color[i] *= colors::lightness_off;
+		for (const auto btn : input.released_buttons.matrix) {
+			LOG_DEBUG("[KontrolF1] Turning off lights for matrix button {}",
+			          btn);
+			output.matrix_btns[btn] =
+			  colors::dim(colors::mtx[btn], colors::lightness_off);
 		}
 
-		output.matrix_btns[btn] = color;
-	}
+		for (const auto btn : input.pressed_buttons.stop) {
+			LOG_DEBUG("[KontrolF1] Turning on lights for stop button {}", btn);
+			output.stop_btns[btn] = colors::lightness_on * 0x7f;
+		}
 
-	for (auto& btn : input.pressed_buttons.stop) {
-		debug(std::string{"[KontrolF1] Turning on lights for stop button "}
-		      + std::to_string(btn) + '\n');
-		output.stop_btns[btn] = colors::lightness_on * 0x7f;
-	}
+		for (const auto btn : input.released_buttons.stop) {
+			LOG_DEBUG("[KontrolF1] Turning off lights for stop button {}",
+			          btn);
+			output.stop_btns[btn] = colors::lightness_off * 0x7f;
+		}
+	});
+}
 
-	for (auto& btn : input.released_buttons.stop) {
-		debug(std::string{"[KontrolF1] Turning off lights for stop button "}
-		      + std::to_string(btn) + '\n');
-		output.stop_btns[btn] = colors::lightness_off * 0x7f;
+void set_remote_led(LedWriter::RemoteState& remote, size_t signal,
+                    float value)
+{
+	if (signal < LedSignals::LED_STOP) {
+		remote.matrix_btns.set((signal - LedSignals::LED_MATRIX) / 3);
+	} else if (signal < LedSignals::LED_SPECIAL) {
+		remote.stop_btns.set(signal - LedSignals::LED_STOP);
 	}
 
-	debug("[KontrolF1] Writing output\n");
-	dev.write(output);
+	LedSignals::apply(remote.output, signal, value);
 }
 } // namespace
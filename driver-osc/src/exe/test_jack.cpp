@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cassert>
 #include <iostream>
 #include <thread>
@@ -7,7 +8,7 @@
 #include <jack/ringbuffer.h>
 
 #include "JackClient.hpp"
-#include "debug.hpp"
+#include "Log.hpp"
 
 namespace
 {
@@ -22,7 +23,7 @@ struct process_metadata
 	jack_ringbuffer_t* in_buf;
 	jack_ringbuffer_t* out_buf;
 	size_t buf_size;
-	volatile size_t frames_processed{0};
+	std::atomic<size_t> frames_processed{0};
 };
 
 // volatile size_t processed{0};
@@ -65,7 +66,7 @@ int main(int argc, char** argv)
 	assert(client);
 	assert((status & JackStatus::JackFailure) == 0);
 
-	debug("Client opened");
+	LOG_DEBUG("Client opened");
 
 	jack_port_t* in = jack_port_register(client, "in", JACK_DEFAULT_MIDI_TYPE,
 	                                     JackPortFlags::JackPortIsInput, 0);
@@ -75,7 +76,7 @@ int main(int argc, char** argv)
 	                                      JackPortFlags::JackPortIsOutput, 0);
 	assert(out);
 	assert((status & JackStatus::JackFailure) == 0);
-	debug("Ports created!");
+	LOG_DEBUG("Ports created!");
 
 	process_metadata meta;
 	meta.client = client;
@@ -89,11 +90,11 @@ int main(int argc, char** argv)
 
 	int res = jack_set_process_callback(client, process, &meta);
 	assert(res == 0);
-	debug("Process callback set!\n");
+	LOG_DEBUG("Process callback set!");
 
 	res = jack_activate(client);
 	assert(res == 0);
-	debug("Client started!\n");
+	LOG_DEBUG("Client started!");
 
 	size_t last_frames_processed = meta.frames_processed;
 	while (true) {
@@ -0,0 +1,76 @@
+#include <utility>
+#include <vector>
+
+#include "test.hpp"
+
+#include "F1InputState.hpp"
+
+namespace
+{
+template <typename Range>
+auto collect(const Range& range)
+{
+	std::vector<std::decay_t<decltype(*range.begin())>> v;
+	for (const auto item : range) {
+		v.push_back(item);
+	}
+	return v;
+}
+} // namespace
+
+TEST(F1InputMask, iterates_set_bits_in_order)
+{
+	F1InputMask<16> mask;
+	EXPECT_TRUE(mask.empty());
+	EXPECT_EQ(mask.begin(), mask.end());
+
+	mask.set(15);
+	mask.set(0);
+	mask.set(7);
+	EXPECT_EQ(mask.size(), 3);
+	EXPECT_EQ(collect(mask), (std::vector<uint8_t>{0, 7, 15}));
+
+	mask.reset(7);
+	EXPECT_FALSE(mask.test(7));
+	EXPECT_EQ(collect(mask), (std::vector<uint8_t>{0, 15}));
+}
+
+TEST(F1InputMask, complement_stays_within_size)
+{
+	F1InputMask<4> mask{0b0101};
+	EXPECT_EQ((~mask).to_word(), 0b1010);
+	EXPECT_EQ((mask ^ F1InputMask<4>{0b1111}), ~mask);
+}
+
+TEST(F1InputChange, contains_only_changed_inputs)
+{
+	F1InpuState old_state{};
+	old_state.matrix_btns.set(1);
+	old_state.matrix_btns.set(2);
+	old_state.stop_btns.set(3);
+	old_state.knobs[2] = 0x100;
+
+	F1InpuState new_state = old_state;
+	new_state.matrix_btns.reset(1);
+	new_state.matrix_btns.set(4);
+	new_state.special_btns.set(8);
+	new_state.knobs[2] = 0x200;
+	new_state.faders[0] = 0xfff;
+	new_state.wheel = 3;
+
+	const F1InputChange diff = new_state - old_state;
+
+	EXPECT_EQ(collect(diff.pressed_buttons.matrix), std::vector<uint8_t>{4});
+	EXPECT_EQ(collect(diff.released_buttons.matrix), std::vector<uint8_t>{1});
+	EXPECT_TRUE(diff.pressed_buttons.stop.empty());
+	EXPECT_TRUE(diff.released_buttons.stop.empty());
+	EXPECT_EQ(collect(diff.pressed_buttons.special), std::vector<uint8_t>{8});
+	EXPECT_TRUE(diff.released_buttons.special.empty());
+
+	using encoder = std::pair<uint8_t, uint16_t>;
+	EXPECT_EQ(collect(diff.knobs), (std::vector<encoder>{{2, 0x200}}));
+	EXPECT_EQ(collect(diff.faders), (std::vector<encoder>{{0, 0xfff}}));
+
+	EXPECT_EQ(diff.wheel_diff, 3);
+	EXPECT_EQ(diff.wheel, 3);
+}
@@ -0,0 +1,59 @@
+#include "test.hpp"
+
+#include "LedSignals.hpp"
+
+TEST(LedSignals, lists_all_inbound_signals_in_index_order)
+{
+	const auto signals = LedSignals::signals();
+	ASSERT_EQ(LedSignals::LED_SIGNALS_NUM, signals.size());
+
+	EXPECT_EQ("/kontrolf1/led/mtx/0/red", signals.at(0).path);
+	EXPECT_EQ("/kontrolf1/led/mtx/15/blue",
+	          signals.at(LedSignals::LED_STOP - 1).path);
+	EXPECT_EQ("/kontrolf1/led/stop/0", signals.at(LedSignals::LED_STOP).path);
+	EXPECT_EQ("/kontrolf1/led/special/8",
+	          signals.at(LedSignals::LED_SEGMENT - 1).path);
+	EXPECT_EQ("/kontrolf1/led/segment",
+	          signals.at(LedSignals::LED_SEGMENT).path);
+	EXPECT_EQ(99.f, signals.at(LedSignals::LED_SEGMENT).max);
+
+	for (const auto& signal : signals) {
+		EXPECT_EQ(NonSignal::Direction::IN, signal.direction);
+	}
+}
+
+TEST(LedSignals, sets_matrix_colors)
+{
+	F1Device::OutputState state;
+	LedSignals::apply(state, LedSignals::LED_MATRIX + 3 * 2 + 0, 1.f);
+	LedSignals::apply(state, LedSignals::LED_MATRIX + 3 * 2 + 2, .5f);
+
+	const auto [b, r, g] = state.matrix_btns.at(2);
+	EXPECT_EQ(F1Device::FULL_BRIGHTNESS, r);
+	EXPECT_EQ(F1Device::DARK, g);
+	EXPECT_EQ(64, b);
+	EXPECT_EQ(F1Device::BLACK, state.matrix_btns.at(1));
+}
+
+TEST(LedSignals, clamps_brightness)
+{
+	F1Device::OutputState state;
+	LedSignals::apply(state, LedSignals::LED_STOP + 3, 2.f);
+	LedSignals::apply(state, LedSignals::LED_SPECIAL + 1, -1.f);
+
+	EXPECT_EQ(F1Device::FULL_BRIGHTNESS, state.stop_btns.at(3));
+	EXPECT_EQ(F1Device::DARK, state.special_btns.at(1));
+}
+
+TEST(LedSignals, shows_numbers_on_segment_display)
+{
+	F1Device::OutputState state;
+	LedSignals::apply(state, LedSignals::LED_SEGMENT, 42.f);
+	LedSignals::apply(state, LedSignals::LED_SEGMENT_BRIGHTNESS, 1.f);
+
+	const auto [left, right] = F1Device::num_to_segments(42);
+	EXPECT_EQ(left, state.segment_left_char);
+	EXPECT_EQ(right, state.segment_right_char);
+	EXPECT_EQ(F1Device::FULL_BRIGHTNESS, state.segment_left_brightness);
+	EXPECT_EQ(F1Device::FULL_BRIGHTNESS, state.segment_right_brightness);
+}
@@ -0,0 +1,70 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test.hpp"
+
+#include "Log.hpp"
+
+TEST(LogRecord, formats_arguments_lazily)
+{
+	const std::string peer{"osc.udp://localhost:1234/"};
+	const LogRecord record{LogLevel::debug, "file.cpp", 1,
+	                       "Sending {} values ({}) to {}: {}",
+	                       uint8_t{3}, -1, peer, true};
+	EXPECT_EQ(record.message(),
+	          "Sending 3 values (-1) to osc.udp://localhost:1234/: true");
+}
+
+TEST(LogRecord, truncates_long_text)
+{
+	const std::string long_text(2 * LogRecord::TEXT_SIZE, 'a');
+	const LogRecord record{LogLevel::debug, "file.cpp", 1, "{} {}",
+	                       long_text, "b"};
+	EXPECT_EQ(record.message(),
+	          std::string(LogRecord::TEXT_SIZE, 'a') + ' ');
+}
+
+TEST(LogRecord, ignores_missing_arguments)
+{
+	const LogRecord record{LogLevel::debug, "file.cpp", 1, "{} and {}", 1};
+	EXPECT_EQ(record.message(), "1 and {}");
+}
+
+TEST(Logger, prints_records_from_all_threads)
+{
+	constexpr int THREADS{4};
+	constexpr int RECORDS{32};
+	std::ostringstream out;
+	{
+		Logger logger{out};
+		std::vector<std::thread> writers;
+		for (int t = 0; t < THREADS; ++t) {
+			writers.emplace_back([&logger, t]() {
+				for (int i = 0; i < RECORDS; ++i) {
+					logger.write(LogLevel::info, "file.cpp", 42,
+					             "thread {} record {}", t, i);
+				}
+			});
+		}
+		for (auto& writer : writers) {
+			writer.join();
+		}
+	}
+
+	const std::string log = out.str();
+	EXPECT_NE(log.find("[INF] file.cpp:42: thread 3 record 31\n"),
+	          std::string::npos);
+
+	// Every record is either printed or counted as dropped
+	size_t printed = 0;
+	for (size_t pos = log.find("record"); pos != std::string::npos;
+	     pos = log.find("record", pos + 1)) {
+		++printed;
+	}
+	size_t dropped = 0;
+	if (const auto pos = log.find("Dropped "); pos != std::string::npos)
+		dropped = std::stoul(log.substr(pos + 8));
+	EXPECT_EQ(printed + dropped, THREADS * RECORDS);
+}
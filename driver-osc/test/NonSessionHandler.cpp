@@ -13,7 +13,7 @@
 #include "config.h"
 
 #define DBG_MODULE_NAME "NSH_TEST"
-#include "debug.hpp"
+#include "Log.hpp"
 
 namespace
 {
@@ -37,8 +37,8 @@ public:
 	inline ServerEmulation(bool start_immediately = true)
 	    : server_thread(nullptr), server_uri(server_thread.url())
 	{
-		debug(std::string{"Initializing server thread with URL "}
-		      + server_thread.url() + '\n');
+		LOG_DEBUG("Initializing server thread with URL {}",
+		          server_thread.url());
 		server_thread.add_method(
 		  NonSessionHandler::NSM_ANNOUNCE, "sssiii",
 		  [this](lo::Message msg) {
@@ -46,7 +46,7 @@ public:
 		  },
 		  nullptr);
 		server_thread.add_method("/reply", "ss", [this](lo::Message msg) {
-			debug("ServerEmulation: Received /reply\n");
+			LOG_DEBUG("ServerEmulation: Received /reply");
 			received_messages.push({"/reply", msg});
 		});
 		server_thread.add_method(
@@ -54,7 +54,7 @@ public:
 		  [this](lo::Message msg) { received_broadcasts.push(msg); });
 
 		if (start_immediately) {
-			debug("ServerEmulation: Starting server_thread\n");
+			LOG_DEBUG("ServerEmulation: Starting server_thread");
 			server_thread.start();
 			short_sleep<>();
 		}
@@ -65,8 +65,8 @@ public:
 	{
 		nsh.start_session();
 		short_sleep<>();
-		debug("Sending /reply announce to "
-		      + static_cast<lo::Address>(nsh).url() + '\n');
+		LOG_DEBUG("Sending /reply announce to {}",
+		          static_cast<lo::Address>(nsh).url());
 		lo::Address{nsh}.send_from(
 		  server_thread, "/reply", "ssss", NonSessionHandler::NSM_ANNOUNCE,
 		  "hello", "name_of_session_manager",
@@ -76,7 +76,7 @@ public:
 
 	void load_session(NonSessionHandler& nsh)
 	{
-		debug("Opening project and sending all ready\n");
+		LOG_DEBUG("Opening project and sending all ready");
 		lo::Address{nsh}.send_from(server_thread, NonSessionHandler::NSM_OPEN,
 		                           "sss", "path", "display_name", "client_id");
 		short_sleep<>();
@@ -95,18 +95,18 @@ class MixerEmulation : public ServerEmulation
 public:
 	MixerEmulation() : ServerEmulation(false)
 	{
-		debug("MixerEmulation: Listening at " + server_thread.url() + '\n');
+		LOG_DEBUG("MixerEmulation: Listening at {}", server_thread.url());
 		server_thread.add_method("/reply", "sssfff", [this](lo::Message msg) {
-			debug("MixerEmulation: Received reply\n");
+			LOG_DEBUG("MixerEmulation: Received reply");
 			received_messages.push({"/reply", msg});
 		});
 		server_thread.add_method("/reply", "s", [this](lo::Message msg) {
-			debug("MixerEmulation: Received reply\n");
+			LOG_DEBUG("MixerEmulation: Received reply");
 			received_messages.push({"/reply", msg});
 		});
 		server_thread.add_method(
 		  NonSessionHandler::OSC_SIGNAL_LIST, "", [this](lo::Message msg) {
-			  debug("MixerEmulation: Received signal list\n");
+			  LOG_DEBUG("MixerEmulation: Received signal list");
 			  received_messages.push({"/signal/list", msg});
 		  });
 
@@ -118,7 +118,7 @@ public:
 
 	void send_hello(NonSessionHandler& nsh)
 	{
-		debug("MixerEmulation: Sending hello\n");
+		LOG_DEBUG("MixerEmulation: Sending hello");
 		lo::Address{nsh}.send_from(server_thread, NonSessionHandler::NSM_HELLO,
 		                           "ssss", server_thread.url().c_str(),
 		                           client_name.c_str(), "42.42",
@@ -133,7 +133,7 @@ public:
 
 	void transmit_signal_list(NonSessionHandler& nsh)
 	{
-		debug("MixerEmulation: Transmitting signal list\n");
+		LOG_DEBUG("MixerEmulation: Transmitting signal list");
 		lo::Address nsh_addr = nsh;
 		for (const auto& signal : signals) {
 			nsh_addr.send_from(server_thread, "/reply", "ssfff",
@@ -200,8 +200,8 @@ TEST(NonSessionHandler, is_failed_after_failed_handshake)
 	nsh.start_session();
 	short_sleep<>();
 
-	debug("Sending /error announce to " + static_cast<lo::Address>(nsh).url()
-	      + '\n');
+	LOG_DEBUG("Sending /error announce to {}",
+	          static_cast<lo::Address>(nsh).url());
 	lo::Address{nsh}.send_from(srv.server_thread, "/error", "sis",
 	                           NonSessionHandler::NSM_ANNOUNCE, -1,
 	                           "my error message");
@@ -385,7 +385,7 @@ TEST(NonSessionHandler, replies_to_open_command)
 	NonSessionHandler nsh(srv.server_uri, "/invalid/path/exe");
 	srv.prepare_session(nsh);
 
-	debug("Sending open\n");
+	LOG_DEBUG("Sending open");
 	lo::Address{nsh}.send_from(srv.server_thread, NonSessionHandler::NSM_OPEN,
 	                           "sss", "projectpath", "display_name",
 	                           "client_id");
@@ -402,7 +402,7 @@ TEST(NonSessionHandler, replies_to_save_command)
 	NonSessionHandler nsh(srv.server_uri, "/invalid/path/exe");
 	srv.prepare_session(nsh);
 
-	debug("Sending save");
+	LOG_DEBUG("Sending save");
 	lo::Address{nsh}.send_from(srv.server_thread, NonSessionHandler::NSM_SAVE,
 	                           "");
 	short_sleep<>();
@@ -413,6 +413,26 @@ TEST(NonSessionHandler, replies_to_save_command)
 	          reinterpret_cast<const char*>(&save_reply.second.argv()[0]->s));
 }
 
+TEST(NonSessionHandler, passes_inbound_signal_values_to_input_handler)
+{
+	ServerEmulation srv;
+	MixerEmulation mix;
+	std::map<size_t, float> received;
+	NonSessionHandler nsh(
+	  srv.server_uri, "/invalid/path/exe",
+	  {{"/out/1", 0.f, 1.f, 0.f},
+	   {"/in/1", 0.f, 1.f, 0.f, NonSignal::Direction::IN},
+	   {"/in/2", 0.f, 1.f, 0.f, NonSignal::Direction::IN}},
+	  false,
+	  [&received](size_t signal, float value) { received[signal] = value; });
+
+	lo::Address{nsh}.send_from(mix.server_thread, "/in/2", "f", .5f);
+	short_sleep<>();
+
+	ASSERT_EQ(1, received.size());
+	ASSERT_EQ(.5f, received.at(1));
+}
+
 class MixerEmulationWithSigReceiver : public MixerEmulation
 {
 public:
@@ -420,8 +440,8 @@ public:
 	    : MixerEmulation()
 	{
 		for (const auto& signal : signals) {
-			debug(std::string{"MixerEmulation: Registering handler for signal "}
-			      + signal.path + '\n');
+			LOG_DEBUG("MixerEmulation: Registering handler for signal {}",
+			          signal.path);
 			server_thread.add_method(
 			  signal.path, "f", [this, signal](lo::Message msg) {
 				  received_signals.emplace(signal.path, msg.argv()[0]->f);
@@ -429,6 +449,21 @@ public:
 		}
 	}
 
+	/**
+	 * Connect our signals to the signals of the same path at nsh
+	 */
+	void connect_signals(NonSessionHandler& nsh, const NonSignalList& signals,
+	                     bool connect = true)
+	{
+		const char* cmd = connect ? NonSessionHandler::OSC_SIGNAL_CONNECT
+		                          : NonSessionHandler::OSC_SIGNAL_DISCONNECT;
+		for (const auto& signal : signals) {
+			lo::Address{nsh}.send_from(server_thread, cmd, "ss",
+			                           signal.path.c_str(),
+			                           signal.path.c_str());
+		}
+	}
+
 	std::map<std::string, float> received_signals;
 };
 
@@ -444,6 +479,8 @@ protected:
 		short_sleep<>();
 		mix.transmit_signal_list(nsh);
 		short_sleep<>();
+		mix.connect_signals(nsh, signals);
+		short_sleep<>();
 		srv.received_messages = {};
 		mix.received_messages = {};
 	}
@@ -459,11 +496,11 @@ protected:
 
 TEST_F(NonSessionHandlerOnInput, broadcasts_matrix_input_changes)
 {
-	diff.pressed_buttons.matrix.push_back(3);
-	diff.pressed_buttons.matrix.push_back(4);
+	diff.pressed_buttons.matrix.set(3);
+	diff.pressed_buttons.matrix.set(4);
 
-	diff.released_buttons.matrix.push_back(1);
-	diff.released_buttons.matrix.push_back(2);
+	diff.released_buttons.matrix.set(1);
+	diff.released_buttons.matrix.set(2);
 
 	nsh.broadcast_input_event(diff);
 	short_sleep<>();
@@ -477,8 +514,8 @@ TEST_F(NonSessionHandlerOnInput, broadcasts_matrix_input_changes)
 
 TEST_F(NonSessionHandlerOnInput, broadcasts_stop_input_changes)
 {
-	diff.pressed_buttons.stop.push_back(0);
-	diff.released_buttons.stop.push_back(1);
+	diff.pressed_buttons.stop.set(0);
+	diff.released_buttons.stop.set(1);
 
 	nsh.broadcast_input_event(diff);
 	short_sleep<>();
@@ -490,8 +527,8 @@ TEST_F(NonSessionHandlerOnInput, broadcasts_stop_input_changes)
 
 TEST_F(NonSessionHandlerOnInput, broadcasts_special_button_input_changes)
 {
-	diff.pressed_buttons.special.push_back(2);
-	diff.released_buttons.special.push_back(3);
+	diff.pressed_buttons.special.set(2);
+	diff.released_buttons.special.set(3);
 
 	nsh.broadcast_input_event(diff);
 	short_sleep<>();
@@ -503,8 +540,8 @@ TEST_F(NonSessionHandlerOnInput, broadcasts_special_button_input_changes)
 
 TEST_F(NonSessionHandlerOnInput, broadcasts_knob_and_fader_input_changes)
 {
-	diff.knobs.push_back({1, 0xfff});
-	diff.faders.push_back({3, 0x000});
+	diff.knobs.set(1, 0xfff);
+	diff.faders.set(3, 0x000);
 
 	nsh.broadcast_input_event(diff);
 	short_sleep<>();
@@ -513,3 +550,34 @@ TEST_F(NonSessionHandlerOnInput, broadcasts_knob_and_fader_input_changes)
 	ASSERT_LE(1.f, mix.received_signals.at("/kontrolf1/knob/1"));
 	ASSERT_EQ(0.f, mix.received_signals.at("/kontrolf1/fader/3"));
 }
+
+TEST_F(NonSessionHandlerOnInput, routes_signals_to_connected_peers_only)
+{
+	ASSERT_TRUE(nsh.subscriptions(mix.client_id).all());
+
+	mix.connect_signals(nsh, {signals.at(NonSessionHandler::SIG_MATRIX)},
+	                    false);
+	short_sleep<>();
+	ASSERT_FALSE(
+	  nsh.subscriptions(mix.client_id)[NonSessionHandler::SIG_MATRIX]);
+
+	diff.pressed_buttons.matrix.set(0);
+	diff.pressed_buttons.matrix.set(1);
+
+	nsh.broadcast_input_event(diff);
+	short_sleep<>();
+
+	ASSERT_EQ(1, mix.received_signals.size());
+	ASSERT_EQ(1.f, mix.received_signals.at("/kontrolf1/mtx/1"));
+}
+
+TEST_F(NonSessionHandlerOnInput, ignores_connections_to_unknown_signals)
+{
+	mix.connect_signals(nsh, {{"/kontrolf1/unknown", 0.f, 1.f, 0.f}});
+	lo::Address{nsh}.send_from(mix.server_thread,
+	                           NonSessionHandler::OSC_SIGNAL_DISCONNECT, "ss",
+	                           "/kontrolf1/mtx/0", "/unknown/signal");
+	short_sleep<>();
+
+	ASSERT_TRUE(nsh.subscriptions(mix.client_id).all());
+}
@@ -0,0 +1,67 @@
+#include <cstring>
+#include <vector>
+
+#include "test.hpp"
+
+#include "OscPacket.hpp"
+
+namespace
+{
+std::vector<uint8_t> to_vector(std::span<const std::byte> bytes)
+{
+	std::vector<uint8_t> v(bytes.size());
+	std::memcpy(v.data(), bytes.data(), bytes.size());
+	return v;
+}
+} // namespace
+
+TEST(OscPath, is_padded_to_four_bytes)
+{
+	EXPECT_EQ(OscPath{"/abc"}.bytes().size(), 8);
+	EXPECT_EQ(OscPath{"/ab"}.bytes().size(), 4);
+	EXPECT_EQ(OscPath{"/kontrolf1/mtx/15"}.str(), "/kontrolf1/mtx/15");
+	EXPECT_THROW(OscPath{std::string(OscPath::MAX_SIZE, 'a')},
+	             std::length_error);
+}
+
+TEST(OscBundleWriter, serializes_float_messages)
+{
+	OscBundleWriter writer;
+	ASSERT_TRUE(writer.empty());
+	ASSERT_EQ(writer.datagram().size(), 16);
+
+	ASSERT_TRUE(writer.add_float(OscPath{"/a/1"}, 1.f));
+	ASSERT_FALSE(writer.empty());
+
+	// clang-format off
+	const std::vector<uint8_t> expected{
+	  '#', 'b', 'u', 'n', 'd', 'l', 'e', 0,
+	  0, 0, 0, 0, 0, 0, 0, 1,
+	  0, 0, 0, 16,
+	  '/', 'a', '/', '1', 0, 0, 0, 0,
+	  ',', 'f', 0, 0,
+	  0x3f, 0x80, 0, 0,
+	};
+	// clang-format on
+	EXPECT_EQ(to_vector(writer.datagram()), expected);
+
+	writer.clear();
+	EXPECT_TRUE(writer.empty());
+	EXPECT_EQ(writer.datagram().size(), 16);
+}
+
+TEST(OscBundleWriter, rejects_messages_which_do_not_fit)
+{
+	OscBundleWriter writer;
+	const OscPath path{"/kontrolf1/special/8"};
+
+	size_t added{0};
+	while (writer.add_float(path, .5f)) {
+		++added;
+	}
+	EXPECT_EQ(added, (OscBundleWriter::MAX_DATAGRAM_SIZE - 16) / 36);
+
+	const auto size = writer.datagram().size();
+	EXPECT_FALSE(writer.add_float(path, .5f));
+	EXPECT_EQ(writer.datagram().size(), size);
+}
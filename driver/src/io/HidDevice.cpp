@@ -1,12 +1,164 @@
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cstring>
+#include <system_error>
 
 #include <fcntl.h>
 #include <linux/hidraw.h>
 #include <sys/ioctl.h>
 
 #include "HidDevice.hpp"
+#include "IoUring.hpp"
+
+/**
+ * io_uring transport of a HID device
+ *
+ * Reports are read by a single multishot read, which completes into
+ * provided buffers and thus in order. The kernel only does the reads when
+ * the reading thread waits for completions (IORING_SETUP_DEFER_TASKRUN):
+ * one io_uring_enter() reads all reports which have arrived since the last
+ * one, and they are consumed from the completion queue without further
+ * syscalls.
+ *
+ * Each write is submitted and waited for with a single io_uring_enter() and
+ * uses a registered buffer.
+ */
+class HidDevice::Uring final
+{
+	constexpr static unsigned RING_ENTRIES{4};
+	/**
+	 * Reports read ahead at most, further ones wait in the kernel
+	 */
+	constexpr static std::size_t READ_BUFFERS_NUM{16};
+
+public:
+	explicit Uring(int fd) : fd(fd)
+	{
+		if (not read_ring.supports(IoUring::OP_READ_MULTISHOT)) {
+			throw std::system_error{
+				std::make_error_code(std::errc::not_supported)
+			};
+		}
+	}
+
+	void read(void* buf, std::size_t buf_size)
+	{
+		if (buf_size > MAX_URING_REPORT_SIZE) {
+			throw HidDeviceError{"Report too large for io_uring"};
+		}
+		// The kernel reads ahead, so it has to know the report size.
+		// The reading thread is the only one to submit to the ring.
+		if (report_size == 0) {
+			read_ring.enable();
+			report_size = buf_size;
+			for (std::size_t i = 0; i < READ_BUFFERS_NUM; ++i) {
+				read_ring.provide(i, report_size);
+			}
+			start_reading();
+		} else if (buf_size != report_size) {
+			throw HidDeviceError{"Report size changed"};
+		}
+
+		while (true) {
+			const auto* cqe = read_ring.peek();
+			if (cqe == nullptr) {
+				read_ring.submit_and_wait(1);
+				continue;
+			}
+			const int res = cqe->res;
+			const std::uint32_t flags = cqe->flags;
+			read_ring.pop();
+
+			// The read stops on errors and if it runs out of
+			// buffers, the reports then wait in the kernel
+			if ((flags & IORING_CQE_F_MORE) == 0) {
+				start_reading();
+			}
+			if ((flags & IORING_CQE_F_BUFFER) == 0) {
+				if (res != -ENOBUFS) {
+					check_result(res, buf_size);
+				}
+				continue;
+			}
+
+			// Copied before the buffer is handed back
+			const std::size_t idx =
+				flags >> IORING_CQE_BUFFER_SHIFT;
+			std::copy_n(
+				read_ring.buffer(idx).begin(),
+				buf_size,
+				static_cast<std::uint8_t*>(buf)
+			);
+			read_ring.provide(idx, report_size);
+			check_result(res, buf_size);
+			return;
+		}
+	}
+
+	void write(bytestr buf)
+	{
+		if (buf.size() > MAX_URING_REPORT_SIZE) {
+			throw HidDeviceError{"Report too large for io_uring"};
+		}
+
+		const auto write_buffer = write_ring.buffer(0);
+		std::copy(buf.begin(), buf.end(), write_buffer.begin());
+		auto& sqe = write_ring.queue();
+		sqe.opcode = IORING_OP_WRITE_FIXED;
+		sqe.fd = fd;
+		sqe.addr = reinterpret_cast<std::uintptr_t>( // NOLINT(*-cast)
+			write_buffer.data()
+		);
+		sqe.len = static_cast<std::uint32_t>(buf.size());
+		sqe.buf_index = 0;
+		write_ring.submit_and_wait(1);
+
+		const auto* cqe = write_ring.peek();
+		assert(cqe != nullptr);
+		const int res = cqe->res;
+		write_ring.pop();
+
+		check_result(res, buf.size());
+	}
+
+private:
+	/**
+	 * Queue the multishot read, submitted with the next wait
+	 */
+	void start_reading()
+	{
+		auto& sqe = read_ring.queue();
+		sqe.opcode = IoUring::OP_READ_MULTISHOT;
+		sqe.fd = fd;
+		sqe.flags = IOSQE_BUFFER_SELECT;
+		sqe.buf_group = IoUring::BUFFER_GROUP;
+	}
+
+	static void check_result(int res, std::size_t expected)
+	{
+		if (res < 0) {
+			throw HidDeviceError{strerror(-res)};
+		}
+		if (static_cast<std::size_t>(res) < expected) {
+			throw HidDeviceError{"Incomplete report"};
+		}
+	}
+
+	int fd;
+	std::size_t report_size{0};
+	// Separate rings, so reads and writes may be issued concurrently. The
+	// completion queue of the read ring holds a completion per buffer.
+	IoUring read_ring{
+		READ_BUFFERS_NUM,
+		READ_BUFFERS_NUM,
+		MAX_URING_REPORT_SIZE,
+		IoUring::Buffers::PROVIDED,
+		IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN |
+			IORING_SETUP_R_DISABLED
+	};
+	IoUring write_ring{RING_ENTRIES, 1, MAX_URING_REPORT_SIZE};
+};
 
 // NOLINTNEXTLINE(*-vararg)
 HidDevice::HidDevice(const char* path) : fd(open(path, O_RDWR))
@@ -20,6 +172,10 @@ HidDevice::HidDevice(const char* path) : fd(open(path, O_RDWR))
 	}
 }
 
+HidDevice::HidDevice(HidDevice&&) noexcept = default;
+HidDevice& HidDevice::operator=(HidDevice&&) noexcept = default;
+HidDevice::~HidDevice() noexcept(false) = default;
+
 hidraw_devinfo HidDevice::devinfo() const
 {
 	assert(fd);
@@ -34,8 +190,24 @@ hidraw_devinfo HidDevice::devinfo() const
 	return devinfo;
 }
 
+bool HidDevice::enable_io_uring()
+{
+	assert(fd);
+	try {
+		uring = std::make_unique<Uring>(*fd);
+	} catch (std::system_error&) {
+		return false;
+	}
+	return true;
+}
+
 void HidDevice::write(bytestr buf) const
 {
+	if (uring) {
+		uring->write(buf);
+		return;
+	}
+
 	const ssize_t written = ::write(*fd, buf.data(), buf.size());
 	if (written < static_cast<ssize_t>(buf.size())) {
 		throw_strerror();
@@ -44,6 +216,11 @@ void HidDevice::write(bytestr buf) const
 
 void HidDevice::read(void* buf, std::size_t buf_size) const
 {
+	if (uring) {
+		uring->read(buf, buf_size);
+		return;
+	}
+
 	const ssize_t read = ::read(*fd, buf, buf_size);
 	if (read < static_cast<ssize_t>(buf_size)) {
 		throw_strerror();
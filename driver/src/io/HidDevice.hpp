@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -14,28 +15,63 @@ extern "C" {
 
 /**
  * Abstraction for access to a HID device
+ *
+ * Reports are read and written with read() and write() syscalls by
+ * default. Optionally, they are transferred through io_uring instead, see
+ * enable_io_uring().
  */
 class HidDevice
 {
 public:
 	using bytestr = std::basic_string_view<std::uint8_t>;
 
+	/**
+	 * Largest report which can be transferred through io_uring
+	 */
+	constexpr static std::size_t MAX_URING_REPORT_SIZE{256};
+
 	explicit HidDevice(const char* path);
 	HidDevice(const HidDevice&) = delete;
 	HidDevice& operator=(const HidDevice&) = delete;
-	HidDevice(HidDevice&&) = default;
-	HidDevice& operator=(HidDevice&&) = default;
-	~HidDevice() noexcept(false) = default;
+	HidDevice(HidDevice&&) noexcept;
+	HidDevice& operator=(HidDevice&&) noexcept;
+	~HidDevice() noexcept(false);
 
 	[[nodiscard]] hidraw_devinfo devinfo() const;
 
+	/**
+	 * Transfer the reports through io_uring
+	 *
+	 * Reports are read ahead by a multishot read, so a single syscall
+	 * reads all reports which have arrived in the meantime. Each write
+	 * takes one syscall. Reads and writes use separate rings, so read()
+	 * and write() may still be called from different threads, but each
+	 * from one thread only. Reports must not be larger than
+	 * MAX_URING_REPORT_SIZE, and all reads must have the same size.
+	 *
+	 * @return false if io_uring or multishot reads (Linux 6.7) are not
+	 * available, in which case the syscalls are used further on
+	 */
+	bool enable_io_uring();
+
 	void write(bytestr buf) const;
 	void read(void* buf, std::size_t buf_size) const;
 
 private:
+	class Uring;
+
 	static void throw_strerror();
 
 	FileDescriptor<> fd;
+	/**
+	 * io_uring rings, if enabled
+	 *
+	 * read() and write() are const like the syscalls they replace, but
+	 * take and recycle the buffers of the rings, hence mutable. As with
+	 * the syscalls, the caller must not read or write concurrently from
+	 * several threads.
+	 */
+	mutable std::unique_ptr<Uring> uring;
 };
 
 class HidDeviceError : public std::runtime_error
@@ -0,0 +1,259 @@
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <system_error>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "IoUring.hpp"
+
+namespace
+{
+[[noreturn]] void throw_errno()
+{
+	throw std::system_error{errno, std::system_category()};
+}
+
+void ring_register(int fd, unsigned opcode, void* arg, unsigned nr_args)
+{
+	// NOLINTNEXTLINE(*-vararg)
+	const auto res =
+		syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+	if (res < 0) {
+		throw_errno();
+	}
+}
+
+int setup(unsigned entries, std::uint32_t flags, io_uring_params& params)
+{
+	params.flags = flags;
+	// NOLINTNEXTLINE(*-vararg)
+	const auto fd = syscall(__NR_io_uring_setup, entries, &params);
+	if (fd < 0) {
+		throw_errno();
+	}
+	return static_cast<int>(fd);
+}
+
+std::atomic_ref<unsigned> shared(unsigned* value) noexcept
+{
+	return std::atomic_ref<unsigned>{*value};
+}
+} // namespace
+
+IoUring::Mapping::Mapping(int fd, std::size_t size, off_t offset) :
+	addr(mmap(
+		nullptr,
+		size,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE,
+		fd,
+		offset
+	)),
+	size(size)
+{
+	if (addr == MAP_FAILED) { // NOLINT(*-cstyle-cast,*-int-to-ptr)
+		addr = nullptr;
+		throw_errno();
+	}
+}
+
+IoUring::Mapping::Mapping(std::size_t size) : size(size)
+{
+	if (size == 0)
+		return;
+
+	addr = mmap(
+		nullptr,
+		size,
+		PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE,
+		-1,
+		0
+	);
+	if (addr == MAP_FAILED) { // NOLINT(*-cstyle-cast,*-int-to-ptr)
+		addr = nullptr;
+		throw_errno();
+	}
+}
+
+IoUring::Mapping::~Mapping()
+{
+	if (addr != nullptr) {
+		munmap(addr, size);
+	}
+}
+
+IoUring::IoUring(
+	unsigned entries,
+	std::size_t buffers_num,
+	std::size_t buffer_size,
+	Buffers kind,
+	std::uint32_t flags
+) :
+	params{},
+	buffers(buffers_num * buffer_size),
+	buffer_size(buffer_size),
+	buffer_ring(
+		kind == Buffers::PROVIDED ? buffers_num * sizeof(io_uring_buf)
+					  : 0
+	),
+	buffer_ring_size(kind == Buffers::PROVIDED ? buffers_num : 0),
+	fd(setup(entries, flags, params)),
+	sq_ring(*fd,
+		params.sq_off.array + (params.sq_entries * sizeof(unsigned)),
+		IORING_OFF_SQ_RING),
+	cq_ring(*fd,
+		params.cq_off.cqes +
+			(params.cq_entries * sizeof(io_uring_cqe)),
+		IORING_OFF_CQ_RING),
+	sqes(*fd, params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES),
+	sq_head(sq_ring.at<unsigned>(params.sq_off.head)),
+	sq_tail(sq_ring.at<unsigned>(params.sq_off.tail)),
+	sq_array(sq_ring.at<unsigned>(params.sq_off.array)),
+	cq_head(cq_ring.at<unsigned>(params.cq_off.head)),
+	cq_tail(cq_ring.at<unsigned>(params.cq_off.tail)),
+	cqes(cq_ring.at<io_uring_cqe>(params.cq_off.cqes))
+{
+	if (buffers_num == 0)
+		return;
+
+	if (kind == Buffers::PROVIDED) {
+		assert(std::has_single_bit(buffers_num));
+		io_uring_buf_reg reg{};
+		reg.ring_addr = reinterpret_cast<std::uintptr_t>( // NOLINT
+			buffer_ring.at<io_uring_buf>(0)
+		);
+		reg.ring_entries = static_cast<std::uint32_t>(buffers_num);
+		reg.bgid = BUFFER_GROUP;
+		ring_register(*fd, IORING_REGISTER_PBUF_RING, &reg, 1);
+		return;
+	}
+
+	std::vector<iovec> iovecs;
+	for (std::size_t i = 0; i < buffers_num; ++i) {
+		const auto buf = buffer(i);
+		iovecs.push_back({buf.data(), buf.size()});
+	}
+	ring_register(
+		*fd,
+		IORING_REGISTER_BUFFERS,
+		iovecs.data(),
+		static_cast<unsigned>(iovecs.size())
+	);
+}
+
+bool IoUring::supports(std::uint8_t opcode) const
+{
+	// io_uring_probe followed by an entry for each possible opcode
+	constexpr std::size_t OPS_NUM{256};
+	constexpr std::size_t PROBE_SIZE{
+		sizeof(io_uring_probe) + (OPS_NUM * sizeof(io_uring_probe_op))
+	};
+	std::vector<std::uint64_t> mem(PROBE_SIZE / sizeof(std::uint64_t));
+	auto* probe = reinterpret_cast<io_uring_probe*>( // NOLINT(*-cast)
+		mem.data()
+	);
+	ring_register(*fd, IORING_REGISTER_PROBE, probe, OPS_NUM);
+
+	return opcode < probe->ops_len &&
+	       (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+}
+
+void IoUring::enable()
+{
+	ring_register(*fd, IORING_REGISTER_ENABLE_RINGS, nullptr, 0);
+}
+
+std::span<std::uint8_t> IoUring::buffer(std::size_t idx) const noexcept
+{
+	return {buffers.at<std::uint8_t>(idx * buffer_size), buffer_size};
+}
+
+void IoUring::provide(std::size_t idx, std::size_t len) noexcept
+{
+	assert(buffer_ring_size > 0 && len <= buffer_size);
+	auto* ring = buffer_ring.at<io_uring_buf>(0);
+	// Only this thread moves the tail, the kernel moves the head
+	// NOLINTNEXTLINE(*-pointer-arithmetic)
+	auto& buf = ring[provided & (buffer_ring_size - 1)];
+	buf.addr = reinterpret_cast<std::uintptr_t>( // NOLINT(*-cast)
+		buffer(idx).data()
+	);
+	buf.len = static_cast<std::uint32_t>(len);
+	buf.bid = static_cast<std::uint16_t>(idx);
+
+	// The tail overlays the resv field of the first entry
+	++provided;
+	std::atomic_ref<std::uint16_t>{ring->resv}.store(
+		provided, std::memory_order_release
+	);
+}
+
+io_uring_sqe& IoUring::queue()
+{
+	// Only this thread moves the tail, the kernel moves the head
+	const unsigned tail = *sq_tail + queued;
+	if (tail - shared(sq_head).load(std::memory_order_acquire) >=
+	    params.sq_entries) {
+		throw std::system_error{
+			std::make_error_code(std::errc::device_or_resource_busy)
+		};
+	}
+
+	const unsigned idx = tail & (params.sq_entries - 1);
+	auto& sqe = sqes.at<io_uring_sqe>(0)[idx];
+	sqe = io_uring_sqe{};
+	sq_array[idx] = idx; // NOLINT(*-pointer-arithmetic)
+	++queued;
+	return sqe;
+}
+
+void IoUring::submit_and_wait(unsigned min_complete)
+{
+	// Make the filled in SQEs visible to the kernel
+	shared(sq_tail).store(*sq_tail + queued, std::memory_order_release);
+
+	while (true) {
+		// NOLINTNEXTLINE(*-vararg)
+		const auto res = syscall(
+			__NR_io_uring_enter,
+			*fd,
+			queued,
+			min_complete,
+			IORING_ENTER_GETEVENTS,
+			nullptr,
+			0
+		);
+		if (res < 0) {
+			// Interrupted before anything was submitted
+			if (errno == EINTR)
+				continue;
+			throw_errno();
+		}
+
+		queued -= static_cast<unsigned>(res);
+		const unsigned available =
+			shared(cq_tail).load(std::memory_order_acquire) -
+			*cq_head;
+		if (queued == 0 && available >= min_complete)
+			return;
+	}
+}
+
+const io_uring_cqe* IoUring::peek() const noexcept
+{
+	const unsigned head = *cq_head;
+	if (head == shared(cq_tail).load(std::memory_order_acquire))
+		return nullptr;
+	return &cqes[head & (params.cq_entries - 1)]; // NOLINT(*-pointer-*)
+}
+
+void IoUring::pop() noexcept
+{
+	shared(cq_head).store(*cq_head + 1, std::memory_order_release);
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <linux/io_uring.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "io/FileDescriptor.hpp"
+
+/**
+ * Minimal io_uring instance used by a single submitting thread
+ *
+ * This only wraps the raw io_uring syscalls, so no library is needed. SQEs
+ * are queued with queue() and submitted with submit_and_wait(), which is
+ * also where the thread sleeps until completions arrive. Completions are
+ * consumed in order with peek() and pop().
+ *
+ * The ring owns its buffers, which are either registered or provided to the
+ * kernel, see Buffers. Operations still in flight on destruction are
+ * cancelled by the kernel. The buffers are unmapped after the ring is
+ * closed, so late completions never write into memory reused elsewhere.
+ */
+class IoUring final
+{
+public:
+	/**
+	 * How the buffers are passed to the kernel
+	 */
+	enum class Buffers {
+		/**
+		 * Registered for IORING_OP_READ_FIXED and
+		 * IORING_OP_WRITE_FIXED
+		 */
+		REGISTERED,
+		/**
+		 * Provided as BUFFER_GROUP, from which the kernel picks a
+		 * buffer for each completion of an SQE with
+		 * IOSQE_BUFFER_SELECT. Buffers are handed back with provide().
+		 */
+		PROVIDED,
+	};
+
+	/**
+	 * Buffer group of the provided buffers
+	 */
+	constexpr static std::uint16_t BUFFER_GROUP{0};
+	/**
+	 * IORING_OP_READ_MULTISHOT of Linux 6.7, missing in older headers
+	 */
+	constexpr static std::uint8_t OP_READ_MULTISHOT{49};
+
+	/**
+	 * Set up a ring and pass its buffers to the kernel
+	 *
+	 * Provided buffers have to be handed to the kernel with provide()
+	 * before their first use, and their number must be a power of two.
+	 *
+	 * @param flags IORING_SETUP_* flags
+	 * @throws std::system_error if io_uring is not available, e.g. on old
+	 * kernels, if it has been disabled, or if the flags aren't supported
+	 */
+	IoUring(unsigned entries,
+		std::size_t buffers_num = 0,
+		std::size_t buffer_size = 0,
+		Buffers kind = Buffers::REGISTERED,
+		std::uint32_t flags = 0);
+	IoUring(const IoUring&) = delete;
+	IoUring& operator=(const IoUring&) = delete;
+	IoUring(IoUring&&) = delete;
+	IoUring& operator=(IoUring&&) = delete;
+	~IoUring() noexcept(false) = default;
+
+	/**
+	 * Check whether the kernel supports an IORING_OP_* opcode
+	 */
+	[[nodiscard]] bool supports(std::uint8_t opcode) const;
+
+	/**
+	 * Enable a ring set up with IORING_SETUP_R_DISABLED
+	 *
+	 * With IORING_SETUP_SINGLE_ISSUER, the calling thread becomes the
+	 * only one allowed to submit.
+	 */
+	void enable();
+
+	/**
+	 * Get a registered buffer
+	 *
+	 * @param idx Index of the buffer, as used for sqe.buf_index or
+	 * reported in the flags of a completion
+	 */
+	[[nodiscard]] std::span<std::uint8_t> buffer(std::size_t idx
+	) const noexcept;
+
+	/**
+	 * Hand a provided buffer (back) to the kernel
+	 *
+	 * @param idx Index of the buffer
+	 * @param len Number of bytes the kernel may fill in, at most the
+	 * buffer size
+	 */
+	void provide(std::size_t idx, std::size_t len) noexcept;
+
+	/**
+	 * Get a cleared SQE to fill in
+	 *
+	 * The SQE is submitted with the next submit_and_wait().
+	 */
+	io_uring_sqe& queue();
+
+	/**
+	 * Submit the queued SQEs and wait for completions
+	 *
+	 * @param min_complete Number of completions that have to be available
+	 * before this returns, including the ones not consumed yet
+	 */
+	void submit_and_wait(unsigned min_complete);
+
+	/**
+	 * Get the oldest completion which has not been consumed yet
+	 *
+	 * @return The completion or nullptr if none is available
+	 */
+	[[nodiscard]] const io_uring_cqe* peek() const noexcept;
+
+	/**
+	 * Consume the completion returned by peek()
+	 */
+	void pop() noexcept;
+
+private:
+	/**
+	 * Shared memory of the ring, unmapped on destruction
+	 */
+	class Mapping final
+	{
+	public:
+		/**
+		 * Map anonymous memory, or nothing if size is 0
+		 */
+		explicit Mapping(std::size_t size);
+		Mapping(int fd, std::size_t size, off_t offset);
+		Mapping(const Mapping&) = delete;
+		Mapping& operator=(const Mapping&) = delete;
+		Mapping(Mapping&&) = delete;
+		Mapping& operator=(Mapping&&) = delete;
+		~Mapping();
+
+		/**
+		 * Get a pointer into the mapping
+		 */
+		template <typename T>
+		[[nodiscard]] T* at(std::size_t offset) const noexcept
+		{
+			// NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+			return reinterpret_cast<T*>(
+				static_cast<char*>(addr) + offset
+			);
+			// NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+		}
+
+	private:
+		void* addr{nullptr};
+		std::size_t size{0};
+	};
+
+	io_uring_params params;
+	// Declared before the ring, so they are unmapped after the ring closed
+	Mapping buffers;
+	std::size_t buffer_size;
+	Mapping buffer_ring;
+	std::size_t buffer_ring_size;
+	FileDescriptor<> fd;
+	Mapping sq_ring;
+	Mapping cq_ring;
+	Mapping sqes;
+
+	unsigned* sq_head;
+	unsigned* sq_tail;
+	unsigned* sq_array;
+	unsigned* cq_head;
+	unsigned* cq_tail;
+	io_uring_cqe* cqes;
+	unsigned queued{0};
+	std::uint16_t provided{0};
+};
@@ -1,12 +1,13 @@
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <functional>
-#include <iterator>
 
 #include "JackWrapper.hpp"
 #include "io/MidiEvent.hpp"
 #include "io/Ringbuffer.hpp"
-#include "io/RingbufferIterator.hpp"
+#include "rt/Seqlock.hpp"
 
 #include <jack/jack.h>
 #include <jack/midiport.h>
@@ -22,18 +23,12 @@ using jack_port_ptr = std::unique_ptr<jack_port_t, jack_port_dtor>;
 class JackWrapper::Impl
 {
 public:
-	using write_callback_t = std::function<int(void*, jack_nframes_t)>;
-	using read_callback_t = std::function<int(void*, jack_nframes_t)>;
-
 	explicit Impl(const std::string& client_name)
 	{
 		init_client(client_name);
 		init_ports();
 		init_process_callback();
 		init_xrun_callback();
-
-		read_cb = read_callback();
-		write_cb = write_callback();
 	}
 
 	Impl(const Impl&) = delete;
@@ -141,22 +136,47 @@ public:
 		return static_cast<Impl*>(userarg)->process_int(nframes);
 	}
 
-	[[nodiscard]] int process_int(jack_nframes_t nframes) const
+	[[nodiscard]] int process_int(jack_nframes_t nframes)
 	{
-		if (!write_cb || !read_cb)
-			return 1;
-
 		void* write_buf = jack_port_get_buffer(midi_out.get(), nframes);
 		assert(write_buf);
-		const int write_res = write_cb(write_buf, nframes);
+		const int write_res = write_midi(write_buf, nframes);
 
 		void* read_buf = jack_port_get_buffer(midi_in.get(), nframes);
 		assert(read_buf);
-		const int read_res = read_cb(read_buf, nframes);
+		const int read_res = read_midi(read_buf, nframes);
+
+		update_transport();
 
 		return write_res + read_res;
 	}
 
+	void update_transport() noexcept
+	{
+		jack_position_t pos;
+		const jack_transport_state_t state =
+			jack_transport_query(client.get(), &pos);
+
+		// pos.usecs is on the JACK clock, so convert its age instead of
+		// relying on JACK using the same clock as std::chrono
+		const auto age =
+			std::chrono::microseconds{jack_get_time() - pos.usecs};
+
+		Transport t;
+		t.rolling = state == JackTransportRolling;
+		t.bbt_valid = (pos.valid & JackPositionBBT) != 0;
+		if (t.bbt_valid) {
+			t.bar = pos.bar;
+			t.beat = pos.beat;
+			t.tick = pos.tick;
+			t.beats_per_bar = pos.beats_per_bar;
+			t.ticks_per_beat = pos.ticks_per_beat;
+			t.beats_per_minute = pos.beats_per_minute;
+		}
+		t.time = Transport::clock::now() - age;
+		transport.store(t);
+	}
+
 	static int xrun(void* userarg)
 	{
 		// NOLINTNEXTLINE(*-reinterpret-cast)
@@ -172,52 +192,45 @@ public:
 		};
 	}
 
-	read_callback_t read_callback()
+	int read_midi(void* buf, [[maybe_unused]] jack_nframes_t nframes)
 	{
-		return [this](void* buf, jack_nframes_t) -> int {
-			for (jack_nframes_t i = 0;
-			     i < jack_midi_get_event_count(buf);
-			     ++i) {
-				jack_midi_event_t jack_event;
-				const int res = jack_midi_event_get(
-					&jack_event, buf, i
+		for (jack_nframes_t i = 0; i < jack_midi_get_event_count(buf);
+		     ++i) {
+			jack_midi_event_t jack_event;
+			const int res = jack_midi_event_get(&jack_event, buf, i);
+			if (res != 0)
+				return 1;
+
+			// NOLINTNEXTLINE(*-reinterpret-cast)
+			const auto* data = reinterpret_cast<const char*>(
+				jack_event.buffer
+			);
+			// A non-zero return would make JACK drop the client, so
+			// never fail the cycle for a MIDI thread lagging behind
+			if (in_stream.write(data, jack_event.size) == 0) {
+				dropped_input.fetch_add(
+					1, std::memory_order_relaxed
 				);
-				if (res != 0)
-					return 1;
-
-				// NOLINTBEGIN(*-pointer-arithmetic)
-				for (jack_midi_data_t* i = jack_event.buffer;
-				     i < jack_event.buffer + jack_event.size;
-				     ++i) {
-					if (in_buf.full())
-						return 1;
-
-					in_buf.push(*i);
-				}
-				// NOLINTEND(*-pointer-arithmetic)
 			}
+		}
 
-			return 0;
-		};
+		return 0;
 	}
 
-	write_callback_t write_callback()
+	int write_midi(void* buf, jack_nframes_t nframes)
 	{
-		return [this](void* buf, jack_nframes_t nframes) -> int {
-			jack_midi_clear_buffer(buf);
-			for (jack_nframes_t i = 0;
-			     not out_buf.empty() && i < nframes / 3;
-			     ++i) {
-				MidiEvent event = out_buf.pop();
-				auto bytes = event.to_bytes();
-				const int res = jack_midi_event_write(
-					buf, 0, bytes.data(), bytes.size()
-				);
-				assert(res == 0);
-			}
+		jack_midi_clear_buffer(buf);
+		for (jack_nframes_t i = 0; not out_buf.empty() && i < nframes / 3;
+		     ++i) {
+			MidiEvent event = out_buf.pop();
+			auto bytes = event.to_bytes();
+			const int res = jack_midi_event_write(
+				buf, 0, bytes.data(), bytes.size()
+			);
+			assert(res == 0);
+		}
 
-			return 0;
-		};
+		return 0;
 	}
 
 	jack_client_ptr client{nullptr, jack_client_deleter()};
@@ -225,17 +238,19 @@ public:
 	jack_port_ptr midi_in{nullptr};
 	jack_port_ptr midi_out{nullptr};
 
-	write_callback_t write_cb;
-	read_callback_t read_cb;
 	JackWrapper::xrun_callback xrun_cb{[]() -> int {
 		return 0;
 	}};
-	Ringbuffer<jack_midi_data_t> in_buf{IN_BUF_SIZE};
+	MidiStream in_stream{IN_BUF_SIZE};
+	std::atomic<std::size_t> dropped_input{0};
 	Ringbuffer<MidiEvent> out_buf{OUT_BUF_SIZE};
+	rt::Seqlock<Transport> transport{};
 };
 
-JackWrapper::JackWrapper(const std::string& client_name) :
-	p_impl(std::make_unique<Impl>(client_name))
+JackWrapper::JackWrapper(
+	const std::string& client_name, std::pmr::memory_resource* mem
+) :
+	p_impl(rt::make_pmr_unique<Impl>(mem, client_name))
 {
 }
 
@@ -266,9 +281,26 @@ void JackWrapper::deactivate()
 		throw JackWrapperException{"Failed to deactivate JACK client"};
 }
 
+int JackWrapper::real_time_priority() const noexcept
+{
+	return jack_client_real_time_priority(p_impl->client.get());
+}
+
+bool JackWrapper::lock_buffers() noexcept
+{
+	const bool in_locked = p_impl->in_stream.mlock();
+	const bool out_locked = p_impl->out_buf.mlock();
+	return in_locked && out_locked;
+}
+
+Transport JackWrapper::transport() const noexcept
+{
+	return p_impl->transport.load();
+}
+
 std::size_t JackWrapper::read_bufsize() const noexcept
 {
-	return p_impl->in_buf.size();
+	return p_impl->in_stream.size();
 }
 
 std::size_t JackWrapper::write_bufsize() const noexcept
@@ -276,6 +308,11 @@ std::size_t JackWrapper::write_bufsize() const noexcept
 	return p_impl->out_buf.size();
 }
 
+bool JackWrapper::midi_output_full() const noexcept
+{
+	return p_impl->out_buf.full();
+}
+
 JackWrapper& JackWrapper::operator<<(const MidiEvent& event)
 {
 	assert(not p_impl->out_buf.full());
@@ -283,17 +320,12 @@ JackWrapper& JackWrapper::operator<<(const MidiEvent& event)
 	return *this;
 }
 
-JackWrapper& JackWrapper::operator>>(MidiEvent& event)
+MidiStream& JackWrapper::midi_input() noexcept
 {
-	RingbufferReadIterator it{p_impl->in_buf.data()};
-	RingbufferReadIterator end{
-		p_impl->in_buf.data(), RingbufferReadIterator::end_iter
-	};
-
-	auto [parsed_event, next_it] = MidiEvent::parse(it, end);
-	jack_ringbuffer_read_advance(
-		p_impl->in_buf.data(), std::distance(it, next_it)
-	);
-	event = parsed_event;
-	return *this;
+	return p_impl->in_stream;
+}
+
+std::size_t JackWrapper::dropped_midi_input() const noexcept
+{
+	return p_impl->dropped_input.load(std::memory_order_relaxed);
 }
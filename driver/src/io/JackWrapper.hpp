@@ -2,12 +2,15 @@
 
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <stdexcept>
 #include <string>
 
 #include <jack/types.h>
 
-class MidiEvent;
+#include "io/MidiStream.hpp"
+#include "io/Transport.hpp"
+#include "rt/Arena.hpp"
 
 class JackWrapper final
 {
@@ -20,8 +23,15 @@ public:
 
 	using xrun_callback = std::function<int()>;
 
+	/**
+	 * Open a JACK client with the given name
+	 *
+	 * The internal state is allocated from mem. The MIDI ringbuffers are
+	 * allocated by libjack with a fixed size during construction.
+	 */
 	explicit JackWrapper(
-		const std::string& client_name = DEFAULT_CLIENT_NAME
+		const std::string& client_name = DEFAULT_CLIENT_NAME,
+		std::pmr::memory_resource* mem = std::pmr::get_default_resource()
 	);
 	JackWrapper(const JackWrapper&) = delete;
 	JackWrapper& operator=(const JackWrapper&) = delete;
@@ -34,20 +44,66 @@ public:
 	void activate();
 	void deactivate();
 
+	/**
+	 * Get the scheduling priority of the JACK process thread
+	 *
+	 * @return The SCHED_FIFO priority or a negative value if JACK does not
+	 * run in real-time mode.
+	 */
+	[[nodiscard]] int real_time_priority() const noexcept;
+
+	/**
+	 * Lock the MIDI ringbuffers into RAM
+	 *
+	 * @return true if all buffers have been locked
+	 */
+	bool lock_buffers() noexcept;
+
+	/**
+	 * Get the transport position of the last process cycle
+	 *
+	 * The position is queried in every process cycle, so this is cheap
+	 * and can be called from any thread.
+	 */
+	[[nodiscard]] Transport transport() const noexcept;
+
 	[[nodiscard]] std::size_t read_bufsize() const noexcept;
 	[[nodiscard]] std::size_t write_bufsize() const noexcept;
 
+	/**
+	 * Check whether the output buffer has room for another MIDI event
+	 *
+	 * The buffer is emptied by the JACK process thread, so a full buffer
+	 * only ever becomes free again, never the other way round.
+	 */
+	[[nodiscard]] bool midi_output_full() const noexcept;
+
 	/**
 	 * Send a MIDI event to the output buffer
+	 *
+	 * The buffer must not be full, see midi_output_full().
 	 */
 	JackWrapper& operator<<(const MidiEvent& event);
+
+	/**
+	 * Get the stream of received MIDI events
+	 *
+	 * The JACK process thread writes each received message into it. Its
+	 * write notification callback must be set before activating the
+	 * client, and is called from the JACK process thread.
+	 */
+	[[nodiscard]] MidiStream& midi_input() noexcept;
+
 	/**
-	 * Read a MIDI event from the input buffer
+	 * Get the number of received MIDI messages dropped so far
+	 *
+	 * Messages are dropped if the stream returned by midi_input() is too
+	 * full to take them.
 	 */
-	JackWrapper& operator>>(MidiEvent& event);
+	[[nodiscard]] std::size_t dropped_midi_input() const noexcept;
 
 private:
-	std::unique_ptr<Impl> p_impl;
+	rt::pmr_unique_ptr<Impl> p_impl;
 };
 
 class JackWrapperException : public std::runtime_error
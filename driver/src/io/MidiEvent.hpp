@@ -71,8 +71,7 @@ public:
 	{
 		MidiEvent event;
 
-		for (; raw_it != end && !is_status_byte(*raw_it); ++raw_it)
-			;
+		raw_it = skip_data_bytes(raw_it, end);
 
 		if (raw_it == end)
 			return {event, end};
@@ -86,10 +85,7 @@ public:
 
 		++raw_it;
 		if (event.type == MidiEvent::Type::SYSTEM_MESSAGE) {
-			for (; raw_it != end &&
-			       !is_status_byte(static_cast<byte>(*raw_it));
-			     ++raw_it)
-				;
+			raw_it = skip_data_bytes(raw_it, end);
 		} else {
 			// NOLINTBEGIN(*-pointer-arithmetic,*-union-access)
 			for (auto* data_it = event.data.raw.begin();
@@ -102,12 +98,35 @@ public:
 			// NOLINTEND(*-pointer-arithmetic,*-union-access)
 		}
 
-		for (; raw_it != end && !is_status_byte(*raw_it); ++raw_it)
-			;
+		raw_it = skip_data_bytes(raw_it, end);
 
 		return {event, raw_it};
 	}
 
+	/**
+	 * Advance to the next status byte, or to @p end if there is none
+	 *
+	 * Iterators which provide a find_status_byte() member, like
+	 * RingbufferReadIterator, are advanced with it, so long runs of data
+	 * bytes are skipped without reading them one by one.
+	 */
+	template <typename iter>
+	static iter skip_data_bytes(iter raw_it, iter end)
+	{
+		// Messages usually follow each other without gaps
+		if (raw_it == end || is_status_byte(*raw_it))
+			return raw_it;
+
+		if constexpr (requires { raw_it.find_status_byte(end); }) {
+			return raw_it.find_status_byte(end);
+		} else {
+			for (; raw_it != end && !is_status_byte(*raw_it);
+			     ++raw_it)
+				;
+			return raw_it;
+		}
+	}
+
 	[[nodiscard]] constexpr std::array<byte, 3> to_bytes() const
 	{
 		assert(type != Type::SYSTEM_MESSAGE);
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "io/MidiEvent.hpp"
+
+/**
+ * Incremental parser for a raw MIDI byte stream
+ *
+ * Bytes are fed one at a time with push(), so a message may be split across
+ * any number of reads (e.g. at the wrap-around of a ringbuffer). The parser
+ * follows the MIDI 1.0 byte stream rules:
+ *
+ * - Running status: data bytes without a preceding status byte reuse the
+ *   status of the last channel message.
+ * - Realtime bytes (0xf8 to 0xff) may appear anywhere, even within other
+ *   messages, and don't affect the parser state.
+ * - SysEx messages are collected into a fixed-size buffer. Messages which
+ *   don't fit are dropped. Any status byte other than a realtime byte ends a
+ *   SysEx message, but only 0xf7 completes it.
+ * - System common messages cancel running status.
+ *
+ * The number of data bytes per status byte is looked up in a table, so each
+ * byte takes a constant number of steps. The parser never allocates.
+ */
+class MidiParser final
+{
+public:
+	using byte = MidiEvent::byte;
+
+	/**
+	 * Maximum size of a SysEx message, including the 0xf0 and 0xf7 bytes
+	 */
+	constexpr static std::size_t MAX_SYSEX_SIZE{256};
+
+	constexpr static byte SYSEX_START{0xf0};
+	constexpr static byte SYSEX_END{0xf7};
+	constexpr static byte REALTIME_MIN{0xf8};
+
+	/**
+	 * Kind of message completed by a byte
+	 */
+	enum class Result : std::uint8_t {
+		/** The byte did not complete a message */
+		NONE,
+		/** A channel or system common message, see event() */
+		EVENT,
+		/** A realtime message, see realtime() */
+		REALTIME,
+		/** A SysEx message, see sysex() */
+		SYSEX,
+	};
+
+	/**
+	 * Parse the next byte of the stream
+	 */
+	constexpr Result push(byte b) noexcept
+	{
+		if (b >= REALTIME_MIN) {
+			realtime_byte = b;
+			return Result::REALTIME;
+		}
+
+		if (MidiEvent::is_status_byte(b)) {
+			return push_status(b);
+		}
+
+		if (in_sysex) {
+			if (sysex_size < sysex_buf.size()) {
+				sysex_buf.at(sysex_size) = b;
+			}
+			// Overflowing messages are dropped when they end
+			++sysex_size;
+			return Result::NONE;
+		}
+
+		if (status == 0) {
+			// Data without any status, e.g. after a SysEx message
+			return Result::NONE;
+		}
+
+		data.at(data_num++) = b;
+		if (data_num < data_length(status)) {
+			return Result::NONE;
+		}
+		return complete_event();
+	}
+
+	/**
+	 * Check whether the next data bytes complete no message
+	 *
+	 * This is the case within a SysEx message and without any status. The
+	 * data bytes up to the next status byte can then be passed to
+	 * push_data() at once.
+	 */
+	[[nodiscard]] constexpr bool takes_data_run() const noexcept
+	{
+		return in_sysex || status == 0;
+	}
+
+	/**
+	 * Parse a run of data bytes while takes_data_run() holds
+	 *
+	 * This is the same as passing each byte to push(), but collects SysEx
+	 * data in one go.
+	 */
+	constexpr void push_data(std::span<const byte> bytes) noexcept
+	{
+		assert(takes_data_run());
+		if (not in_sysex) {
+			return;
+		}
+
+		if (sysex_size < sysex_buf.size()) {
+			const std::size_t n = std::min(
+				bytes.size(), sysex_buf.size() - sysex_size
+			);
+			std::copy_n(
+				bytes.begin(),
+				n,
+				sysex_buf.begin() +
+					static_cast<std::ptrdiff_t>(sysex_size)
+			);
+		}
+		// Overflowing messages are dropped when they end
+		sysex_size += bytes.size();
+	}
+
+	/**
+	 * Parse a sequence of bytes
+	 *
+	 * The handler is called as hdl(Result, const MidiParser&) for each
+	 * completed message.
+	 */
+	template <typename Handler>
+	void parse(std::span<const byte> bytes, Handler&& hdl)
+	{
+		for (const byte b : bytes) {
+			if (const Result res = push(b); res != Result::NONE) {
+				hdl(res, *this);
+			}
+		}
+	}
+
+	/**
+	 * Drop any partial message and the running status
+	 */
+	constexpr void reset() noexcept
+	{
+		status = 0;
+		data_num = 0;
+		in_sysex = false;
+		sysex_size = 0;
+	}
+
+	/**
+	 * Get the last completed channel or system common message
+	 */
+	[[nodiscard]] constexpr const MidiEvent& event() const noexcept
+	{
+		return last_event;
+	}
+
+	/**
+	 * Get the last realtime byte
+	 */
+	[[nodiscard]] constexpr byte realtime() const noexcept
+	{
+		return realtime_byte;
+	}
+
+	/**
+	 * Get the last completed SysEx message, including 0xf0 and 0xf7
+	 *
+	 * The message stays valid until the next SysEx message starts.
+	 */
+	[[nodiscard]] constexpr std::span<const byte> sysex() const noexcept
+	{
+		return {sysex_buf.data(), sysex_size};
+	}
+
+	/**
+	 * Get the number of data bytes following a status byte
+	 */
+	constexpr static std::size_t data_length(byte status) noexcept
+	{
+		return DATA_LENGTHS.at(status & ~MidiEvent::STATUS_BYTE_MASK);
+	}
+
+private:
+	// NOLINTBEGIN(*-magic-numbers)
+	constexpr static std::array<std::uint8_t, 128> DATA_LENGTHS{[]() {
+		std::array<std::uint8_t, 128> lengths{};
+		for (std::size_t i = 0; i < lengths.size(); ++i) {
+			switch ((i + 0x80) & MidiEvent::TYPE_MASK) {
+			case 0xc0: // program change
+			case 0xd0: // monophonic aftertouch
+				lengths.at(i) = 1;
+				break;
+			case 0xf0:
+				break;
+			default:
+				lengths.at(i) = 2;
+			}
+		}
+		lengths.at(0x71) = 1; // MTC quarter frame
+		lengths.at(0x72) = 2; // song position
+		lengths.at(0x73) = 1; // song select
+		return lengths;
+	}()};
+	// NOLINTEND(*-magic-numbers)
+
+	constexpr Result push_status(byte b) noexcept
+	{
+		if (in_sysex) {
+			in_sysex = false;
+			if (b == SYSEX_END && sysex_size < sysex_buf.size()) {
+				sysex_buf.at(sysex_size++) = b;
+				return Result::SYSEX;
+			}
+			sysex_size = 0;
+		}
+
+		data_num = 0;
+		if (b == SYSEX_START) {
+			status = 0;
+			in_sysex = true;
+			sysex_buf.at(0) = b;
+			sysex_size = 1;
+			return Result::NONE;
+		}
+		if (b == SYSEX_END) {
+			// Stray end of a SysEx message we didn't see start
+			status = 0;
+			return Result::NONE;
+		}
+
+		status = b;
+		if (data_length(status) == 0) {
+			return complete_event();
+		}
+		return Result::NONE;
+	}
+
+	constexpr Result complete_event() noexcept
+	{
+		const auto type = static_cast<MidiEvent::Type>(
+			status & MidiEvent::TYPE_MASK
+		);
+		last_event = MidiEvent{
+			type,
+			static_cast<byte>(status & MidiEvent::CHANNEL_MASK),
+			data_num > 0 ? data[0] : byte{0},
+			data_num > 1 ? data[1] : byte{0},
+		};
+		data_num = 0;
+		// Only channel messages have a running status
+		if (type == MidiEvent::Type::SYSTEM_MESSAGE) {
+			status = 0;
+		}
+		return Result::EVENT;
+	}
+
+	byte status{0};
+	std::array<byte, 2> data{};
+	std::size_t data_num{0};
+	MidiEvent last_event{};
+	byte realtime_byte{0};
+
+	bool in_sysex{false};
+	std::size_t sysex_size{0};
+	std::array<byte, MAX_SYSEX_SIZE> sysex_buf{};
+};
@@ -56,6 +56,9 @@ void MidiStream::set_write_notification_callback(write_notification_cb cb)
 
 std::size_t MidiStream::write(const char* data, size_t count)
 {
+	if (jack_ringbuffer_write_space(buf.get()) < count)
+		return 0;
+
 	const std::size_t written =
 		jack_ringbuffer_write(buf.get(), data, count);
 	if (written > 0 && write_notification_callback)
@@ -64,6 +67,16 @@ std::size_t MidiStream::write(const char* data, size_t count)
 	return written;
 }
 
+std::size_t MidiStream::size() const noexcept
+{
+	return jack_ringbuffer_read_space(buf.get());
+}
+
+bool MidiStream::mlock() noexcept
+{
+	return jack_ringbuffer_mlock(buf.get()) == 0;
+}
+
 MidiStream::iterator MidiStream::begin()
 {
 	return iterator{*this};
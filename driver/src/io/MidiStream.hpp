@@ -2,14 +2,25 @@
 
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <utility>
 
 #include <jack/ringbuffer.h>
 #include <jack/types.h>
 
 #include "MidiEvent.hpp"
+#include "MidiParser.hpp"
 #include "RingbufferIterator.hpp"
 
+/**
+ * Stream of MIDI events through a lock-free ringbuffer
+ *
+ * One thread writes raw MIDI messages, another thread iterates over the
+ * parsed events. The reader is woken up by the write notification callback,
+ * and should consume all available events in one pass with consume(), which
+ * advances the ringbuffer's read pointer only once per batch.
+ */
 class MidiStream final
 {
 public:
@@ -74,14 +85,126 @@ public:
 	MidiStream& operator=(MidiStream&&) = delete;
 	~MidiStream() = default;
 
+	/**
+	 * Set the callback which is called after each write
+	 *
+	 * The callback runs in the writing thread, so it must not block. It
+	 * must be set before the writer is started.
+	 */
 	void set_write_notification_callback(write_notification_cb cb);
 
+	/**
+	 * Write a complete MIDI message
+	 *
+	 * Messages are written completely or not at all, so the stream never
+	 * contains a truncated message.
+	 *
+	 * @return The number of bytes written, which is either count or 0 if
+	 * the ringbuffer is too full
+	 */
 	size_t write(const char* data, size_t count);
 
+	/**
+	 * Pass the available events to hdl and remove them from the stream
+	 *
+	 * The events are parsed in a single pass, and the ringbuffer's read
+	 * pointer is advanced once for the whole batch.
+	 *
+	 * @param hdl Callable taking a const MidiEvent&
+	 * @param max_events Maximum number of events to consume
+	 *
+	 * @return The number of consumed events
+	 */
+	template <typename Handler>
+	std::size_t consume(
+		Handler&& hdl,
+		std::size_t max_events = std::numeric_limits<std::size_t>::max()
+	)
+	{
+		std::size_t consumed{0};
+		iterator it = begin();
+		for (const iterator last = end();
+		     it != last && consumed < max_events;
+		     ++it, ++consumed) {
+			hdl(*it);
+		}
+
+		if (consumed > 0)
+			it.advance_read_ptr();
+		return consumed;
+	}
+
+	/**
+	 * Pass the available messages to hdl and remove them from the stream
+	 *
+	 * Unlike consume(), this passes all kinds of messages as parsed by a
+	 * MidiParser, including SysEx and realtime messages. The parser keeps
+	 * its state between calls and is only used by the reading thread.
+	 * Runs of data bytes which complete no message, like the payload of
+	 * SysEx messages, are found with
+	 * RingbufferReadIterator::find_status_byte() and passed on at once.
+	 *
+	 * @param hdl Callable taking a MidiParser::Result and the const
+	 * MidiParser& holding the message
+	 * @param max_messages Maximum number of messages to consume
+	 *
+	 * @return The number of consumed messages
+	 */
+	template <typename Handler>
+	std::size_t consume_messages(
+		Handler&& hdl,
+		std::size_t max_messages =
+			std::numeric_limits<std::size_t>::max()
+	)
+	{
+		const RingbufferReadIterator it{buf.get()};
+		std::size_t consumed{0};
+		std::size_t read{0};
+		for (const auto segment : it.segments()) {
+			std::size_t i{0};
+			while (i < segment.size() && consumed < max_messages) {
+				if (parser.takes_data_run()) {
+					using Iter = RingbufferReadIterator;
+					const auto run = segment.subspan(i);
+					const std::size_t len =
+						Iter::find_status_byte(run);
+					parser.push_data(run.first(len));
+					i += len;
+					if (i == segment.size())
+						break;
+				}
+
+				const auto res = parser.push(segment[i++]);
+				if (res != MidiParser::Result::NONE) {
+					hdl(res, std::as_const(parser));
+					++consumed;
+				}
+			}
+			read += i;
+		}
+
+		if (read > 0)
+			jack_ringbuffer_read_advance(buf.get(), read);
+		return consumed;
+	}
+
+	/**
+	 * Get the number of unread bytes
+	 */
+	[[nodiscard]] std::size_t size() const noexcept;
+
+	/**
+	 * Lock the ringbuffer into RAM
+	 *
+	 * @return true if the ringbuffer has been locked
+	 */
+	bool mlock() noexcept;
+
 	iterator begin();
 	iterator end();
 
 private:
 	ringbuffer_ptr buf{nullptr, jack_ringbuffer_free};
 	write_notification_cb write_notification_callback{};
+	MidiParser parser{};
 };
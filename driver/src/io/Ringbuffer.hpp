@@ -117,7 +117,7 @@ public:
 		assert(bytes_read == sizeof(T));
 
 		assert_invariants();
-		return std::move(d);
+		return d;
 	}
 
 	jack_ringbuffer_t* data()
@@ -125,6 +125,17 @@ public:
 		return buf.get();
 	}
 
+	/**
+	 * Lock the buffer memory into RAM
+	 *
+	 * @return true on success, false if the memory could not be locked
+	 */
+	bool mlock() noexcept
+	{
+		assert_invariants();
+		return jack_ringbuffer_mlock(buf.get()) == 0;
+	}
+
 private:
 	void init_buf()
 	{
@@ -1,24 +1,104 @@
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <climits>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "RingbufferIterator.hpp"
 
-RingbufferReadIterator::value_type RingbufferReadIterator::operator*()
+namespace
+{
+#if !defined(__SSE2__)
+constexpr std::uint64_t HIGH_BITS{0x8080808080808080U};
+#endif
+} // namespace
+
+RingbufferReadIterator::segments_type
+RingbufferReadIterator::segments() const noexcept
 {
-	assert(ringbuf);
-	assert(read_data[0].buf);
-	if (!is_readable())
-		throw std::out_of_range{
-			"Dereferencing unreadable RingbufferReadIterator"
-		};
-
-	// NOLINTBEGIN(*-pointer-arithmetic)
-	if (read_data[0].len > read_offset) {
-		return read_data[0].buf[read_offset];
+	// NOLINTBEGIN(*-reinterpret-cast)
+	const std::span first{
+		reinterpret_cast<const byte*>(read_data[0].buf),
+		read_data[0].len
+	};
+	const std::span second{
+		reinterpret_cast<const byte*>(read_data[1].buf),
+		read_data[1].len
+	};
+	// NOLINTEND(*-reinterpret-cast)
+
+	if (read_offset < first.size())
+		return {first.subspan(read_offset), second};
+
+	const std::size_t offset =
+		std::min(read_offset - first.size(), second.size());
+	return {second.subspan(offset), {}};
+}
+
+RingbufferReadIterator RingbufferReadIterator::find_status_byte(
+	const RingbufferReadIterator& last
+) const noexcept
+{
+	assert(ringbuf == last.ringbuf);
+	const std::size_t limit = std::max(read_offset, last.read_offset);
+
+	RingbufferReadIterator found{*this};
+	for (const auto segment : segments()) {
+		const std::size_t remaining = limit - found.read_offset;
+		const auto data =
+			segment.first(std::min(segment.size(), remaining));
+		const std::size_t pos = find_status_byte(data);
+		found.read_offset += pos;
+		if (pos < data.size() || found.read_offset == limit)
+			break;
 	}
+	return found.read_offset < limit ? found : last;
+}
+
+std::size_t RingbufferReadIterator::find_status_byte(
+	std::span<const byte> data
+) noexcept
+{
+	std::size_t pos = 0;
+
+#if defined(__SSE2__)
+	constexpr std::size_t BLOCK_SIZE{sizeof(__m128i)};
+	for (; pos + BLOCK_SIZE <= data.size(); pos += BLOCK_SIZE) {
+		// NOLINTNEXTLINE(*-reinterpret-cast, *-pointer-arithmetic)
+		const __m128i block = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(data.data() + pos)
+		);
+		const auto mask =
+			static_cast<unsigned>(_mm_movemask_epi8(block));
+		if (mask != 0)
+			return pos + std::countr_zero(mask);
+	}
+#else
+	constexpr std::size_t BLOCK_SIZE{sizeof(std::uint64_t)};
+	for (; pos + BLOCK_SIZE <= data.size(); pos += BLOCK_SIZE) {
+		std::uint64_t block{};
+		// NOLINTNEXTLINE(*-pointer-arithmetic)
+		std::memcpy(&block, data.data() + pos, BLOCK_SIZE);
+		block &= HIGH_BITS;
+		if (block == 0)
+			continue;
+
+		if constexpr (std::endian::native == std::endian::little)
+			return pos + (std::countr_zero(block) / CHAR_BIT);
+		else
+			return pos + (std::countl_zero(block) / CHAR_BIT);
+	}
+#endif
 
-	assert(read_data[1].len > 0);
-	return read_data[1].buf[read_offset];
-	// NOLINTEND(*-pointer-arithmetic)
+	for (; pos < data.size(); ++pos) {
+		if ((data[pos] & STATUS_BIT) != 0)
+			return pos;
+	}
+	return pos;
 }
 
 void RingbufferReadIterator::advance_read_ptr() const
@@ -4,6 +4,7 @@
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <span>
 #include <stdexcept>
 
 #include <jack/ringbuffer.h>
@@ -21,6 +22,10 @@
  *
  * Advancing the ringbuffer or calling @c RingbufferReadIterator::advance()
  * invalidates all iterators.
+ *
+ * Code which processes many bytes at once should use
+ * @c RingbufferReadIterator::segments() to access the readable data as
+ * contiguous memory instead of dereferencing the iterator byte by byte.
  */
 class RingbufferReadIterator final
 {
@@ -38,6 +43,14 @@ public:
 	using reference = value_type&;
 	using iterator_category = std::random_access_iterator_tag;
 
+	/**
+	 * Up to two contiguous regions of readable data
+	 *
+	 * The second region is only non-empty if the readable data wraps
+	 * around the end of the ringbuffer.
+	 */
+	using segments_type = std::array<std::span<const byte>, 2>;
+
 	/**
 	 * Create an end iterator
 	 */
@@ -94,10 +107,52 @@ public:
 	 *
 	 * @throw std::out_of_range if the element to read
 	 * is outside the read vector.
+	 */
+	value_type operator*() const
+	{
+		if (!is_readable())
+			throw std::out_of_range{"Dereferencing unreadable "
+						"RingbufferReadIterator"};
+
+		// NOLINTBEGIN(*-pointer-arithmetic)
+		if (read_offset < read_data[0].len)
+			return static_cast<byte>(read_data[0].buf[read_offset]);
+
+		return static_cast<byte>(
+			read_data[1].buf[read_offset - read_data[0].len]
+		);
+		// NOLINTEND(*-pointer-arithmetic)
+	}
+
+	/**
+	 * Get the readable data from the current position on
 	 *
-	 * @throw std::invalid_argument if the iterator is an end iterator.
+	 * The regions stay valid until the ringbuffer's read pointer is
+	 * advanced.
 	 */
-	value_type operator*();
+	[[nodiscard]] segments_type segments() const noexcept;
+
+	/**
+	 * Find the next MIDI status byte, i.e. a byte with the high bit set
+	 *
+	 * The search starts at the current position and scans the readable
+	 * data segment-wise with vector instructions.
+	 *
+	 * @param last Iterator past the end of the range to search
+	 *
+	 * @return An iterator to the status byte, or @p last if there is none
+	 */
+	[[nodiscard]] RingbufferReadIterator
+	find_status_byte(const RingbufferReadIterator& last) const noexcept;
+
+	/**
+	 * Find the first byte with the high bit set in a region of memory
+	 *
+	 * @return The index of the byte, or the size of @p data if there is
+	 * none
+	 */
+	static std::size_t find_status_byte(std::span<const byte> data
+	) noexcept;
 
 	/**
 	 * Check if this iterator points to a readable region in the ringbuffer
@@ -181,6 +236,8 @@ private:
 
 	void update_read_data();
 
+	constexpr static byte STATUS_BIT{0x80};
+
 	jack_ringbuffer_t* ringbuf;
 	std::array<jack_ringbuffer_data_t, 2> read_data{
 		jack_ringbuffer_data_t{nullptr, 0},
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Snapshot of the JACK transport position
+ *
+ * This is a plain copy of the parts of jack_position_t needed to follow the
+ * musical time, with the position timestamped on the steady clock instead of
+ * the JACK clock.
+ */
+struct Transport {
+	using clock = std::chrono::steady_clock;
+
+	// NOLINTBEGIN(*-magic-numbers)
+	bool rolling{false};
+	/**
+	 * Whether the bar, beat and tempo fields are valid
+	 *
+	 * These are only provided if some JACK client acts as timebase
+	 * master.
+	 */
+	bool bbt_valid{false};
+	/** Current bar, starting at 1 */
+	std::int32_t bar{1};
+	/** Current beat within the bar, starting at 1 */
+	std::int32_t beat{1};
+	/** Current tick within the beat, starting at 0 */
+	std::int32_t tick{0};
+	float beats_per_bar{4.F};
+	double ticks_per_beat{1920.};
+	double beats_per_minute{120.};
+	/** Point in time the position refers to */
+	clock::time_point time{};
+	// NOLINTEND(*-magic-numbers)
+};
@@ -1,20 +1,39 @@
 #include <cerrno>
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <sstream>
+#include <string>
 
 #include <jack/types.h>
 #include <system_error>
 #include <thread>
 #include <utility>
 
+#include <csignal>
+#include <getopt.h>
+#include <pthread.h>
+
 #include "config.h"
 #include "io/HidDevice.hpp"
 #include "io/JackWrapper.hpp"
 #include "io/MidiEvent.hpp"
+#include "io/MidiParser.hpp"
+#include "io/MidiStream.hpp"
+#include "io/Ringbuffer.hpp"
+#include "rt/Arena.hpp"
+#include "rt/HeapGuard.hpp"
+#include "rt/Mailbox.hpp"
+#include "rt/Notifier.hpp"
+#include "rt/Realtime.hpp"
+#include "rt/SharedFrame.hpp"
 #include "tkf1/F1Device.hpp"
 #include "tkf1/IOMapper.hpp"
+#include "tkf1/LedScheduler.hpp"
+#include "tkf1/Mapping.hpp"
+#include "tkf1/StateExport.hpp"
 
 #ifdef TKF1_HAVE_LANDLOCK
 # include <ll/ActionType.hpp>
@@ -30,14 +49,47 @@ namespace
 constexpr std::size_t MAX_HIDRAW_DEVICE_IDX{100};
 constexpr const char* HIDRAW_PREFIX{"/dev/hidraw"};
 constexpr std::size_t BATCH_SIZE{1024};
+// Input events waiting for the MIDI thread, dozens of reports worth
+constexpr std::size_t HID_EVENTS_SIZE{1024};
 constexpr std::chrono::milliseconds MIDI_NO_EVENTS_WAIT{50ms};
+// Until the next JACK cycle makes room for the HID events still waiting
+constexpr std::chrono::milliseconds MIDI_OUTPUT_FULL_WAIT{1ms};
+// The HID input thread must never miss a report and is more latency-critical
+// than the MIDI thread, which maps its events and in turn is more important
+// than the LED output. The HID output thread only writes the reports the LED
+// thread has picked, so it runs just above it: a pending report is sent as
+// soon as the device takes it, even while the LED thread computes the next
+// one.
+constexpr int HID_THREAD_PRIORITY_OFFSET{1};
+constexpr int MIDI_THREAD_PRIORITY_OFFSET{2};
+constexpr int HID_OUTPUT_THREAD_PRIORITY_OFFSET{3};
+constexpr int LED_THREAD_PRIORITY_OFFSET{4};
+// Holds all driver-lifetime objects, see rt::Arena
+constexpr std::size_t ARENA_SIZE{64U * 1024U};
+
+struct Options {
+	bool realtime{false};
+	bool io_uring{false};
+	std::optional<std::size_t> cpu{};
+	std::optional<std::filesystem::path> mapping{};
+};
 
-std::unique_ptr<F1Device> discover_device();
+std::optional<Options> parse_args(int argc, char** argv);
+Mapping default_mapping();
+std::optional<Mapping> load_mapping(const Options& opts);
+void block_sighup();
+void reload_mapping_on_sighup(const Options& opts, IOMapper& io_mapper);
+rt::pmr_unique_ptr<F1Device>
+discover_device(std::pmr::memory_resource* mem, bool io_uring);
+void setup_realtime_memory(JackWrapper& jack);
+void enter_realtime(const Options& opts, int priority, const char* name);
 
 namespace errcode
 {
 const int SUCCESS{0};
+const int INVALID_ARGUMENTS{1};
 const int NO_DEVICE_FOUND{2};
+const int INVALID_MAPPING{3};
 } // namespace errcode
 
 namespace colors
@@ -57,7 +109,7 @@ constexpr Color YELLOW = F1Device::rgb2color(
 } // namespace colors
 
 #ifdef TKF1_HAVE_LANDLOCK
-void setup_landlock()
+void setup_landlock(const Options& opts)
 {
 	landlock::Ruleset ll_ruleset(
 		{landlock::action::FS_EXECUTE,
@@ -123,6 +175,19 @@ void setup_landlock()
 	}
 	ll_ruleset.add_rule(std::move(ll_rule_libjack));
 
+	if (opts.mapping) {
+		// The whole directory, as editors replace the file on save
+		const auto dir =
+			std::filesystem::absolute(*opts.mapping).parent_path();
+		// clang-format off
+		ll_ruleset.add_rule(std::move(
+			landlock::PathBeneathRule{}
+				.add_path(dir)
+				.add_action(landlock::action::FS_READ_FILE)
+		));
+		// clang-format on
+	}
+
 # if __has_feature(address_sanitizer) || defined(__SANITIZE_ADDRESS__)
 	// clang-format off
 	ll_ruleset.add_rule(std::move(
@@ -141,25 +206,39 @@ void setup_landlock()
 #endif
 } // namespace
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+int main(int argc, char** argv)
 {
+	const auto opts = parse_args(argc, argv);
+	if (not opts) {
+		return errcode::INVALID_ARGUMENTS;
+	}
+
+	const auto mapping = load_mapping(*opts);
+	if (not mapping) {
+		return errcode::INVALID_MAPPING;
+	}
+	if (opts->mapping) {
+		// Before any thread (including JACK's) is spawned, so that
+		// SIGHUP is only ever received by the reload thread
+		block_sighup();
+	}
+
+	// Created before Landlock is enforced, which would forbid it
+	std::optional<StateExport> state_export;
+	try {
+		state_export.emplace();
+	} catch (StateExportError& e) {
+		std::clog << e.what() << ", not exporting the device state\n";
+	}
+
 #ifdef TKF1_HAVE_LANDLOCK
-	setup_landlock();
+	setup_landlock(*opts);
 #endif
 
-	std::shared_ptr<F1Device> dev = discover_device();
-	std::shared_ptr<JackWrapper> jack;
-	IOMapper io_mapper;
-
-	io_mapper.matrix_colors = {
-		// clang-format off
-		colors::RED, colors::GREEN, colors::GREEN, colors::RED,
-		colors::GREEN, colors::YELLOW, colors::YELLOW, colors::GREEN,
-		colors::GREEN, colors::BLUE, colors::YELLOW, colors::GREEN,
-		colors::RED, colors::GREEN, colors::GREEN, colors::RED,
-		// clang-format on
-	};
-	io_mapper.button_toggle.matrix.set();
+	rt::Arena arena{ARENA_SIZE};
+	const auto dev = discover_device(&arena, opts->io_uring);
+	rt::pmr_unique_ptr<JackWrapper> jack;
+	IOMapper io_mapper{*mapping};
 
 	if (not dev) {
 		std::clog << "Failed to find a suitable device!\n";
@@ -167,42 +246,210 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 	}
 
 	std::cout << "Connected to Traktor Kontrol F1\n";
+	io_mapper.init_output(dev->output_state());
+	dev->write();
+	// Only modified by the MIDI thread, read by the LED thread
+	rt::SharedFrame<F1Device::OutputState> output{dev->output_state()};
+	// Passes the input events of the HID thread to the MIDI thread, which
+	// maps them, so the HID thread never waits for the output state
+	Ringbuffer<F1Device::InputEvent> hid_events{HID_EVENTS_SIZE};
 
-	jack = std::make_unique<JackWrapper>();
+	jack = rt::make_pmr_unique<JackWrapper>(
+		&arena, JackWrapper::DEFAULT_CLIENT_NAME, &arena
+	);
+	// Woken up by the JACK process thread whenever MIDI input arrives, and
+	// by the HID thread after each input report
+	rt::Notifier midi_notifier;
+	jack->midi_input().set_write_notification_callback(
+		[&](MidiStream&) { midi_notifier.notify(); }
+	);
 	jack->activate();
 
+	if (opts->realtime) {
+		setup_realtime_memory(*jack);
+		if (not hid_events.mlock()) {
+			std::clog << "Failed to lock the HID event buffer\n";
+		}
+	}
+	const int jack_priority = jack->real_time_priority();
+
+	std::jthread reload_thread;
+	if (opts->mapping) {
+		reload_thread = std::jthread{[&]() {
+			reload_mapping_on_sighup(*opts, io_mapper);
+		}};
+	}
+
+	// The HID output thread is the only one writing to the device. It
+	// always writes the latest report of the LED thread, so a slow USB
+	// transfer never holds up the LED thread, and stale reports are
+	// dropped instead of queueing up. The durations of the writes are
+	// passed back for the latency compensation of the LED scheduler.
+	rt::Mailbox<F1Device::OutputReport> hid_output;
+	rt::Mailbox<LedScheduler::clock::duration> write_durations;
+	std::jthread hid_output_thread{[&]() {
+		if (opts->realtime) {
+			enter_realtime(
+				*opts,
+				rt::priority_below_jack(
+					jack_priority,
+					HID_OUTPUT_THREAD_PRIORITY_OFFSET
+				),
+				"HID output"
+			);
+		}
+
+		rt::forbid_heap_allocations();
+		while (true) {
+			if (not hid_output.take_until(
+				    LedScheduler::clock::now() +
+				    LedScheduler::IDLE_WAIT
+			    ))
+				continue;
+
+			const auto start = LedScheduler::clock::now();
+			dev->write(hid_output.value());
+			write_durations.post(
+				LedScheduler::clock::now() - start
+			);
+		}
+	}};
+
+	// The MIDI thread just updates the shared output state and notifies
+	// the LED thread, which decides on the reports to write.
+	rt::Notifier led_notifier;
+	std::jthread led_thread{[&]() {
+		if (opts->realtime) {
+			enter_realtime(
+				*opts,
+				rt::priority_below_jack(
+					jack_priority, LED_THREAD_PRIORITY_OFFSET
+				),
+				"LED output"
+			);
+		}
+
+		LedScheduler scheduler;
+		LedScheduler::Input input;
+		rt::forbid_heap_allocations();
+		bool changed{true};
+		while (true) {
+			input.state = output.latest();
+			input.animations = io_mapper.animations();
+			input.tempo = io_mapper.tempo();
+			input.transport = jack->transport();
+
+			const auto now = LedScheduler::clock::now();
+			if (const auto* report =
+				    scheduler.tick(now, input, changed)) {
+				hid_output.post(*report);
+				if (state_export) {
+					state_export->publish_output(*report);
+				}
+			}
+			if (write_durations.try_take()) {
+				scheduler.write_done(write_durations.value());
+			}
+
+			const auto wakeup =
+				scheduler.next_tick(LedScheduler::clock::now());
+			changed = led_notifier.wait_until(wakeup);
+		}
+	}};
+
 	std::jthread input_thread{[&]() {
+		if (opts->realtime) {
+			enter_realtime(
+				*opts,
+				rt::priority_below_jack(
+					jack_priority, HID_THREAD_PRIORITY_OFFSET
+				),
+				"HID input"
+			);
+		}
+
+		rt::forbid_heap_allocations();
 		while (true) {
 			dev->read_events([&](const F1Device::InputEvent event,
 					     [[maybe_unused]] F1Device&) {
-				auto midi = io_mapper.process_HID_input(
-					event, dev->output_state()
-				);
-				if (midi) {
-					*jack << *midi;
+				// Only full if the MIDI thread is dozens of
+				// reports behind, never wait for it
+				if (not hid_events.full()) {
+					hid_events.push(event);
 				}
 			});
-			dev->write();
+			if (state_export) {
+				state_export->publish_input(
+					dev->input_report()
+				);
+			}
+			midi_notifier.notify();
 		}
 	}};
 
+	if (opts->realtime) {
+		enter_realtime(
+			*opts,
+			rt::priority_below_jack(
+				jack_priority, MIDI_THREAD_PRIORITY_OFFSET
+			),
+			"MIDI"
+		);
+	}
+
+	rt::forbid_heap_allocations();
 	while (true) {
-		bool write_hid{false};
-		for (std::size_t i = 0;
-		     jack->read_bufsize() > 0 && i < BATCH_SIZE;
-		     ++i) {
-			MidiEvent event;
-			*jack >> event;
-
-			write_hid = io_mapper.process_MIDI_event(
-				event, dev->output_state()
+		bool changed{false};
+		std::size_t consumed{0};
+		// The HID events and the whole MIDI batch are published as one
+		// frame
+		output.update([&](F1Device::OutputState& state) {
+			// First, as the HID events are the latency-critical
+			// ones. Those not fitting into the JACK output
+			// buffer wait for the next round.
+			while (not hid_events.empty() &&
+			       not jack->midi_output_full()) {
+				const auto midi = io_mapper.process_HID_input(
+					hid_events.pop(), state
+				);
+				if (midi) {
+					*jack << *midi;
+				}
+				// e.g. bank switches change the state without
+				// emitting MIDI
+				changed = true;
+			}
+
+			const auto process = [&](MidiParser::Result res,
+						 const MidiParser& parser) {
+				if (res == MidiParser::Result::EVENT) {
+					changed |= io_mapper.process_MIDI_event(
+						parser.event(), state
+					);
+				} else if (res == MidiParser::Result::SYSEX) {
+					// LED frames update the whole output
+					// state at once, which is then written
+					// in one report
+					changed |= io_mapper.process_MIDI_sysex(
+						parser.sysex(), state
+					);
+				}
+			};
+			consumed = jack->midi_input().consume_messages(
+				process, BATCH_SIZE
 			);
-		}
+			return changed;
+		});
 
-		if (write_hid) {
-			dev->write();
-		} else {
-			std::this_thread::sleep_for(MIDI_NO_EVENTS_WAIT);
+		if (changed) {
+			led_notifier.notify();
+		}
+		if (consumed < BATCH_SIZE) {
+			midi_notifier.wait_until(
+				std::chrono::steady_clock::now() +
+				(hid_events.empty() ? MIDI_NO_EVENTS_WAIT
+						    : MIDI_OUTPUT_FULL_WAIT)
+			);
 		}
 	}
 
@@ -211,7 +458,162 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 
 namespace
 {
-std::unique_ptr<F1Device> discover_device()
+void print_usage(const char* exe)
+{
+	std::cout << "Usage: " << exe << " [OPTION]...\n\n"
+		  << "  -r, --realtime  run driver threads with SCHED_FIFO "
+		     "and locked memory\n"
+		  << "  -c, --cpu=N     pin driver threads to CPU N\n"
+		  << "  -u, --io-uring  transfer HID reports through io_uring\n"
+		  << "  -m, --mapping=FILE\n"
+		  << "                  load the mapping from FILE, reload it "
+		     "on SIGHUP\n"
+		  << "  -h, --help      show this help\n";
+}
+
+std::optional<Options> parse_args(int argc, char** argv)
+{
+	// NOLINTBEGIN(*-avoid-c-arrays)
+	const option long_opts[] = {
+		{"realtime", no_argument, nullptr, 'r'},
+		{"cpu", required_argument, nullptr, 'c'},
+		{"io-uring", no_argument, nullptr, 'u'},
+		{"mapping", required_argument, nullptr, 'm'},
+		{"help", no_argument, nullptr, 'h'},
+		{nullptr, 0, nullptr, 0},
+	};
+	// NOLINTEND(*-avoid-c-arrays)
+
+	Options opts;
+	int opt{0};
+	while ((opt = getopt_long(argc, argv, "rc:um:h", long_opts, nullptr)
+	       ) != -1) {
+		switch (opt) {
+		case 'r':
+			opts.realtime = true;
+			break;
+		case 'c':
+			try {
+				opts.cpu = std::stoul(optarg);
+			} catch (std::logic_error&) {
+				std::clog << "Invalid CPU index: " << optarg
+					  << '\n';
+				return {};
+			}
+			break;
+		case 'u':
+			opts.io_uring = true;
+			break;
+		case 'm':
+			opts.mapping = optarg;
+			break;
+		case 'h':
+			print_usage(argv[0]);
+			std::exit(errcode::SUCCESS); // NOLINT(concurrency-mt-unsafe)
+		default:
+			print_usage(argv[0]);
+			return {};
+		}
+	}
+
+	return opts;
+}
+
+Mapping default_mapping()
+{
+	Mapping mapping;
+	mapping.matrix_colors = {
+		// clang-format off
+		colors::RED, colors::GREEN, colors::GREEN, colors::RED,
+		colors::GREEN, colors::YELLOW, colors::YELLOW, colors::GREEN,
+		colors::GREEN, colors::BLUE, colors::YELLOW, colors::GREEN,
+		colors::RED, colors::GREEN, colors::GREEN, colors::RED,
+		// clang-format on
+	};
+	mapping.button_toggle.matrix.set();
+	return mapping;
+}
+
+std::optional<Mapping> load_mapping(const Options& opts)
+{
+	if (not opts.mapping) {
+		return default_mapping();
+	}
+
+	try {
+		return Mapping::load(*opts.mapping, default_mapping());
+	} catch (MappingError& e) {
+		std::clog << e.what() << '\n';
+		return {};
+	}
+}
+
+void block_sighup()
+{
+	sigset_t sigset;
+	sigemptyset(&sigset);
+	sigaddset(&sigset, SIGHUP);
+	pthread_sigmask(SIG_BLOCK, &sigset, nullptr);
+}
+
+void reload_mapping_on_sighup(const Options& opts, IOMapper& io_mapper)
+{
+	sigset_t sigset;
+	sigemptyset(&sigset);
+	sigaddset(&sigset, SIGHUP);
+
+	while (true) {
+		int sig{0};
+		if (sigwait(&sigset, &sig) != 0) {
+			continue;
+		}
+
+		if (const auto mapping = load_mapping(opts)) {
+			io_mapper.set_mapping(*mapping);
+			std::cout << "Reloaded mapping from " << *opts.mapping
+				  << '\n';
+		}
+	}
+}
+
+void setup_realtime_memory(JackWrapper& jack)
+{
+	if (const auto err = rt::lock_memory()) {
+		std::clog << "Failed to lock memory (" << err.message()
+			  << "), continuing with pageable memory\n";
+		return;
+	}
+
+	rt::prefault_heap();
+	if (not jack.lock_buffers()) {
+		std::clog << "Failed to lock JACK ringbuffers\n";
+	}
+}
+
+void enter_realtime(const Options& opts, int priority, const char* name)
+{
+	rt::prefault_stack();
+
+	if (opts.cpu) {
+		if (const auto err = rt::pin_thread(*opts.cpu)) {
+			std::clog << "Failed to pin " << name << " thread to CPU "
+				  << *opts.cpu << ": " << err.message() << '\n';
+		}
+	}
+
+	if (const auto err = rt::set_thread_realtime(priority)) {
+		std::clog << "Failed to set SCHED_FIFO priority " << priority
+			  << " for " << name << " thread (" << err.message()
+			  << "), continuing with normal scheduling\n";
+		return;
+	}
+
+	std::cout << "Running " << name << " thread with SCHED_FIFO priority "
+		  << priority << '\n';
+}
+
+rt::pmr_unique_ptr<F1Device>
+discover_device(std::pmr::memory_resource* mem, bool io_uring)
 {
 	for (std::size_t i = 0; i < MAX_HIDRAW_DEVICE_IDX; i++) {
 		std::ostringstream dev_path_oss;
@@ -223,8 +625,12 @@ std::unique_ptr<F1Device> discover_device()
 			HidDevice hid_dev{dev_path.c_str()};
 			const auto devinfo = hid_dev.devinfo();
 			if (F1Device::is_f1_device(devinfo)) {
-				return std::make_unique<F1Device>(
-					std::move(hid_dev)
+				if (io_uring && not hid_dev.enable_io_uring()) {
+					std::cout << "... io_uring is not "
+						     "available\n";
+				}
+				return rt::make_pmr_unique<F1Device>(
+					mem, std::move(hid_dev), mem
 				);
 			}
 		} catch (HidDevicePermissionDenied&) {
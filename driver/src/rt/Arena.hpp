@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace rt
+{
+/**
+ * Fixed-size bump allocator for driver-lifetime objects
+ *
+ * The arena allocates a single block of memory on construction and hands out
+ * chunks of it until it is exhausted. Memory is never reused; it is released
+ * as a whole when the arena is destroyed. This makes all allocations of the
+ * driver happen at startup, in one place and with a known upper bound.
+ *
+ * The arena is not thread-safe. All allocations are expected to happen during
+ * startup from a single thread.
+ */
+class Arena final : public std::pmr::memory_resource
+{
+public:
+	explicit Arena(std::size_t capacity) :
+		buf(std::make_unique<std::byte[]>(capacity)), buf_size(capacity)
+	{
+	}
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+	Arena(Arena&&) = delete;
+	Arena& operator=(Arena&&) = delete;
+	~Arena() override = default;
+
+	[[nodiscard]] std::size_t used() const noexcept
+	{
+		return offset;
+	}
+
+	[[nodiscard]] std::size_t capacity() const noexcept
+	{
+		return buf_size;
+	}
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override
+	{
+		void* ptr = buf.get() + offset; // NOLINT(*-pointer-arithmetic)
+		std::size_t space = buf_size - offset;
+		if (std::align(alignment, bytes, ptr, space) == nullptr)
+			throw std::bad_alloc{};
+
+		offset = buf_size - space + bytes;
+		return ptr;
+	}
+
+	void do_deallocate(
+		[[maybe_unused]] void* ptr,
+		[[maybe_unused]] std::size_t bytes,
+		[[maybe_unused]] std::size_t alignment
+	) override
+	{
+		// Memory is released as a whole on destruction
+	}
+
+	[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other
+	) const noexcept override
+	{
+		return this == &other;
+	}
+
+	std::unique_ptr<std::byte[]> buf; // NOLINT(*-avoid-c-arrays)
+	std::size_t buf_size;
+	std::size_t offset{0};
+};
+
+/**
+ * Deleter for objects allocated from a std::pmr::memory_resource
+ */
+template <typename T>
+struct PmrDeleter {
+	std::pmr::memory_resource* mem{std::pmr::get_default_resource()};
+
+	void operator()(T* ptr) const
+	{
+		std::pmr::polymorphic_allocator<T> alloc{mem};
+		std::destroy_at(ptr);
+		alloc.deallocate(ptr, 1);
+	}
+};
+
+template <typename T>
+using pmr_unique_ptr = std::unique_ptr<T, PmrDeleter<T>>;
+
+/**
+ * Construct an object in the given memory resource
+ *
+ * This is the std::make_unique() equivalent for pmr_unique_ptr.
+ */
+template <typename T, typename... Args>
+pmr_unique_ptr<T> make_pmr_unique(std::pmr::memory_resource* mem, Args&&... args)
+{
+	std::pmr::polymorphic_allocator<T> alloc{mem};
+	T* ptr = alloc.allocate(1);
+	try {
+		std::construct_at(ptr, std::forward<Args>(args)...);
+	} catch (...) {
+		alloc.deallocate(ptr, 1);
+		throw;
+	}
+
+	return {ptr, PmrDeleter<T>{mem}};
+}
+} // namespace rt
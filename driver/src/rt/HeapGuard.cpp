@@ -0,0 +1,113 @@
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+
+#include "HeapGuard.hpp"
+
+namespace
+{
+constinit thread_local bool heap_forbidden{false};
+
+#ifdef TKF1_HEAP_GUARD
+void check_heap_allowed()
+{
+	if (heap_forbidden) {
+		// Allow the assertion handler to allocate
+		heap_forbidden = false;
+		assert(false && "heap allocation after startup");
+	}
+}
+#endif
+} // namespace
+
+#ifdef TKF1_HEAP_GUARD
+// glibc supports replacing the allocator by defining these functions, see
+// "Replacing malloc" in its manual. libstdc++'s operator new is implemented on
+// top of malloc(), and its aligned variants on top of aligned_alloc() or
+// posix_memalign(), so this covers C++ allocations as well.
+extern "C" {
+// NOLINTBEGIN(*-reserved-identifier,*-no-malloc,*-owning-memory)
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t num, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void* __libc_valloc(std::size_t size);
+void* __libc_pvalloc(std::size_t size);
+
+void* malloc(std::size_t size)
+{
+	check_heap_allowed();
+	return __libc_malloc(size);
+}
+
+void* calloc(std::size_t num, std::size_t size)
+{
+	check_heap_allowed();
+	return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, std::size_t size)
+{
+	check_heap_allowed();
+	return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size)
+{
+	check_heap_allowed();
+	return __libc_memalign(alignment, size);
+}
+
+void* memalign(std::size_t alignment, std::size_t size)
+{
+	check_heap_allowed();
+	return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** memptr, std::size_t alignment, std::size_t size)
+{
+	check_heap_allowed();
+	// Unlike memalign(), this must reject invalid alignments
+	if (not std::has_single_bit(alignment) ||
+	    alignment % sizeof(void*) != 0)
+		return EINVAL;
+	void* ptr = __libc_memalign(alignment, size);
+	if (ptr == nullptr)
+		return ENOMEM;
+	*memptr = ptr;
+	return 0;
+}
+
+void* valloc(std::size_t size)
+{
+	check_heap_allowed();
+	return __libc_valloc(size);
+}
+
+void* pvalloc(std::size_t size)
+{
+	check_heap_allowed();
+	return __libc_pvalloc(size);
+}
+// NOLINTEND(*-reserved-identifier,*-no-malloc,*-owning-memory)
+}
+#endif
+
+namespace rt
+{
+void forbid_heap_allocations() noexcept
+{
+	heap_forbidden = true;
+}
+
+void allow_heap_allocations() noexcept
+{
+	heap_forbidden = false;
+}
+
+bool heap_allocations_allowed() noexcept
+{
+	return not heap_forbidden;
+}
+} // namespace rt
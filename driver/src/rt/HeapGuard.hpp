@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef __has_feature
+# define __has_feature(x) 0 // NOLINT(*-reserved-identifier)
+#endif
+
+/**
+ * Defined if the allocator is replaced, i.e. in debug builds without ASan or
+ * TSan, which replace it themselves
+ */
+#if !defined(NDEBUG) && !__has_feature(address_sanitizer) &&                   \
+	!defined(__SANITIZE_ADDRESS__) && !__has_feature(thread_sanitizer) && \
+	!defined(__SANITIZE_THREAD__)
+# define TKF1_HEAP_GUARD
+#endif
+
+namespace rt
+{
+/**
+ * Forbid heap allocations in the calling thread
+ *
+ * In debug builds, the driver replaces malloc() and friends with versions
+ * asserting that the calling thread has not forbidden heap allocations.
+ * Calling this function at the start of a real-time loop turns every heap
+ * allocation in that loop into an assertion failure. This covers all
+ * allocation functions of glibc, including the aligned ones used by aligned
+ * operator new.
+ *
+ * Without TKF1_HEAP_GUARD, e.g. in release builds (NDEBUG), this function
+ * does nothing.
+ */
+void forbid_heap_allocations() noexcept;
+
+/**
+ * Allow heap allocations in the calling thread again
+ */
+void allow_heap_allocations() noexcept;
+
+/**
+ * Check whether the calling thread may allocate heap memory
+ */
+[[nodiscard]] bool heap_allocations_allowed() noexcept;
+} // namespace rt
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <type_traits>
+
+#include "rt/Notifier.hpp"
+#include "rt/TripleBuffer.hpp"
+
+namespace rt
+{
+/**
+ * Slot passing the latest value from one thread to another
+ *
+ * The sender posts values without ever waiting. The receiver waits for a
+ * new value and always gets the latest one. Values posted while the
+ * receiver is busy replace each other instead of queueing up, so a slow
+ * receiver falls behind by at most one value.
+ */
+template <typename T>
+class Mailbox final
+{
+public:
+	explicit Mailbox(const T& value = {}) : buffer(value) {}
+	Mailbox(const Mailbox&) = delete;
+	Mailbox& operator=(const Mailbox&) = delete;
+	Mailbox(Mailbox&&) = delete;
+	Mailbox& operator=(Mailbox&&) = delete;
+	~Mailbox() = default;
+
+	/**
+	 * Post a value, replacing a value not taken yet
+	 *
+	 * Only the sender may call this.
+	 */
+	void post(const T& value) noexcept(std::is_nothrow_copy_assignable_v<T>)
+	{
+		buffer.back() = value;
+		buffer.publish();
+		notifier.notify();
+	}
+
+	/**
+	 * Take a new value if one has been posted
+	 *
+	 * Only the receiver may call this.
+	 *
+	 * @return true if a new value is available with value()
+	 */
+	bool try_take() noexcept
+	{
+		return buffer.update();
+	}
+
+	/**
+	 * Wait for a new value until the given point in time
+	 *
+	 * Only the receiver may call this.
+	 *
+	 * @return true if a new value is available with value()
+	 */
+	template <typename Clock, typename Duration>
+	bool take_until(const std::chrono::time_point<Clock, Duration>& t)
+	{
+		if (buffer.update())
+			return true;
+		// A notification may belong to a value taken above already
+		while (notifier.wait_until(t)) {
+			if (buffer.update())
+				return true;
+		}
+		return false;
+	}
+
+	/**
+	 * Get the value taken last
+	 *
+	 * Only the receiver may call this.
+	 */
+	[[nodiscard]] const T& value() const noexcept
+	{
+		return buffer.front();
+	}
+
+private:
+	TripleBuffer<T> buffer;
+	Notifier notifier;
+};
+} // namespace rt
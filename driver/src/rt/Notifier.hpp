@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <semaphore>
+
+namespace rt
+{
+/**
+ * Coalescing wake-up signal for a single waiting thread
+ *
+ * Any number of threads may notify() the waiter. Notifications arriving
+ * while one is already pending are merged into it, so notify() only touches
+ * the semaphore (and thus possibly makes a syscall) once per wake-up of the
+ * waiter, however many events happen in between.
+ *
+ * Only one thread may wait at a time.
+ */
+class Notifier final
+{
+public:
+	/**
+	 * Wake up the waiting thread
+	 */
+	void notify() noexcept
+	{
+		if (not pending.exchange(true, std::memory_order_acq_rel))
+			sem.release();
+	}
+
+	/**
+	 * Wait for a notification until the given point in time
+	 *
+	 * This returns whether a notification has been received. All
+	 * notifications sent before the return are consumed.
+	 */
+	template <typename Clock, typename Duration>
+	bool wait_until(const std::chrono::time_point<Clock, Duration>& t)
+	{
+		if (not sem.try_acquire_until(t))
+			return false;
+		// Notifications racing with this are consumed, but the caller
+		// still sees everything that happened before them
+		pending.exchange(false, std::memory_order_acq_rel);
+		return true;
+	}
+
+private:
+	std::atomic<bool> pending{false};
+	std::binary_semaphore sem{0};
+};
+} // namespace rt
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+
+namespace rt
+{
+/**
+ * Read-copy-update cell for a fixed set of reader threads
+ *
+ * The cell holds a pointer to an immutable value. Readers obtain the current
+ * value with read() without taking any lock; a writer replaces it with
+ * publish(). The old value is freed once every reader has finished the read
+ * section which might still use it.
+ *
+ * Each reader thread owns one reader slot (0 <= slot < readers). A read
+ * section costs one store to the slot (which lives on its own cache line)
+ * and one load of the pointer on entry, and one store to the slot on exit.
+ * Readers which are not inside a read section never delay a writer, so a
+ * reader may block (e.g. in a read() syscall) between read sections.
+ *
+ * Only one thread may call publish() at a time.
+ */
+template <typename T, std::size_t readers>
+class Rcu final
+{
+	constexpr static std::uint64_t OFFLINE{
+		std::numeric_limits<std::uint64_t>::max()
+	};
+	constexpr static std::size_t CACHE_LINE_SIZE{64};
+
+	struct alignas(CACHE_LINE_SIZE) Slot {
+		std::atomic<std::uint64_t> epoch{OFFLINE};
+	};
+
+public:
+	/**
+	 * Scoped read section
+	 *
+	 * The value pointed to stays valid for the lifetime of the guard.
+	 */
+	class ReadGuard final
+	{
+	public:
+		ReadGuard(const ReadGuard&) = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+		ReadGuard(ReadGuard&&) = delete;
+		ReadGuard& operator=(ReadGuard&&) = delete;
+		~ReadGuard()
+		{
+			slot.epoch.store(OFFLINE, std::memory_order_release);
+		}
+
+		const T& operator*() const noexcept
+		{
+			return *value;
+		}
+
+		const T* operator->() const noexcept
+		{
+			return value;
+		}
+
+	private:
+		ReadGuard(Slot& slot, const T* value) : slot(slot), value(value)
+		{
+		}
+
+		Slot& slot;
+		const T* value;
+
+		friend class Rcu;
+	};
+
+	explicit Rcu(std::unique_ptr<const T> initial) :
+		current(initial.release())
+	{
+		assert(current.load() != nullptr);
+	}
+	Rcu(const Rcu&) = delete;
+	Rcu& operator=(const Rcu&) = delete;
+	Rcu(Rcu&&) = delete;
+	Rcu& operator=(Rcu&&) = delete;
+	~Rcu()
+	{
+		delete current.load(); // NOLINT(*-owning-memory)
+	}
+
+	/**
+	 * Enter a read section for the given reader slot
+	 */
+	[[nodiscard]] ReadGuard read(std::size_t reader) noexcept
+	{
+		assert(reader < readers);
+		Slot& slot = slots.at(reader);
+		assert(slot.epoch.load(std::memory_order_relaxed) == OFFLINE);
+
+		// Announcing the epoch must be ordered before loading the
+		// pointer, so both are sequentially consistent.
+		slot.epoch.store(epoch.load());
+		return {slot, current.load()};
+	}
+
+	/**
+	 * Replace the current value
+	 *
+	 * New read sections see the new value immediately. This function
+	 * blocks until all read sections which might use the old value have
+	 * been left and frees the old value afterwards.
+	 *
+	 * Must not be called from within a read section.
+	 */
+	void publish(std::unique_ptr<const T> value)
+	{
+		assert(value);
+		const std::unique_ptr<const T> old{
+			current.exchange(value.release())
+		};
+		const std::uint64_t new_epoch = epoch.fetch_add(1) + 1;
+
+		for (const Slot& slot : slots) {
+			// Readers which entered with an epoch >= new_epoch have
+			// loaded the new value, OFFLINE readers hold no value.
+			while (slot.epoch.load() < new_epoch) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+private:
+	std::atomic<const T*> current;
+	std::atomic<std::uint64_t> epoch{0};
+	std::array<Slot, readers> slots{};
+};
+} // namespace rt
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "Realtime.hpp"
+
+namespace
+{
+std::error_code errno_code(int err) noexcept
+{
+	return {err, std::system_category()};
+}
+} // namespace
+
+namespace rt
+{
+int priority_below_jack(int jack_priority, int offset) noexcept
+{
+	const int base = jack_priority < 0 ? DEFAULT_JACK_PRIORITY
+					   : jack_priority;
+	return std::clamp(
+		base - offset,
+		sched_get_priority_min(SCHED_FIFO),
+		sched_get_priority_max(SCHED_FIFO)
+	);
+}
+
+std::error_code set_thread_realtime(int priority) noexcept
+{
+	sched_param param{};
+	param.sched_priority = priority;
+	return errno_code(
+		pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)
+	);
+}
+
+std::error_code pin_thread(std::size_t cpu) noexcept
+{
+	// sched_getaffinity() is used instead of get_nprocs(), as the latter
+	// reads /sys, which is not accessible once Landlock is enforced.
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+		return errno_code(errno);
+
+	if (cpu >= CPU_SETSIZE || not CPU_ISSET(cpu, &allowed))
+		return errno_code(EINVAL);
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return errno_code(
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set)
+	);
+}
+
+std::error_code lock_memory() noexcept
+{
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+		return errno_code(errno);
+
+	return {};
+}
+
+void prefault_heap(std::size_t size)
+{
+	// Never give memory back to the kernel and never use mmap() for large
+	// chunks, so the pre-faulted memory stays available to malloc().
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+
+	const std::unique_ptr<std::uint8_t[]> heap{new std::uint8_t[size]};
+	std::memset(heap.get(), 0, size);
+	// Prevent the compiler from eliding the writes above
+	asm volatile("" : : "r"(heap.get()) : "memory");
+}
+} // namespace rt
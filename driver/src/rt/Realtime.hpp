@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+
+/**
+ * Helpers for running driver threads with real-time guarantees
+ *
+ * All functions in this namespace only use plain syscalls (no file system
+ * access), so they keep working after the Landlock ruleset has been enforced.
+ * Errors are reported as std::error_code instead of exceptions, as missing
+ * rtprio or memlock limits are expected on many systems and should only
+ * degrade the driver to normal scheduling.
+ */
+namespace rt
+{
+/**
+ * Priority to assume for the JACK process thread if JACK does not run in
+ * real-time mode itself
+ */
+constexpr int DEFAULT_JACK_PRIORITY{20};
+/**
+ * Default amount of stack memory pre-faulted per real-time thread
+ */
+constexpr std::size_t DEFAULT_STACK_PREFAULT{64U * 1024U};
+/**
+ * Default amount of heap memory pre-faulted and kept in the allocator
+ */
+constexpr std::size_t DEFAULT_HEAP_PREFAULT{1024U * 1024U};
+
+/**
+ * Calculate a SCHED_FIFO priority relative to the JACK process thread
+ *
+ * The driver threads must not preempt JACK's process callback, so they run
+ * offset priorities below it. A negative jack_priority (as returned by
+ * jack_client_real_time_priority() for non-RT JACK) selects
+ * DEFAULT_JACK_PRIORITY. The result is clamped to the valid SCHED_FIFO range.
+ */
+int priority_below_jack(int jack_priority, int offset) noexcept;
+
+/**
+ * Switch the calling thread to SCHED_FIFO with the given priority
+ */
+std::error_code set_thread_realtime(int priority) noexcept;
+
+/**
+ * Pin the calling thread to a single CPU
+ *
+ * The CPU index must be part of the process' current affinity mask.
+ */
+std::error_code pin_thread(std::size_t cpu) noexcept;
+
+/**
+ * Lock all current and future pages of the process into memory
+ */
+std::error_code lock_memory() noexcept;
+
+/**
+ * Pre-fault heap memory and keep it inside the allocator
+ *
+ * This disables heap trimming and mmap()-backed allocations, then touches
+ * size bytes of heap memory, so later allocations are served from memory
+ * which is already mapped (and locked, if lock_memory() succeeded before).
+ */
+void prefault_heap(std::size_t size = DEFAULT_HEAP_PREFAULT);
+
+/**
+ * Touch size bytes of the calling thread's stack
+ *
+ * This must be called from the thread whose stack should be pre-faulted,
+ * ideally right after lock_memory().
+ */
+template <std::size_t size = DEFAULT_STACK_PREFAULT>
+[[gnu::noinline]] void prefault_stack() noexcept
+{
+	std::array<volatile std::uint8_t, size> stack;
+	for (auto& b : stack) {
+		b = 0;
+	}
+}
+} // namespace rt
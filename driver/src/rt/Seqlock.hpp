@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace rt
+{
+/**
+ * Sequence lock for a small value with a single writer
+ *
+ * The writer never waits: store() bumps the sequence number to an odd value,
+ * updates the value and bumps the sequence number again. Readers copy the
+ * value and retry if the sequence number has changed or was odd while they
+ * were copying, so a reader never sees a partially updated value.
+ *
+ * This fits values which are written much more often than a lock could be
+ * taken, e.g. from a JACK process callback, and read occasionally. The value
+ * is copied word by word with relaxed atomics, so it must be trivially
+ * copyable.
+ */
+template <typename T>
+class Seqlock final
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	static_assert(std::is_default_constructible_v<T>);
+
+	using Word = std::uint64_t;
+	constexpr static std::size_t WORDS{
+		(sizeof(T) + sizeof(Word) - 1) / sizeof(Word)
+	};
+
+public:
+	explicit Seqlock(const T& value = {}) noexcept
+	{
+		store(value);
+	}
+
+	/**
+	 * Replace the value
+	 *
+	 * Only one thread may call this at a time.
+	 */
+	void store(const T& value) noexcept
+	{
+		std::array<Word, WORDS> words{};
+		std::memcpy(words.data(), &value, sizeof(T));
+
+		const Word seq = sequence.load(std::memory_order_relaxed);
+		sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (std::size_t i = 0; i < WORDS; ++i) {
+			data[i].store(words[i], std::memory_order_relaxed);
+		}
+		sequence.store(seq + 2, std::memory_order_release);
+	}
+
+	/**
+	 * Get a consistent copy of the value
+	 */
+	T load() const noexcept
+	{
+		std::array<Word, WORDS> words{};
+		constexpr auto relaxed = std::memory_order_relaxed;
+		Word seq{0};
+		do {
+			seq = sequence.load(std::memory_order_acquire);
+			for (std::size_t i = 0; i < WORDS; ++i) {
+				words[i] = data[i].load(relaxed);
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+		} while ((seq & 1U) != 0 || seq != sequence.load(relaxed));
+
+		// T may have default member initializers, which makes it a
+		// non-trivial type for -Wclass-memaccess
+		T value{};
+		void* dest = &value;
+		std::memcpy(dest, words.data(), sizeof(T));
+		return value;
+	}
+
+private:
+	std::atomic<Word> sequence{0};
+	std::array<std::atomic<Word>, WORDS> data{};
+};
+} // namespace rt
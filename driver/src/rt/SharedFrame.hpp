@@ -0,0 +1,83 @@
+#pragma once
+
+#include <concepts>
+#include <functional>
+#include <type_traits>
+
+#include "rt/TripleBuffer.hpp"
+
+namespace rt
+{
+/**
+ * Value modified by one writer and read as complete frames
+ *
+ * The writer modifies the value with update(), which runs the modification
+ * on the writer's copy of the value and then publishes a copy of it as a
+ * complete frame. The reader gets the latest frame with latest(). Neither
+ * side ever waits, so the reader never sees a half-done modification, and
+ * may run at a different priority than the writer.
+ *
+ * There is no locking: update() must only be called from one thread, and
+ * latest() from one other thread. Threads with changes of their own pass
+ * them to the writer instead.
+ */
+template <typename T>
+class SharedFrame final
+{
+public:
+	explicit SharedFrame(const T& value = {}) :
+		value(value), frames(value)
+	{
+	}
+	SharedFrame(const SharedFrame&) = delete;
+	SharedFrame& operator=(const SharedFrame&) = delete;
+	SharedFrame(SharedFrame&&) = delete;
+	SharedFrame& operator=(SharedFrame&&) = delete;
+	~SharedFrame() = default;
+
+	/**
+	 * Modify the value and publish the result
+	 *
+	 * If fn returns a bool, the result is only published if fn returns
+	 * true, i.e. if it changed the value. The return value of fn is
+	 * passed on. Only one thread may modify the value.
+	 *
+	 * @param fn Callable taking a T&
+	 */
+	template <std::invocable<T&> Fn>
+	auto update(Fn&& fn)
+	{
+		if constexpr (std::is_void_v<std::invoke_result_t<Fn, T&>>) {
+			std::invoke(std::forward<Fn>(fn), value);
+			publish();
+		} else {
+			auto res = std::invoke(std::forward<Fn>(fn), value);
+			if (static_cast<bool>(res))
+				publish();
+			return res;
+		}
+	}
+
+	/**
+	 * Get the latest published frame
+	 *
+	 * The frame stays valid until the next call. Only one thread may read
+	 * the frames.
+	 */
+	[[nodiscard]] const T& latest() noexcept
+	{
+		frames.update();
+		return frames.front();
+	}
+
+private:
+	void publish()
+	{
+		frames.back() = value;
+		frames.publish();
+	}
+
+	T value;
+	TripleBuffer<T> frames;
+};
+} // namespace rt
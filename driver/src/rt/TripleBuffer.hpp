@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace rt
+{
+/**
+ * Triple buffer passing complete values from one writer to one reader
+ *
+ * The writer prepares the next value in back() and publishes it with
+ * publish(), which swaps the back buffer with the middle one. The reader
+ * picks up the latest published value with update(), which swaps the middle
+ * buffer with the front one. Each swap is a single atomic exchange, so
+ * neither side ever waits or retries, and the reader always sees a complete
+ * value. Values published between two updates are skipped.
+ *
+ * Unlike Seqlock, this needs no trivially copyable T, since the values are
+ * never copied behind the back of their owner.
+ */
+template <typename T>
+class TripleBuffer final
+{
+	constexpr static std::uint8_t INDEX_MASK{0b011};
+	/** Set in middle while it holds a value the reader hasn't seen */
+	constexpr static std::uint8_t FRESH{0b100};
+	constexpr static std::size_t CACHE_LINE_SIZE{64};
+
+public:
+	explicit TripleBuffer(const T& value = {}) :
+		buffers{value, value, value}
+	{
+	}
+
+	/**
+	 * Get the buffer for the next value
+	 *
+	 * The buffer still holds an older value, so it has to be overwritten
+	 * completely. Only the writer may call this.
+	 */
+	T& back() noexcept
+	{
+		return buffers[back_idx];
+	}
+
+	/**
+	 * Publish the back buffer
+	 *
+	 * Only the writer may call this.
+	 */
+	void publish() noexcept
+	{
+		back_idx = middle.exchange(
+				   back_idx | FRESH, std::memory_order_acq_rel
+			   ) &
+			   INDEX_MASK;
+	}
+
+	/**
+	 * Pick up the latest published value
+	 *
+	 * Only the reader may call this.
+	 *
+	 * @return true if a new value has been published since the last call
+	 */
+	bool update() noexcept
+	{
+		if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+			return false;
+
+		front_idx =
+			middle.exchange(front_idx, std::memory_order_acq_rel) &
+			INDEX_MASK;
+		return true;
+	}
+
+	/**
+	 * Get the value picked up by the last update()
+	 *
+	 * Only the reader may call this.
+	 */
+	[[nodiscard]] const T& front() const noexcept
+	{
+		return buffers[front_idx];
+	}
+
+private:
+	std::array<T, 3> buffers;
+	alignas(CACHE_LINE_SIZE) std::atomic<std::uint8_t> middle{1};
+	alignas(CACHE_LINE_SIZE) std::uint8_t back_idx{0};
+	alignas(CACHE_LINE_SIZE) std::uint8_t front_idx{2};
+};
+} // namespace rt
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+
+#include "Animator.hpp"
+
+using Brightness = F1Device::Brightness;
+using ButtonMask = Animator::ButtonMask;
+
+namespace
+{
+/**
+ * Lowest level of a pulsing LED, so it never goes entirely dark
+ */
+constexpr double PULSE_MIN{0.2};
+
+using LevelTable = std::array<std::uint8_t, Animator::FRAMES_NUM>;
+
+LevelTable make_blink_levels()
+{
+	LevelTable levels{};
+	for (std::size_t f = 0; f < levels.size(); ++f) {
+		levels.at(f) = f < levels.size() / 2 ? Animator::LEVEL_MAX : 0;
+	}
+	return levels;
+}
+
+LevelTable make_pulse_levels()
+{
+	LevelTable levels{};
+	for (std::size_t f = 0; f < levels.size(); ++f) {
+		const double phase = 2. * std::numbers::pi *
+				     static_cast<double>(f) /
+				     static_cast<double>(levels.size());
+		const double wave = (1. + std::cos(phase)) / 2.;
+		const double factor = PULSE_MIN + (1. - PULSE_MIN) * wave;
+		levels.at(f) = static_cast<std::uint8_t>(
+			std::lround(factor * Animator::LEVEL_MAX)
+		);
+	}
+	return levels;
+}
+
+const LevelTable BLINK_LEVELS = make_blink_levels();
+const LevelTable PULSE_LEVELS = make_pulse_levels();
+
+Brightness scale(Brightness value, unsigned level)
+{
+	return static_cast<Brightness>(value * level / Animator::LEVEL_MAX);
+}
+
+void scale_button(F1Device::OutputState& state, std::size_t bit, unsigned level)
+{
+	if (bit < MappingTable::SPECIAL_SHIFT) {
+		auto& [b, r, g] =
+			state.matrix_btns.at(bit - MappingTable::MATRIX_SHIFT);
+		b = scale(b, level);
+		r = scale(r, level);
+		g = scale(g, level);
+	} else if (bit < MappingTable::STOP_SHIFT) {
+		const std::size_t idx = bit - MappingTable::SPECIAL_SHIFT;
+		auto& brightness = state.special_btns.at(idx);
+		brightness = scale(brightness, level);
+	} else if (bit < Animator::SEGMENTS_SHIFT) {
+		auto& brightness =
+			state.stop_btns.at(bit - MappingTable::STOP_SHIFT);
+		brightness = scale(brightness, level);
+	} else if (bit == Animator::SEGMENTS_SHIFT) {
+		state.segment_left_brightness =
+			scale(state.segment_left_brightness, level);
+		state.segment_left_dot = scale(state.segment_left_dot, level);
+	} else {
+		state.segment_right_brightness =
+			scale(state.segment_right_brightness, level);
+		state.segment_right_dot = scale(state.segment_right_dot, level);
+	}
+}
+
+template <typename Fn>
+void for_each_bit(ButtonMask mask, Fn fn)
+{
+	for (std::size_t i = 0; mask != 0; ++i) {
+		const auto bit =
+			static_cast<std::size_t>(std::countr_zero(mask));
+		fn(bit, i);
+		mask &= mask - 1;
+	}
+}
+} // namespace
+
+Animator::Animator(clock::time_point epoch) :
+	epoch(epoch),
+	duration(std::chrono::duration_cast<clock::duration>(
+			 Mapping::DEFAULT_ANIMATION_PERIOD
+		 ) /
+		 FRAMES_NUM)
+{
+}
+
+void Animator::set_epoch(clock::time_point start) noexcept
+{
+	epoch = start;
+}
+
+void Animator::compile(
+	const F1Device::OutputState& state, const Animations& animations
+)
+{
+	duration = animations.period / FRAMES_NUM;
+
+	for (std::size_t f = 0; f < FRAMES_NUM; ++f) {
+		F1Device::OutputState frame_state = state;
+		apply(frame_state, animations, f);
+		F1Device::encode_output(frame_state, frames.at(f));
+	}
+
+	for (std::size_t f = 0; f < FRAMES_NUM; ++f) {
+		const bool same = f > 0 && frames.at(f) == frames.at(f - 1);
+		frame_ids.at(f) = same ? frame_ids.at(f - 1) : f;
+	}
+	const std::size_t last_run = frame_ids.back();
+	if (last_run != 0 && frames.back() == frames.front()) {
+		for (std::size_t f = last_run; f < FRAMES_NUM; ++f) {
+			frame_ids.at(f) = 0;
+		}
+	}
+
+	is_animated = std::any_of(
+		frame_ids.begin(), frame_ids.end(), [](std::size_t id) {
+			return id != 0;
+		}
+	);
+	recompiled = true;
+}
+
+const F1Device::OutputReport* Animator::frame(clock::time_point now) noexcept
+{
+	const std::size_t id = frame_ids[frame_index(now)];
+	if (not recompiled && id == last_id)
+		return nullptr;
+
+	recompiled = false;
+	last_id = id;
+	if (frames[id] == last_report)
+		return nullptr;
+	last_report = frames[id];
+	return &last_report;
+}
+
+bool Animator::animated() const noexcept
+{
+	return is_animated;
+}
+
+Animator::clock::time_point Animator::next_frame(clock::time_point now
+) const noexcept
+{
+	if (now < epoch)
+		return epoch;
+
+	const auto frame = (now - epoch) / duration;
+	const std::size_t id = frame_ids[frame_index(now)];
+	std::size_t steps = 1;
+	while (steps < FRAMES_NUM &&
+	       frame_ids[(frame + steps) % FRAMES_NUM] == id) {
+		++steps;
+	}
+	return epoch + (frame + steps) * duration;
+}
+
+unsigned Animator::level(Mapping::Animation animation, std::size_t frame)
+{
+	switch (animation) {
+	case Mapping::BLINK:
+		return BLINK_LEVELS.at(frame);
+	case Mapping::PULSE:
+		return PULSE_LEVELS.at(frame);
+	default:
+		return LEVEL_MAX;
+	}
+}
+
+void Animator::apply(
+	F1Device::OutputState& state,
+	const Animations& animations,
+	std::size_t frame
+)
+{
+	for (const auto animation : {Mapping::BLINK, Mapping::PULSE}) {
+		const unsigned lvl = level(animation, frame);
+		for_each_bit(
+			animations.buttons.at(animation),
+			[&](std::size_t bit, std::size_t) {
+				scale_button(state, bit, lvl);
+			}
+		);
+	}
+
+	// Only the k-th of the chasing buttons is lit in the k-th part of the
+	// cycle
+	const ButtonMask chase = animations.buttons.at(Mapping::CHASE);
+	const auto chase_num = static_cast<std::size_t>(std::popcount(chase));
+	const std::size_t lit = frame * chase_num / FRAMES_NUM;
+	for_each_bit(chase, [&](std::size_t bit, std::size_t i) {
+		if (i != lit)
+			scale_button(state, bit, 0);
+	});
+}
+
+std::size_t Animator::frame_index(clock::time_point now) const noexcept
+{
+	if (now < epoch)
+		return 0;
+	return static_cast<std::size_t>((now - epoch) / duration) % FRAMES_NUM;
+}
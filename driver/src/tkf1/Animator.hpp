@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "tkf1/F1Device.hpp"
+#include "tkf1/Mapping.hpp"
+
+/**
+ * LED animation engine
+ *
+ * The animator turns an output state and a set of animated buttons into the
+ * output reports of one animation cycle. The cycle is divided into FRAMES_NUM
+ * frames, which are all encoded by compile() whenever the output state or the
+ * animations change. Showing an animation frame thus boils down to picking
+ * the report for the current point in time and writing it to the device.
+ *
+ * frame() only returns a report if it differs from the last one returned, so
+ * static output and the flat parts of an animation (e.g. the off phase of a
+ * blinking button) do not cause any HID traffic.
+ */
+class Animator final
+{
+public:
+	using clock = std::chrono::steady_clock;
+	using ButtonMask = MappingTable::ButtonMask;
+
+	constexpr static std::size_t FRAMES_NUM{32};
+	/**
+	 * Animation level of a fully lit LED
+	 */
+	constexpr static unsigned LEVEL_MAX{255U};
+
+	/**
+	 * Bits for the segment displays in a ButtonMask
+	 */
+	constexpr static std::size_t SEGMENTS_SHIFT{
+		MappingTable::STOP_SHIFT + F1Device::STOP_BUTTONS_NUM
+	};
+	constexpr static ButtonMask SEGMENT_LEFT{ButtonMask{1}
+						 << SEGMENTS_SHIFT};
+	constexpr static ButtonMask SEGMENT_RIGHT{ButtonMask{1}
+						  << (SEGMENTS_SHIFT + 1)};
+
+	static_assert(SEGMENTS_SHIFT + 2 <= 32);
+
+	/**
+	 * Buttons to animate, one mask per Mapping::Animation
+	 */
+	struct Animations {
+		std::array<ButtonMask, Mapping::ANIMATIONS_NUM> buttons{};
+		clock::duration period{Mapping::DEFAULT_ANIMATION_PERIOD};
+
+		bool operator==(const Animations&) const = default;
+	};
+
+	/**
+	 * Create an animator with all animation cycles starting at epoch
+	 */
+	explicit Animator(clock::time_point epoch = clock::now());
+
+	/**
+	 * Let the animation cycles start at the given point in time
+	 */
+	void set_epoch(clock::time_point start) noexcept;
+
+	/**
+	 * Encode all frames of the given output state and animations
+	 *
+	 * The next call to frame() returns the new report even if it happens
+	 * to be identical to a previous frame.
+	 */
+	void compile(
+		const F1Device::OutputState& state, const Animations& animations
+	);
+
+	/**
+	 * Get the report to write at the given point in time
+	 *
+	 * This returns nullptr if the report has not changed since the last
+	 * call. The report stays valid until the next call to compile() or
+	 * frame().
+	 */
+	const F1Device::OutputReport* frame(clock::time_point now) noexcept;
+
+	/**
+	 * Whether the compiled frames differ from each other
+	 *
+	 * If not, frame() only needs to be called after compile().
+	 */
+	[[nodiscard]] bool animated() const noexcept;
+
+	/**
+	 * Get the start of the first frame after now which differs from the
+	 * frame shown at now
+	 */
+	[[nodiscard]] clock::time_point next_frame(clock::time_point now
+	) const noexcept;
+
+	/**
+	 * Get the level of a pattern in a frame, from 0 to LEVEL_MAX
+	 *
+	 * CHASE is not a level pattern and always yields LEVEL_MAX.
+	 */
+	static unsigned level(Mapping::Animation animation, std::size_t frame);
+
+	/**
+	 * Apply a frame of the animations to an output state
+	 */
+	static void apply(
+		F1Device::OutputState& state,
+		const Animations& animations,
+		std::size_t frame
+	);
+
+private:
+	[[nodiscard]] std::size_t frame_index(clock::time_point now
+	) const noexcept;
+
+	clock::time_point epoch;
+	clock::duration duration;
+	bool is_animated{false};
+	bool recompiled{true};
+
+	std::array<F1Device::OutputReport, FRAMES_NUM> frames{};
+	/**
+	 * Index of the first frame of the run of identical frames each frame
+	 * belongs to
+	 *
+	 * A run may wrap around from the last to the first frame.
+	 */
+	std::array<std::size_t, FRAMES_NUM> frame_ids{};
+	std::size_t last_id{0};
+	F1Device::OutputReport last_report{};
+};
@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "F1Device.hpp"
 #include "io/HidDevice.hpp"
@@ -25,130 +27,22 @@ F1Device::SegmentChar digit_to_segment(std::uint8_t digit);
 class F1Device::Impl
 {
 public:
-	explicit Impl(HidDevice&& dev) : dev(std::move(dev))
+	Impl(HidDevice&& dev, std::pmr::memory_resource* mem) :
+		dev(std::move(dev)), input_events(mem)
 	{
-		for (std::size_t i = 0; i < OUTPUT_REPORT_SIZE; ++i) {
-			out_report.at(i) = 0x00U;
-		}
+		input_events.reserve(MAX_INPUT_EVENTS);
 		update_out_report();
 	}
 
 	void update_in_state()
 	{
 		old_input_state = input_state;
-		if (in_report.at(0) != INPUT_REPORT_ID)
-			return;
-
-		input_state.report_id = in_report.at(0);
-
-		for (std::size_t i = 0; i < 2; ++i) {
-			for (std::size_t j = 0; j < 8; ++j) {
-				input_state.matrix_btns[j + 8 * i] =
-					(((1U << (7U - j)) & in_report.at(i + 1)
-					 ) != 0U);
-			}
-		}
-
-		for (std::size_t i = 2; i < 8; ++i) {
-			input_state.special_btns[i - 2] =
-				(((1U << i) & in_report.at(3)) != 0U);
-		}
-
-		for (std::size_t i = 1; i < 4; ++i) {
-			input_state.special_btns[i + 5] =
-				(((1U << i) & in_report.at(4)) != 0U);
-		}
-
-		for (std::size_t i = 0; i < 4; ++i) {
-			input_state.stop_btns[i] =
-				(((1U << (4 + (3 - i))) & in_report.at(4)) != 0U
-				);
-		}
-
-		input_state.wheel = in_report.at(5);
-
-		for (std::size_t i = 0; i < 4; ++i) {
-			input_state.knobs.at(i
-			) = static_cast<std::uint16_t>(in_report.at(6 + i * 2)
-			    ) |
-			    static_cast<std::uint16_t>(
-				    in_report.at(7 + i * 2) << 8U
-			    );
-		}
-
-		for (std::size_t i = 0; i < 4; ++i) {
-			input_state.faders.at(i
-			) = static_cast<std::uint16_t>(in_report.at(14 + i * 2)
-			    ) |
-			    (static_cast<std::uint16_t>(
-				     in_report.at(15 + i * 2) & 0xffU
-			     )
-			     << 8U);
-		}
+		decode_input(in_report, input_state);
 	}
 
 	void update_out_report()
 	{
-		out_report.at(0) = output_state.report_id;
-
-		for (std::size_t i = 0; i < MATRIX_BUTTONS_NUM; i++) {
-			// F1 uses 7-bit BRG color
-			const auto& [b, r, g] = output_state.matrix_btns.at(i);
-			assert(r < MAX_BRIGHTNESS);
-			assert(g < MAX_BRIGHTNESS);
-			assert(b < MAX_BRIGHTNESS);
-			out_report.at(i * 3 + out_offsets::MATRIX) = b;
-			out_report.at(i * 3 + 1 + out_offsets::MATRIX) = r;
-			out_report.at(i * 3 + 2 + out_offsets::MATRIX) = g;
-		}
-
-		for (std::size_t i = 0; i < STOP_BUTTONS_NUM; ++i) {
-			const auto& brightness =
-				output_state.stop_btns.at(3 - i);
-			assert(brightness < MAX_BRIGHTNESS);
-			out_report.at(i * 2 + out_offsets::STOP1) = brightness;
-			out_report.at(i * 2 + out_offsets::STOP2) = brightness;
-		}
-
-		// ignore first button (has no LED)
-		for (std::size_t i = 1; i < SPECIAL_BUTTONS_NUM; ++i) {
-			const auto& brightness =
-				output_state.special_btns.at(i);
-			assert(brightness < MAX_BRIGHTNESS);
-			out_report.at(i + out_offsets::SPECIAL) = brightness;
-		}
-
-		const auto left_segment =
-			static_cast<std::uint8_t>(output_state.segment_left_char
-			);
-		const auto right_segment = static_cast<std::uint8_t>(
-			output_state.segment_right_char
-		);
-		assert(output_state.segment_left_brightness < MAX_BRIGHTNESS);
-		assert(output_state.segment_right_brightness < MAX_BRIGHTNESS);
-		// ignore first bit (dot segment)
-		for (std::uint8_t i = 1; i < SEGMENTS_PER_DISPLAY; ++i) {
-			const Brightness left =
-				static_cast<std::uint8_t>(
-					(left_segment & (1U << i)) >> i
-				) *
-				output_state.segment_left_brightness;
-			const Brightness right =
-				static_cast<std::uint8_t>(
-					(right_segment & (1U << i)) >> i
-				) *
-				output_state.segment_right_brightness;
-
-			out_report.at(out_offsets::SEGMENT_LEFT + i) = left;
-			out_report.at(out_offsets::SEGMENT_RIGHT + i) = right;
-		}
-
-		assert(output_state.segment_left_dot < MAX_BRIGHTNESS);
-		assert(output_state.segment_right_dot < MAX_BRIGHTNESS);
-		out_report.at(out_offsets::SEGMENT_LEFT) =
-			output_state.segment_left_dot;
-		out_report.at(out_offsets::SEGMENT_RIGHT) =
-			output_state.segment_right_dot;
+		encode_output(output_state, out_report);
 	}
 
 	void generate_input_events()
@@ -234,25 +128,25 @@ public:
 	InputState old_input_state;
 	OutputState output_state;
 
-	std::array<std::uint8_t, INPUT_REPORT_SIZE> in_report{};
-	std::array<std::uint8_t, OUTPUT_REPORT_SIZE> out_report{};
-	std::vector<InputEvent> input_events{};
+	InputReport in_report{};
+	OutputReport out_report{};
+	// Reserved for MAX_INPUT_EVENTS on construction, so it never grows
+	std::pmr::vector<InputEvent> input_events;
 };
 
-F1Device::F1Device(HidDevice&& dev) :
-	p_impl(std::make_unique<Impl>(std::move(dev)))
+F1Device::F1Device(HidDevice&& dev, std::pmr::memory_resource* mem) :
+	p_impl(rt::make_pmr_unique<Impl>(mem, std::move(dev), mem))
 {
 }
 
 F1Device::~F1Device() = default;
 
-void F1Device::read_events(const input_event_handler& hdl)
+std::span<const F1Device::InputEvent> F1Device::read_input_events()
 {
 	read();
 	p_impl->generate_input_events();
-	for (const auto& e : p_impl->input_events) {
-		hdl(e, *this);
-	}
+	assert(p_impl->input_events.size() <= MAX_INPUT_EVENTS);
+	return p_impl->input_events;
 }
 
 const F1Device::InputState& F1Device::read()
@@ -265,8 +159,174 @@ const F1Device::InputState& F1Device::read()
 void F1Device::write()
 {
 	p_impl->update_out_report();
-	p_impl->dev.write({p_impl->out_report.data(), p_impl->out_report.size()}
-	);
+	write(p_impl->out_report);
+}
+
+void F1Device::write(const OutputReport& report)
+{
+	p_impl->dev.write({report.data(), report.size()});
+}
+
+void F1Device::decode_input(const InputReport& report, InputState& state)
+{
+	if (report.at(0) != INPUT_REPORT_ID)
+		return;
+
+	state.report_id = report.at(0);
+
+	for (std::size_t i = 0; i < 2; ++i) {
+		for (std::size_t j = 0; j < 8; ++j) {
+			state.matrix_btns[j + 8 * i] =
+				(((1U << (7U - j)) & report.at(i + 1)) != 0U);
+		}
+	}
+
+	for (std::size_t i = 2; i < 8; ++i) {
+		state.special_btns[i - 2] = (((1U << i) & report.at(3)) != 0U);
+	}
+
+	for (std::size_t i = 1; i < 4; ++i) {
+		state.special_btns[i + 5] = (((1U << i) & report.at(4)) != 0U);
+	}
+
+	for (std::size_t i = 0; i < 4; ++i) {
+		state.stop_btns[i] =
+			(((1U << (4 + (3 - i))) & report.at(4)) != 0U);
+	}
+
+	state.wheel = report.at(5);
+
+	for (std::size_t i = 0; i < 4; ++i) {
+		state.knobs.at(i) =
+			static_cast<std::uint16_t>(report.at(6 + i * 2)) |
+			static_cast<std::uint16_t>(report.at(7 + i * 2) << 8U);
+	}
+
+	for (std::size_t i = 0; i < 4; ++i) {
+		state.faders.at(i) =
+			static_cast<std::uint16_t>(report.at(14 + i * 2)) |
+			static_cast<std::uint16_t>(
+				(report.at(15 + i * 2) & 0xffU) << 8U
+			);
+	}
+}
+
+void F1Device::encode_output(
+	const OutputState& output_state, OutputReport& out_report
+)
+{
+	out_report.fill(0x00U);
+	out_report.at(0) = output_state.report_id;
+
+	for (std::size_t i = 0; i < MATRIX_BUTTONS_NUM; i++) {
+		// F1 uses 7-bit BRG color
+		const auto& [b, r, g] = output_state.matrix_btns.at(i);
+		assert(r < MAX_BRIGHTNESS);
+		assert(g < MAX_BRIGHTNESS);
+		assert(b < MAX_BRIGHTNESS);
+		out_report.at(i * 3 + out_offsets::MATRIX) = b;
+		out_report.at(i * 3 + 1 + out_offsets::MATRIX) = r;
+		out_report.at(i * 3 + 2 + out_offsets::MATRIX) = g;
+	}
+
+	for (std::size_t i = 0; i < STOP_BUTTONS_NUM; ++i) {
+		const auto& brightness = output_state.stop_btns.at(3 - i);
+		assert(brightness < MAX_BRIGHTNESS);
+		out_report.at(i * 2 + out_offsets::STOP1) = brightness;
+		out_report.at(i * 2 + out_offsets::STOP2) = brightness;
+	}
+
+	// ignore first button (has no LED)
+	for (std::size_t i = 1; i < SPECIAL_BUTTONS_NUM; ++i) {
+		const auto& brightness = output_state.special_btns.at(i);
+		assert(brightness < MAX_BRIGHTNESS);
+		out_report.at(i + out_offsets::SPECIAL) = brightness;
+	}
+
+	const auto left_segment =
+		static_cast<std::uint8_t>(output_state.segment_left_char);
+	const auto right_segment =
+		static_cast<std::uint8_t>(output_state.segment_right_char);
+	assert(output_state.segment_left_brightness < MAX_BRIGHTNESS);
+	assert(output_state.segment_right_brightness < MAX_BRIGHTNESS);
+	// ignore first bit (dot segment)
+	for (std::uint8_t i = 1; i < SEGMENTS_PER_DISPLAY; ++i) {
+		const auto left_on =
+			static_cast<std::uint8_t>((left_segment >> i) & 1U);
+		const auto right_on =
+			static_cast<std::uint8_t>((right_segment >> i) & 1U);
+		const Brightness left =
+			left_on * output_state.segment_left_brightness;
+		const Brightness right =
+			right_on * output_state.segment_right_brightness;
+
+		out_report.at(out_offsets::SEGMENT_LEFT + i) = left;
+		out_report.at(out_offsets::SEGMENT_RIGHT + i) = right;
+	}
+
+	assert(output_state.segment_left_dot < MAX_BRIGHTNESS);
+	assert(output_state.segment_right_dot < MAX_BRIGHTNESS);
+	out_report.at(out_offsets::SEGMENT_LEFT) =
+		output_state.segment_left_dot;
+	out_report.at(out_offsets::SEGMENT_RIGHT) =
+		output_state.segment_right_dot;
+}
+
+void F1Device::decode_output(
+	const OutputReport& out_report, OutputState& output_state
+)
+{
+	output_state.report_id = out_report.at(0);
+
+	for (std::size_t i = 0; i < MATRIX_BUTTONS_NUM; i++) {
+		output_state.matrix_btns.at(i) = {
+			out_report.at(i * 3 + out_offsets::MATRIX),
+			out_report.at(i * 3 + 1 + out_offsets::MATRIX),
+			out_report.at(i * 3 + 2 + out_offsets::MATRIX),
+		};
+	}
+
+	for (std::size_t i = 0; i < STOP_BUTTONS_NUM; ++i) {
+		output_state.stop_btns.at(3 - i) =
+			out_report.at(i * 2 + out_offsets::STOP1);
+	}
+
+	output_state.special_btns.at(0) = DARK;
+	for (std::size_t i = 1; i < SPECIAL_BUTTONS_NUM; ++i) {
+		output_state.special_btns.at(i) =
+			out_report.at(i + out_offsets::SPECIAL);
+	}
+
+	std::uint8_t left_segment{0};
+	std::uint8_t right_segment{0};
+	Brightness left_brightness{DARK};
+	Brightness right_brightness{DARK};
+	for (std::uint8_t i = 1; i < SEGMENTS_PER_DISPLAY; ++i) {
+		const Brightness left =
+			out_report.at(out_offsets::SEGMENT_LEFT + i);
+		const Brightness right =
+			out_report.at(out_offsets::SEGMENT_RIGHT + i);
+		left_segment |= static_cast<std::uint8_t>((left != DARK) << i);
+		right_segment |=
+			static_cast<std::uint8_t>((right != DARK) << i);
+		left_brightness = std::max(left_brightness, left);
+		right_brightness = std::max(right_brightness, right);
+	}
+	output_state.segment_left_char = static_cast<SegmentChar>(left_segment);
+	output_state.segment_right_char =
+		static_cast<SegmentChar>(right_segment);
+	output_state.segment_left_brightness = left_brightness;
+	output_state.segment_right_brightness = right_brightness;
+	output_state.segment_left_dot =
+		out_report.at(out_offsets::SEGMENT_LEFT);
+	output_state.segment_right_dot =
+		out_report.at(out_offsets::SEGMENT_RIGHT);
+}
+
+const F1Device::InputReport& F1Device::input_report() const noexcept
+{
+	assert(p_impl);
+	return p_impl->in_report;
 }
 
 F1Device::OutputState& F1Device::output_state() noexcept
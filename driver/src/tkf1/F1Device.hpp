@@ -3,13 +3,16 @@
 #include <array>
 #include <bitset>
 #include <cstddef>
-#include <functional>
 #include <memory>
+#include <memory_resource>
+#include <span>
 #include <tuple>
 #include <variant>
 
 #include <linux/hidraw.h>
 
+#include "rt/Arena.hpp"
+
 class HidDevice;
 
 /**
@@ -74,6 +77,13 @@ public:
 	constexpr static std::size_t KNOBS_NUM{4};
 	constexpr static std::size_t FADERS_NUM{4};
 	constexpr static std::size_t SEGMENTS_PER_DISPLAY{8};
+	/**
+	 * Upper bound of input events generated by a single input report
+	 */
+	constexpr static std::size_t MAX_INPUT_EVENTS{
+		MATRIX_BUTTONS_NUM + SPECIAL_BUTTONS_NUM + STOP_BUTTONS_NUM +
+		KNOBS_NUM + FADERS_NUM + 1
+	};
 
 	constexpr static std::uint8_t WHEEL_MAX{0xffU};
 	constexpr static std::uint16_t KNOBS_MAX{0xfffU};
@@ -158,9 +168,20 @@ clockwise rotation, while negative direction means counterclockwise rotation.
 
 		EventType event_type{EventType::BUTTON};
 		InputType input_type{InputType::MATRIX};
-		std::variant<ButtonEvent, EncoderEvent, WheelEvent> data;
+		std::variant<ButtonEvent, EncoderEvent, WheelEvent> data{
+			ButtonEvent{}
+		};
 	};
 
+	/**
+	 * Raw HID input report, see decode_input()
+	 */
+	using InputReport = std::array<std::uint8_t, INPUT_REPORT_SIZE>;
+	/**
+	 * Raw HID output report, see encode_output()
+	 */
+	using OutputReport = std::array<std::uint8_t, OUTPUT_REPORT_SIZE>;
+
 	struct OutputState {
 		// NOLINTBEGIN(*-magic-numbers)
 		std::uint8_t report_id{OUTPUT_REPORT_ID};
@@ -187,10 +208,17 @@ clockwise rotation, while negative direction means counterclockwise rotation.
 		// NOLINTEND(*-magic-numbers)
 	};
 
-	using input_event_handler =
-		std::function<void(const InputEvent&, F1Device&)>;
-
-	explicit F1Device(HidDevice&& dev);
+	/**
+	 * Create a F1Device for the given HID device
+	 *
+	 * All memory needed by the device is allocated from mem during
+	 * construction. No further allocations happen during the lifetime of
+	 * the object.
+	 */
+	explicit F1Device(
+		HidDevice&& dev,
+		std::pmr::memory_resource* mem = std::pmr::get_default_resource()
+	);
 	F1Device(const F1Device&) = delete;
 	F1Device& operator=(const F1Device&) = delete;
 	F1Device(F1Device&&) noexcept;
@@ -215,8 +243,25 @@ clockwise rotation, while negative direction means counterclockwise rotation.
 	 * This function waits for a change in the input state and calls the
 	 * given input event handler function once for each change in the input
 	 * state, providing a corresponding InputEvent.
+	 *
+	 * The handler is called as hdl(const InputEvent&, F1Device&). It is
+	 * taken as a template parameter instead of a std::function, so calling
+	 * this function never allocates.
+	 */
+	template <typename Handler>
+	void read_events(Handler&& hdl)
+	{
+		for (const auto& e : read_input_events()) {
+			hdl(e, *this);
+		}
+	}
+	/**
+	 * Wait for input and return the generated input events
+	 *
+	 * The returned events are valid until the next call to this function
+	 * or read_events().
 	 */
-	void read_events(const input_event_handler& hdl);
+	std::span<const InputEvent> read_input_events();
 	/**
 	 * Wait for and emit a input event
 	 *
@@ -240,6 +285,12 @@ clockwise rotation, while negative direction means counterclockwise rotation.
 	 * obtained by output_state().
 	 */
 	void write();
+	/**
+	 * Send a precomputed output report to the device
+	 *
+	 * This bypasses the internal output state, which is left unchanged.
+	 */
+	void write(const OutputReport& report);
 
 	/**
 	 * Obtain a reference to the internal output state
@@ -250,6 +301,11 @@ clockwise rotation, while negative direction means counterclockwise rotation.
 	OutputState& output_state() noexcept;
 	[[nodiscard]] const OutputState& output_state() const noexcept;
 
+	/**
+	 * Obtain the last input report read from the device
+	 */
+	[[nodiscard]] const InputReport& input_report() const noexcept;
+
 	/**
 	 * Get the matrix button index of the given x/y coordinates
 	 *
@@ -272,6 +328,34 @@ considers the top left button as (0, 0) and the bottom right button as (3, 3).
 	constexpr static std::pair<std::uint8_t, std::uint8_t>
 		matrix_pos(std::uint8_t);
 
+	/**
+	 * Decode an input report into an input state
+	 *
+	 * This is the decoding used by read(). Reports with a report ID other
+	 * than INPUT_REPORT_ID are ignored and leave the state unchanged.
+	 */
+	static void decode_input(const InputReport& report, InputState& state);
+
+	/**
+	 * Encode an output state into an output report
+	 *
+	 * This is the encoding used by write(). It can be used to prepare
+	 * output reports in advance and send them with write(const
+	 * OutputReport&) later.
+	 */
+	static void
+	encode_output(const OutputState& state, OutputReport& report);
+
+	/**
+	 * Decode an output report into an output state
+	 *
+	 * This is the inverse of encode_output() as far as the report allows:
+	 * A segment display shows each lit segment with the display's
+	 * brightness, so segments of a dark display are lost.
+	 */
+	static void
+	decode_output(const OutputReport& report, OutputState& state);
+
 	/**
 	 * Obtain a human-readable name of a special button index
 	 */
@@ -300,5 +384,5 @@ considers the top left button as (0, 0) and the bottom right button as (3, 3).
 	}
 
 private:
-	std::unique_ptr<Impl> p_impl;
+	rt::pmr_unique_ptr<Impl> p_impl;
 };
@@ -1,11 +1,64 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <bitset>
+#include <concepts>
+#include <cstddef>
+#include <memory>
 #include <optional>
+#include <span>
 
 #include "io/MidiEvent.hpp"
+#include "rt/Rcu.hpp"
+#include "tkf1/Animator.hpp"
 #include "tkf1/F1Device.hpp"
+#include "tkf1/Mapping.hpp"
+
+/**
+ * Threads reading the mapping tables of an IOMapper
+ */
+enum class MappingReader : std::size_t {
+	/**
+	 * The thread processing HID and MIDI events
+	 */
+	EVENTS,
+	/**
+	 * The thread querying animations() and tempo()
+	 */
+	ANIMATION,
+	READERS_NUM,
+};
+
+/**
+ * Mapping tables which can be replaced at runtime
+ *
+ * The table is shared with read-copy-update, so replacing it never blocks
+ * event processing.
+ */
+class RcuMappingTables final
+{
+public:
+	explicit RcuMappingTables(const Mapping& mapping) :
+		rcu(std::make_unique<const MappingTable>(mapping))
+	{
+	}
+
+	[[nodiscard]] auto read(MappingReader reader) noexcept
+	{
+		return rcu.read(static_cast<std::size_t>(reader));
+	}
+
+	void publish(const Mapping& mapping)
+	{
+		rcu.publish(std::make_unique<const MappingTable>(mapping));
+	}
+
+private:
+	rt::Rcu<MappingTable,
+		static_cast<std::size_t>(MappingReader::READERS_NUM)>
+		rcu;
+};
 
 /**
  * Mapper between MIDI and HID
@@ -13,27 +66,51 @@
  * This class is the glue between the MIDI and HID parts of the driver, linking
  * MIDI events to suitable changes to the HID output state and generating MIDI
  * events from HID input events.
+ *
+ * The behavior is configured by a Mapping, which is compiled into a
+ * MappingTable. The mapping can be replaced at any time with set_mapping()
+ * without disturbing concurrent event processing.
+ *
+ * The matrix buttons can be organized in banks (see Mapping::banks_num). The
+ * mapper keeps the LED and toggle state of every bank, so switching banks
+ * just swaps in the cached matrix state of the new bank.
+ *
+ * Notes on the animation channels (see Mapping::animation_channels) animate
+ * the buttons they light. The animated buttons of the current bank can be
+ * queried with animations() to feed an Animator.
+ *
+ * All events, i.e. process_HID_input(), process_MIDI_event() and
+ * process_MIDI_sysex(), must be processed by one thread, which owns the bank
+ * state. animations() and tempo() may be called concurrently from one other
+ * thread.
+ *
+ * The mapping tables are provided by Tables, which is RcuMappingTables for the
+ * runtime-configurable IOMapper. StaticIOMapper uses a table compiled at
+ * compile time instead (see StaticIOMapper.hpp).
  */
-class IOMapper final
+template <typename Tables>
+class BasicIOMapper final
 {
 public:
 	using byte = MidiEvent::byte;
+	using BrightnessMode = Mapping::BrightnessMode;
+	using ButtonMask = MappingTable::ButtonMask;
 
-	constexpr static F1Device::ButtonColor WHITE = F1Device::WHITE;
 	constexpr static byte MIDI_MAX{127U};
 
-	IOMapper() = default;
-	IOMapper(const IOMapper&) = default;
-	IOMapper& operator=(const IOMapper&) = default;
-	IOMapper(IOMapper&&) = default;
-	IOMapper& operator=(IOMapper&&) = default;
-	~IOMapper() = default;
-
-	enum BrightnessMode {
-		MIDI_NOTE,
-		MIDI_CC,
-		HID,
-	};
+	explicit BasicIOMapper(const Mapping& mapping = {})
+		requires std::constructible_from<Tables, const Mapping&>
+		: table(mapping)
+	{
+	}
+	BasicIOMapper()
+		requires(!std::constructible_from<Tables, const Mapping&>)
+	= default;
+	BasicIOMapper(const BasicIOMapper&) = delete;
+	BasicIOMapper& operator=(const BasicIOMapper&) = delete;
+	BasicIOMapper(BasicIOMapper&&) = delete;
+	BasicIOMapper& operator=(BasicIOMapper&&) = delete;
+	~BasicIOMapper() = default;
 
 	/**
 	 * Process a HID input event
@@ -55,193 +132,95 @@ public:
 	bool process_MIDI_event(
 		const MidiEvent& event, F1Device::OutputState& output_state
 	);
-
-	// NOLINTBEGIN(*-magic-numbers,*-private-member-variables-in-classes)
 	/**
-	 * @name Mapper configuration
-	 *
-	 * These structs can be freely modified to configure the drivers
-	 * behavior.
+	 * Process a MIDI SysEx message
 	 *
-	 * @{
-	 */
-	/**
-	 * Control which buttons are toggle buttons
-	 */
-	struct {
-		std::bitset<F1Device::MATRIX_BUTTONS_NUM> matrix{};
-		std::bitset<F1Device::SPECIAL_BUTTONS_NUM> special{};
-		std::bitset<F1Device::STOP_BUTTONS_NUM> stop{};
-	} button_toggle;
-	/**
-	 * Configuration of note values to emit for buttons
-	 */
-	struct {
-		std::array<byte, F1Device::MATRIX_BUTTONS_NUM> matrix{
-			MidiEvent::note_from_name_c("C1"),
-			MidiEvent::note_from_name_c("C#1"),
-			MidiEvent::note_from_name_c("D1"),
-			MidiEvent::note_from_name_c("D#1"),
-			MidiEvent::note_from_name_c("E1"),
-			MidiEvent::note_from_name_c("F1"),
-			MidiEvent::note_from_name_c("F#1"),
-			MidiEvent::note_from_name_c("G1"),
-			MidiEvent::note_from_name_c("G#1"),
-			MidiEvent::note_from_name_c("A1"),
-			MidiEvent::note_from_name_c("A#1"),
-			MidiEvent::note_from_name_c("B1"),
-			MidiEvent::note_from_name_c("C2"),
-			MidiEvent::note_from_name_c("C#2"),
-			MidiEvent::note_from_name_c("D2"),
-			MidiEvent::note_from_name_c("D#2"),
-		};
-		std::array<byte, F1Device::SPECIAL_BUTTONS_NUM> special{
-			MidiEvent::note_from_name_c("E2"),
-			MidiEvent::note_from_name_c("F2"),
-			MidiEvent::note_from_name_c("F#2"),
-			MidiEvent::note_from_name_c("G2"),
-			MidiEvent::note_from_name_c("G#2"),
-			MidiEvent::note_from_name_c("A2"),
-			MidiEvent::note_from_name_c("A#2"),
-			MidiEvent::note_from_name_c("B2"),
-			MidiEvent::note_from_name_c("C3"),
-		};
-		std::array<byte, F1Device::STOP_BUTTONS_NUM> stop{
-			MidiEvent::note_from_name_c("C#3"),
-			MidiEvent::note_from_name_c("D3"),
-			MidiEvent::note_from_name_c("D#3"),
-			MidiEvent::note_from_name_c("E3"),
-		};
-	} notes;
-	/**
-	 * Configuration of controller values to emit for encoders
+	 * LED frames (see LedFrame) are applied to the output state and to the
+	 * cached state of the current bank, other messages are ignored. The
+	 * returned boolean indicates whether a change to the output state has
+	 * occured.
 	 */
-	struct {
-		std::array<byte, F1Device::KNOBS_NUM> knobs{33, 34, 35, 36};
-		std::array<byte, F1Device::FADERS_NUM> faders{37, 38, 39, 40};
-		byte wheel{41};
-	} controllers;
+	bool process_MIDI_sysex(
+		std::span<const byte> msg, F1Device::OutputState& output_state
+	);
 
 	/**
-	 * Value emitted by the wheel for a counterclockwise turn
+	 * Replace the mapping
+	 *
+	 * The mapping is compiled and published atomically: Each event is
+	 * processed either entirely with the old or entirely with the new
+	 * mapping. This blocks until no event is processed with the old
+	 * mapping anymore, so it must not be called from the thread processing
+	 * events or the one calling animations().
+	 *
+	 * This is only available if the tables can be replaced.
 	 */
-	byte wheel_dec_value{0x00};
+	void set_mapping(const Mapping& mapping)
+		requires requires(Tables& t, const Mapping& m) { t.publish(m); }
+	{
+		table.publish(mapping);
+	}
+
 	/**
-	 * Value emitted by the wheel for a clockwise turn
+	 * Show the state of the current bank
+	 *
+	 * This copies the cached matrix state of the current bank to the
+	 * output state and shows the bank number on the segment display. It
+	 * should be called once before processing any events, from the thread
+	 * processing them or before it starts.
 	 */
-	byte wheel_inc_value{0x7f};
+	void init_output(F1Device::OutputState& output_state);
 
 	/**
-	 * Control button brightness mode
-	 *
-	 * If a button's mode is MIDI_NOTE, it is controlled by a MIDI event
-	 * with the same note number as the event emitted when pressing the
-	 * corresponding button. If the button's mode is HID, it is solely
-	 * controlled by the HID input, i.e. pressing the button uses high
-	 * brightness, while releasing it uses low brightness.
-	 *
-	 * The MIDI_CC mode allows for fine grained control of the button
-	 * brightess with MIDI CC events. The corresponding CC numbers can be
-	 * configured in brightness_controllers.
+	 * Get the index of the current bank, starting at 0
 	 */
-	struct {
-		std::array<BrightnessMode, F1Device::MATRIX_BUTTONS_NUM> matrix{
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-		};
-		std::array<BrightnessMode, F1Device::SPECIAL_BUTTONS_NUM>
-			special{
-				BrightnessMode::HID,
-				BrightnessMode::HID,
-				BrightnessMode::HID,
-				BrightnessMode::HID,
-				BrightnessMode::HID,
-				BrightnessMode::HID,
-				BrightnessMode::HID,
-				BrightnessMode::HID,
-				BrightnessMode::HID,
-			};
-		std::array<BrightnessMode, F1Device::STOP_BUTTONS_NUM> stop{
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-			BrightnessMode::HID,
-		};
-	} brightness_mode;
+	[[nodiscard]] std::size_t current_bank() const noexcept;
+
 	/**
-	 * Set brightness controllers
-	 *
-	 * If, for any button, its brightness mode is MIDI_CC, the controller
-	 * number that should control the brightness is set in this struct.
+	 * Get the animated buttons of the current bank
 	 */
-	struct {
-		std::array<byte, F1Device::MATRIX_BUTTONS_NUM> matrix{
-			// clang-format off
-			70, 71, 72, 73,
-			74, 75, 76, 77,
-			78, 79, 80, 81,
-			82, 83, 84, 85,
-			// clang-format on
-		};
-		std::array<byte, F1Device::SPECIAL_BUTTONS_NUM> special{
-			86, 87, 88, 89, 90, 91, 92, 93, 94
-		};
-		std::array<byte, F1Device::STOP_BUTTONS_NUM> stop{
-			102, 103, 104, 105
-		};
-	} brightness_controllers;
+	[[nodiscard]] Animator::Animations animations();
 
 	/**
-	 * Colors of the matrix buttons
+	 * Get the tempo sync settings
 	 *
-	 * This color is multiplied with the brightness factor to obtain the
-	 * actual color value.
+	 * This must only be called from the thread calling animations().
 	 */
-	std::array<F1Device::ButtonColor, F1Device::MATRIX_BUTTONS_NUM>
-		matrix_colors{
-			// clang-format off
-			WHITE, WHITE, WHITE, WHITE,
-			WHITE, WHITE, WHITE, WHITE,
-			WHITE, WHITE, WHITE, WHITE,
-			WHITE, WHITE, WHITE, WHITE,
-			// clang-format on
-		};
+	[[nodiscard]] Mapping::Tempo tempo();
 
-	float brightness_low_color{0.2F};
-	float brightness_high_color{1.F};
-	F1Device::Brightness brightness_low{0x29};
-	F1Device::Brightness brightness_high{0x7f};
+private:
+	using Brightness = F1Device::Brightness;
+	using InputType = F1Device::InputEvent::InputType;
+	using ButtonEvent = F1Device::InputEvent::ButtonEvent;
+	using EncoderEvent = F1Device::InputEvent::EncoderEvent;
+	using WheelEvent = F1Device::InputEvent::WheelEvent;
 
-	byte out_channel{0};
-	byte in_channel{1};
-	byte note_on_velocity{127};
-	byte note_off_velocity{0};
-	// NOLINTEND(*-magic-numbers,*-private-member-variables-in-classes)
+	using AnimationMasks =
+		std::array<std::atomic<ButtonMask>, Mapping::ANIMATIONS_NUM>;
 
-private:
-	template <
-		F1Device::InputEvent::EventType,
-		F1Device::InputEvent::InputType>
-	std::optional<MidiEvent> process_HID_input_impl(
-		const F1Device::InputEvent& event, F1Device::OutputState& output
+	std::optional<MidiEvent> process_HID_matrix(
+		const MappingTable& table,
+		const F1Device::InputEvent::ButtonEvent& button,
+		F1Device::OutputState& output
+	);
+	std::optional<MidiEvent> process_HID_special(
+		const MappingTable& table,
+		const F1Device::InputEvent::ButtonEvent& button,
+		F1Device::OutputState& output
+	);
+	std::optional<MidiEvent> process_HID_stop(
+		const MappingTable& table,
+		const F1Device::InputEvent::ButtonEvent& button,
+		F1Device::OutputState& output
+	);
+	static MidiEvent process_HID_wheel(
+		const MappingTable& table,
+		const F1Device::InputEvent::WheelEvent& wheel
 	);
 
 	template <std::size_t btn_size>
 	std::pair<std::optional<MidiEvent>, bool> process_HID_input_button(
+		const Mapping& mapping,
 		const F1Device::InputEvent::ButtonEvent& button,
 		const std::bitset<btn_size>& button_toggle,
 		const std::array<byte, btn_size>& notes,
@@ -250,57 +229,143 @@ private:
 
 	template <std::size_t enc_size>
 	std::optional<MidiEvent> process_HID_input_encoder(
+		const Mapping& mapping,
 		const F1Device::InputEvent::EncoderEvent& encoder,
 		const std::array<byte, enc_size>& controllers,
+		const std::array<MappingTable::EncoderTable, enc_size>& values,
 		std::array<byte, F1Device::FADERS_NUM>& last_input
 	);
 
-	template <std::size_t btn_size>
-	bool process_MIDI_event_CC(
-		const MidiEvent& event,
-		std::array<byte, btn_size>& output,
-		std::size_t idx,
-		const std::array<byte, btn_size>& brightness_controllers
+	bool set_buttons_note(
+		const MappingTable& table,
+		F1Device::OutputState& output,
+		std::size_t bank,
+		ButtonMask buttons,
+		bool on,
+		byte velocity
 	);
-
-	template <std::size_t btn_size>
-	bool process_MIDI_event_CC(
-		const MidiEvent& event,
-		std::array<F1Device::ButtonColor, btn_size>& output,
-		std::size_t idx,
-		const std::array<byte, btn_size>& brightness_controllers
+	bool set_buttons_cc(
+		const MappingTable& table,
+		F1Device::OutputState& output,
+		std::size_t bank,
+		ButtonMask buttons,
+		byte value
 	);
-
-	template <std::size_t btn_size>
-	bool process_MIDI_event_note(
-		const MidiEvent& event,
-		std::array<byte, btn_size>& output,
+	/**
+	 * Set the animation of the given buttons, or stop animating them
+	 */
+	void animate_buttons(
+		std::size_t bank,
+		ButtonMask buttons,
+		std::optional<Mapping::Animation> animation
+	);
+	bool set_matrix_button(
+		F1Device::OutputState& output,
+		std::size_t bank,
 		std::size_t idx,
-		const std::array<byte, btn_size>& notes
+		const F1Device::ButtonColor& color
 	);
 
-	template <std::size_t btn_size>
-	bool process_MIDI_event_note(
-		const MidiEvent& event,
-		std::array<F1Device::ButtonColor, btn_size>& output,
-		std::size_t idx,
-		const std::array<byte, btn_size>& notes
+	/**
+	 * Get the active bank, limited to the banks of the given table
+	 */
+	std::size_t valid_bank(const MappingTable& table) const noexcept;
+	void switch_bank(
+		const MappingTable& table,
+		F1Device::OutputState& output,
+		std::size_t bank
+	);
+	static void show_bank(
+		const MappingTable& table,
+		F1Device::OutputState& output,
+		std::size_t bank
 	);
 
 	void button_light_matrix_HID(
-		F1Device::OutputState& output, byte idx, bool on
+		const MappingTable& table,
+		F1Device::OutputState& output,
+		std::size_t bank,
+		byte idx,
+		bool on
 	);
-	void button_light_special_HID(
-		F1Device::OutputState& output, byte idx, bool on
+	static void button_light_special_HID(
+		const MappingTable& table,
+		F1Device::OutputState& output,
+		byte idx,
+		bool on
 	);
-	void
-	button_light_stop_HID(F1Device::OutputState& output, byte idx, bool on);
+	static void button_light_stop_HID(
+		const MappingTable& table,
+		F1Device::OutputState& output,
+		byte idx,
+		bool on
+	);
+
+	/**
+	 * Set the brightness of a special or stop button in a ButtonMask
+	 */
+	static void set_button_brightness(
+		F1Device::OutputState& output,
+		std::size_t button,
+		F1Device::Brightness brightness
+	);
+	/**
+	 * Get the animation of a MIDI channel
+	 *
+	 * The input channel is never an animation channel.
+	 */
+	static std::optional<Mapping::Animation>
+	channel_animation(const Mapping& mapping, byte channel);
+
+	Tables table;
+
+	struct Bank {
+		/**
+		 * Cached LED state of the matrix buttons
+		 */
+		std::array<F1Device::ButtonColor, F1Device::MATRIX_BUTTONS_NUM>
+			matrix_btns{};
+		/**
+		 * Last input (or toggle) state of the matrix buttons
+		 */
+		std::bitset<F1Device::MATRIX_BUTTONS_NUM> matrix_input{};
+		/**
+		 * Animated matrix buttons, one mask per animation
+		 */
+		AnimationMasks animations{};
+	};
+
+	std::array<Bank, Mapping::MAX_BANKS> banks{};
+	/**
+	 * Index of the bank shown on the device
+	 *
+	 * Only changed by the thread processing events, it is atomic just
+	 * because animations() reads it concurrently.
+	 */
+	std::atomic<std::size_t> active_bank{0};
+	/**
+	 * Bank in which each matrix button has been pressed last
+	 *
+	 * Releasing a button emits its event in the bank it has been pressed
+	 * in, even if the bank has been switched in the meantime.
+	 */
+	std::array<std::size_t, F1Device::MATRIX_BUTTONS_NUM> pressed_bank{};
+	/**
+	 * Animated special and stop buttons, which are shared by all banks
+	 */
+	AnimationMasks shared_animations{};
 
 	struct {
-		std::bitset<F1Device::MATRIX_BUTTONS_NUM> matrix{};
 		std::bitset<F1Device::SPECIAL_BUTTONS_NUM> special{};
 		std::bitset<F1Device::STOP_BUTTONS_NUM> stop{};
 		std::array<byte, F1Device::FADERS_NUM> fader{};
 		std::array<byte, F1Device::KNOBS_NUM> knob{};
 	} last_input;
 };
+
+/**
+ * Runtime-configurable mapper between MIDI and HID
+ */
+using IOMapper = BasicIOMapper<RcuMappingTables>;
+
+extern template class BasicIOMapper<RcuMappingTables>;
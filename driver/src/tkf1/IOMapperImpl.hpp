@@ -0,0 +1,578 @@
+/**
+ * @file
+ *
+ * Implementation of BasicIOMapper
+ *
+ * This is only included by IOMapper.cpp, which instantiates the runtime
+ * configurable IOMapper, and by StaticIOMapper.hpp.
+ */
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <optional>
+#include <span>
+#include <variant>
+
+#include "io/MidiEvent.hpp"
+#include "tkf1/F1Device.hpp"
+#include "tkf1/IOMapper.hpp"
+#include "tkf1/LedFrame.hpp"
+
+template <typename Tables>
+void BasicIOMapper<Tables>::set_button_brightness(
+	F1Device::OutputState& output, std::size_t button, Brightness brightness
+)
+{
+	if (button < MappingTable::STOP_SHIFT) {
+		output.special_btns[button - MappingTable::SPECIAL_SHIFT] =
+			brightness;
+	} else {
+		output.stop_btns[button - MappingTable::STOP_SHIFT] =
+			brightness;
+	}
+}
+
+template <typename Tables>
+std::optional<Mapping::Animation>
+BasicIOMapper<Tables>::channel_animation(const Mapping& mapping, byte channel)
+{
+	if (channel == mapping.in_channel)
+		return std::nullopt;
+	for (std::size_t a = 0; a < Mapping::ANIMATIONS_NUM; ++a) {
+		if (mapping.animation_channels[a] == channel)
+			return static_cast<Mapping::Animation>(a);
+	}
+	return std::nullopt;
+}
+
+template <typename Tables>
+void BasicIOMapper<Tables>::init_output(F1Device::OutputState& output_state)
+{
+	const auto t = table.read(MappingReader::EVENTS);
+	const std::size_t bank = valid_bank(*t);
+	output_state.matrix_btns = banks[bank].matrix_btns;
+	show_bank(*t, output_state, bank);
+}
+
+template <typename Tables>
+std::size_t BasicIOMapper<Tables>::current_bank() const noexcept
+{
+	return active_bank.load();
+}
+
+template <typename Tables>
+Animator::Animations BasicIOMapper<Tables>::animations()
+{
+	const auto t = table.read(MappingReader::ANIMATION);
+	const auto& bank = banks[active_bank.load()];
+
+	Animator::Animations res{};
+	res.period = t->config.animation_period;
+	for (std::size_t a = 0; a < Mapping::ANIMATIONS_NUM; ++a) {
+		res.buttons[a] = shared_animations[a].load() |
+				 bank.animations[a].load();
+	}
+	return res;
+}
+
+template <typename Tables>
+Mapping::Tempo BasicIOMapper<Tables>::tempo()
+{
+	const auto t = table.read(MappingReader::ANIMATION);
+	return t->config.tempo;
+}
+
+template <typename Tables>
+std::optional<MidiEvent> BasicIOMapper<Tables>::process_HID_input(
+	const F1Device::InputEvent& event, F1Device::OutputState& output
+)
+{
+	const auto t = table.read(MappingReader::EVENTS);
+
+	switch (event.input_type) {
+	case InputType::MATRIX:
+		return process_HID_matrix(
+			*t, std::get<ButtonEvent>(event.data), output
+		);
+	case InputType::SPECIAL:
+		return process_HID_special(
+			*t, std::get<ButtonEvent>(event.data), output
+		);
+	case InputType::STOP:
+		return process_HID_stop(
+			*t, std::get<ButtonEvent>(event.data), output
+		);
+	case InputType::FADER:
+		return process_HID_input_encoder(
+			t->config,
+			std::get<EncoderEvent>(event.data),
+			t->config.controllers.faders,
+			t->fader_values,
+			last_input.fader
+		);
+	case InputType::KNOB:
+		return process_HID_input_encoder(
+			t->config,
+			std::get<EncoderEvent>(event.data),
+			t->config.controllers.knobs,
+			t->knob_values,
+			last_input.knob
+		);
+	case InputType::WHEEL:
+		return process_HID_wheel(*t, std::get<WheelEvent>(event.data));
+	}
+
+	return {};
+}
+
+template <typename Tables>
+std::optional<MidiEvent> BasicIOMapper<Tables>::process_HID_matrix(
+	const MappingTable& table,
+	const ButtonEvent& button,
+	F1Device::OutputState& output
+)
+{
+	const auto& mapping = table.config;
+	const byte idx = button.index;
+	assert(idx < F1Device::MATRIX_BUTTONS_NUM);
+	if (button.button_press) {
+		pressed_bank[idx] = valid_bank(table);
+	}
+	const std::size_t bank = pressed_bank[idx];
+
+	auto [midi_event, button_on] = process_HID_input_button(
+		mapping,
+		button,
+		mapping.button_toggle.matrix,
+		mapping.banks[bank].notes,
+		banks[bank].matrix_input
+	);
+	if (midi_event) {
+		button_light_matrix_HID(table, output, bank, idx, button_on);
+	}
+
+	return midi_event;
+}
+
+template <typename Tables>
+std::optional<MidiEvent> BasicIOMapper<Tables>::process_HID_special(
+	const MappingTable& table,
+	const ButtonEvent& button,
+	F1Device::OutputState& output
+)
+{
+	const auto& mapping = table.config;
+	const byte idx = button.index;
+	assert(idx < F1Device::SPECIAL_BUTTONS_NUM);
+	const bool is_prev = idx == mapping.bank_prev_button;
+	const bool is_next = idx == mapping.bank_next_button;
+	if (mapping.banks_num > 1 && (is_prev || is_next)) {
+		if (button.button_press) {
+			const std::size_t num = mapping.banks_num;
+			const std::size_t bank = valid_bank(table);
+			const std::size_t step = is_next ? 1 : num - 1;
+			switch_bank(table, output, (bank + step) % num);
+		}
+		output.special_btns[idx] = button.button_press
+						      ? mapping.brightness_high
+						      : mapping.brightness_low;
+		return {};
+	}
+
+	auto [midi_event, button_on] = process_HID_input_button(
+		mapping,
+		button,
+		mapping.button_toggle.special,
+		mapping.notes.special,
+		last_input.special
+	);
+	if (midi_event) {
+		button_light_special_HID(
+			table, output, button.index, button_on
+		);
+	}
+
+	return midi_event;
+}
+
+template <typename Tables>
+std::optional<MidiEvent> BasicIOMapper<Tables>::process_HID_stop(
+	const MappingTable& table,
+	const ButtonEvent& button,
+	F1Device::OutputState& output
+)
+{
+	const auto& mapping = table.config;
+	assert(button.index < F1Device::STOP_BUTTONS_NUM);
+	auto [midi_event, button_on] = process_HID_input_button(
+		mapping,
+		button,
+		mapping.button_toggle.stop,
+		mapping.notes.stop,
+		last_input.stop
+	);
+	if (midi_event) {
+		button_light_stop_HID(table, output, button.index, button_on);
+	}
+
+	return midi_event;
+}
+
+template <typename Tables>
+MidiEvent BasicIOMapper<Tables>::process_HID_wheel(
+	const MappingTable& table, const WheelEvent& wheel
+)
+{
+	const auto& mapping = table.config;
+	return MidiEvent{
+		MidiEvent::Type::CONTROL_CHANGE,
+		mapping.out_channel,
+		mapping.controllers.wheel,
+		wheel.direction > 0 ? mapping.wheel_inc_value
+				    : mapping.wheel_dec_value
+	};
+}
+
+template <typename Tables>
+bool BasicIOMapper<Tables>::process_MIDI_event(
+	const MidiEvent& event, F1Device::OutputState& output_state
+)
+{
+	const auto t = table.read(MappingReader::EVENTS);
+
+	const auto animation = channel_animation(t->config, event.channel);
+	const bool input_channel = event.channel == t->config.in_channel;
+	if (not input_channel && not animation)
+		return false;
+
+	const std::size_t banks_num = t->config.banks_num;
+	bool changed{false};
+	// NOLINTBEGIN(*-union-access)
+	switch (event.type) {
+	case MidiEvent::Type::NOTE_ON:
+	case MidiEvent::Type::NOTE_OFF: {
+		const byte note = event.data.note.note;
+		const bool on = event.type == MidiEvent::Type::NOTE_ON;
+		const byte velocity = on ? event.data.note.velocity : 0;
+		assert(note < MappingTable::MIDI_VALUES_NUM);
+		for (std::size_t bank = 0; bank < banks_num; ++bank) {
+			// special and stop buttons are the same in all banks
+			auto buttons = t->note_buttons[bank][note];
+			if (bank != 0)
+				buttons &= MappingTable::MATRIX_MASK;
+			animate_buttons(
+				bank, buttons, on ? animation : std::nullopt
+			);
+			changed |= set_buttons_note(
+				*t, output_state, bank, buttons, on, velocity
+			);
+		}
+		break;
+	}
+
+	case MidiEvent::Type::CONTROL_CHANGE: {
+		if (not input_channel)
+			break;
+
+		const byte controller = event.data.controller.controller;
+		const byte value = event.data.controller.value;
+		assert(controller < MappingTable::MIDI_VALUES_NUM);
+		for (std::size_t bank = 0; bank < banks_num; ++bank) {
+			auto buttons = t->cc_buttons[bank][controller];
+			if (bank != 0)
+				buttons &= MappingTable::MATRIX_MASK;
+			changed |= set_buttons_cc(
+				*t, output_state, bank, buttons, value
+			);
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+	// NOLINTEND(*-union-access)
+
+	return changed;
+}
+
+template <typename Tables>
+bool BasicIOMapper<Tables>::process_MIDI_sysex(
+	std::span<const byte> msg, F1Device::OutputState& output_state
+)
+{
+	if (not LedFrame::apply(msg, output_state))
+		return false;
+
+	banks[active_bank.load()].matrix_btns = output_state.matrix_btns;
+	return true;
+}
+
+template <typename Tables>
+template <std::size_t btn_size>
+std::pair<std::optional<MidiEvent>, bool>
+BasicIOMapper<Tables>::process_HID_input_button(
+	const Mapping& mapping,
+	const ButtonEvent& button,
+	const std::bitset<btn_size>& button_toggle,
+	const std::array<byte, btn_size>& notes,
+	std::bitset<btn_size>& last_input
+)
+{
+	const byte idx = button.index;
+
+	// toggle
+	if (button_toggle[idx] and button.button_press) {
+		const MidiEvent::Type event_type =
+			last_input[idx] ? MidiEvent::Type::NOTE_OFF
+					: MidiEvent::Type::NOTE_ON;
+		last_input[idx] = not last_input[idx];
+
+		return {MidiEvent{
+				event_type,
+				mapping.out_channel,
+				notes[idx],
+				event_type == MidiEvent::Type::NOTE_ON
+					? mapping.note_on_velocity
+					: mapping.note_off_velocity
+			},
+			last_input[idx]};
+	}
+
+	if (button_toggle[idx] and not button.button_press) {
+		return {};
+	}
+
+	// no toggle
+	const MidiEvent::Type event_type = button.button_press
+						   ? MidiEvent::Type::NOTE_ON
+						   : MidiEvent::Type::NOTE_OFF;
+	last_input[idx] = button.button_press;
+	return {MidiEvent{
+			event_type,
+			mapping.out_channel,
+			notes[idx],
+			event_type == MidiEvent::Type::NOTE_ON
+				? mapping.note_on_velocity
+				: mapping.note_off_velocity
+		},
+		button.button_press};
+}
+
+template <typename Tables>
+template <std::size_t enc_size>
+std::optional<MidiEvent> BasicIOMapper<Tables>::process_HID_input_encoder(
+	const Mapping& mapping,
+	const EncoderEvent& encoder,
+	const std::array<byte, enc_size>& controllers,
+	const std::array<MappingTable::EncoderTable, enc_size>& values,
+	std::array<byte, F1Device::FADERS_NUM>& last_input
+)
+{
+	const byte idx = encoder.index;
+	assert(idx < enc_size);
+	const std::size_t pos = std::min(encoder.value, F1Device::FADERS_MAX);
+	const byte val = values[idx][pos];
+
+	if (val == last_input[idx])
+		return {};
+
+	last_input[idx] = val;
+	return MidiEvent{
+		MidiEvent::Type::CONTROL_CHANGE,
+		mapping.out_channel,
+		controllers[idx],
+		val
+	};
+}
+
+template <typename Tables>
+bool BasicIOMapper<Tables>::set_buttons_note(
+	const MappingTable& table,
+	F1Device::OutputState& output,
+	std::size_t bank,
+	ButtonMask buttons,
+	bool on,
+	byte velocity
+)
+{
+	const auto& mapping = table.config;
+	const auto& colors = on ? table.matrix_high : table.matrix_low;
+	assert(velocity < Mapping::PALETTE_SIZE);
+	const auto& palette_color = table.palette[velocity];
+	const Brightness brightness =
+		on ? mapping.brightness_high : mapping.brightness_low;
+
+	bool changed{false};
+	for (auto mask = buttons; mask != 0; mask &= mask - 1) {
+		const std::size_t button = std::countr_zero(mask);
+		if (button >= MappingTable::SPECIAL_SHIFT) {
+			set_button_brightness(output, button, brightness);
+			changed = true;
+			continue;
+		}
+
+		const std::size_t idx = button - MappingTable::MATRIX_SHIFT;
+		const auto& color =
+			mapping.use_palette ? palette_color : colors[idx];
+		changed |= set_matrix_button(output, bank, idx, color);
+	}
+	return changed;
+}
+
+template <typename Tables>
+bool BasicIOMapper<Tables>::set_buttons_cc(
+	const MappingTable& table,
+	F1Device::OutputState& output,
+	std::size_t bank,
+	ButtonMask buttons,
+	byte value
+)
+{
+	assert(value < MappingTable::MIDI_VALUES_NUM);
+	const Brightness brightness = table.cc_brightness[value];
+
+	bool changed{false};
+	for (auto mask = buttons; mask != 0; mask &= mask - 1) {
+		const std::size_t button = std::countr_zero(mask);
+		if (button >= MappingTable::SPECIAL_SHIFT) {
+			set_button_brightness(output, button, brightness);
+			changed = true;
+			continue;
+		}
+
+		const std::size_t idx = button - MappingTable::MATRIX_SHIFT;
+		const auto& color = table.matrix_cc[idx][value];
+		changed |= set_matrix_button(output, bank, idx, color);
+	}
+	return changed;
+}
+
+template <typename Tables>
+void BasicIOMapper<Tables>::animate_buttons(
+	std::size_t bank,
+	ButtonMask buttons,
+	std::optional<Mapping::Animation> animation
+)
+{
+	const ButtonMask matrix = buttons & MappingTable::MATRIX_MASK;
+	const ButtonMask shared = buttons & ~MappingTable::MATRIX_MASK;
+	for (std::size_t a = 0; a < Mapping::ANIMATIONS_NUM; ++a) {
+		auto& bank_mask = banks[bank].animations[a];
+		auto& shared_mask = shared_animations[a];
+		if (animation == a) {
+			bank_mask.fetch_or(matrix);
+			shared_mask.fetch_or(shared);
+		} else {
+			bank_mask.fetch_and(~matrix);
+			shared_mask.fetch_and(~shared);
+		}
+	}
+}
+
+template <typename Tables>
+bool BasicIOMapper<Tables>::set_matrix_button(
+	F1Device::OutputState& output,
+	std::size_t bank,
+	std::size_t idx,
+	const F1Device::ButtonColor& color
+)
+{
+	assert(bank < Mapping::MAX_BANKS);
+	assert(idx < F1Device::MATRIX_BUTTONS_NUM);
+	banks[bank].matrix_btns[idx] = color;
+	if (bank != active_bank.load())
+		return false;
+
+	output.matrix_btns[idx] = color;
+	return true;
+}
+
+template <typename Tables>
+std::size_t
+BasicIOMapper<Tables>::valid_bank(const MappingTable& table) const noexcept
+{
+	return std::min(active_bank.load(), table.config.banks_num - 1);
+}
+
+template <typename Tables>
+void BasicIOMapper<Tables>::switch_bank(
+	const MappingTable& table,
+	F1Device::OutputState& output,
+	std::size_t bank
+)
+{
+	active_bank.store(bank);
+	output.matrix_btns = banks[bank].matrix_btns;
+	show_bank(table, output, bank);
+}
+
+template <typename Tables>
+void BasicIOMapper<Tables>::show_bank(
+	const MappingTable& table,
+	F1Device::OutputState& output,
+	std::size_t bank
+)
+{
+	if (table.config.banks_num <= 1)
+		return;
+
+	const auto [left, right] =
+		F1Device::num_to_segments(static_cast<std::uint8_t>(bank + 1));
+	output.segment_left_char = left;
+	output.segment_right_char = right;
+	output.segment_left_brightness = table.config.brightness_high;
+	output.segment_right_brightness = table.config.brightness_high;
+}
+
+template <typename Tables>
+void BasicIOMapper<Tables>::button_light_matrix_HID(
+	const MappingTable& table,
+	F1Device::OutputState& output,
+	std::size_t bank,
+	byte idx,
+	bool on
+)
+{
+	if (table.config.brightness_mode.matrix[idx] != BrightnessMode::HID)
+		return;
+
+	const auto& colors = on ? table.matrix_high : table.matrix_low;
+	set_matrix_button(output, bank, idx, colors[idx]);
+}
+
+template <typename Tables>
+void BasicIOMapper<Tables>::button_light_special_HID(
+	const MappingTable& table,
+	F1Device::OutputState& output,
+	byte idx,
+	bool on
+)
+{
+	const auto& mapping = table.config;
+	if (mapping.brightness_mode.special[idx] != BrightnessMode::HID)
+		return;
+
+	const Brightness brightness =
+		on ? mapping.brightness_high : mapping.brightness_low;
+	output.special_btns[idx] = brightness;
+}
+
+template <typename Tables>
+void BasicIOMapper<Tables>::button_light_stop_HID(
+	const MappingTable& table,
+	F1Device::OutputState& output,
+	byte idx,
+	bool on
+)
+{
+	const auto& mapping = table.config;
+	if (mapping.brightness_mode.stop[idx] != BrightnessMode::HID)
+		return;
+
+	const Brightness brightness =
+		on ? mapping.brightness_high : mapping.brightness_low;
+	output.stop_btns[idx] = brightness;
+}
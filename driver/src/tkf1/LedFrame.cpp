@@ -0,0 +1,140 @@
+#include <algorithm>
+
+#include "LedFrame.hpp"
+
+using Brightness = F1Device::Brightness;
+using SegmentChar = F1Device::SegmentChar;
+using byte = LedFrame::byte;
+
+namespace
+{
+constexpr std::size_t COLOR_COMPONENTS{3};
+constexpr std::size_t SEGMENT_SLOTS{3};
+
+byte segments_to_slot(SegmentChar segments)
+{
+	return static_cast<byte>(static_cast<byte>(segments) >> 1U);
+}
+
+SegmentChar slot_to_segments(byte value)
+{
+	return static_cast<SegmentChar>(static_cast<byte>(value << 1U));
+}
+} // namespace
+
+bool LedFrame::is_led_frame(std::span<const byte> msg) noexcept
+{
+	return msg.size() > HEADER.size() &&
+	       std::equal(HEADER.begin(), HEADER.end(), msg.begin());
+}
+
+bool LedFrame::apply(
+	std::span<const byte> msg, F1Device::OutputState& state
+) noexcept
+{
+	if (not is_led_frame(msg) || msg.back() != SYSEX_END)
+		return false;
+
+	const auto runs =
+		msg.subspan(HEADER.size(), msg.size() - HEADER.size() - 1);
+	for (std::size_t pos = 0; pos < runs.size();) {
+		if (runs.size() - pos < 2)
+			return false;
+		const std::size_t first = runs[pos];
+		const std::size_t count = runs[pos + 1];
+		pos += 2;
+		if (first + count > SLOTS_NUM || count > runs.size() - pos)
+			return false;
+		pos += count;
+	}
+
+	for (std::size_t pos = 0; pos < runs.size();) {
+		const std::size_t first = runs[pos];
+		const std::size_t count = runs[pos + 1];
+		pos += 2;
+		for (std::size_t i = 0; i < count; ++i) {
+			set_slot(state, first + i, runs[pos + i]);
+		}
+		pos += count;
+	}
+	return true;
+}
+
+std::array<byte, LedFrame::FULL_FRAME_SIZE>
+LedFrame::encode(const F1Device::OutputState& state) noexcept
+{
+	std::array<byte, FULL_FRAME_SIZE> msg{};
+	auto out = std::copy(HEADER.begin(), HEADER.end(), msg.begin());
+	*out++ = 0;
+	*out++ = static_cast<byte>(SLOTS_NUM);
+	for (std::size_t slot = 0; slot < SLOTS_NUM; ++slot) {
+		*out++ = get_slot(state, slot);
+	}
+	*out = SYSEX_END;
+	return msg;
+}
+
+void LedFrame::set_slot(
+	F1Device::OutputState& state, std::size_t slot, byte value
+)
+{
+	if (slot < SPECIAL_SLOT) {
+		auto& color = state.matrix_btns.at(
+			(slot - MATRIX_SLOT) / COLOR_COMPONENTS
+		);
+		const auto [r, g, b] = F1Device::color2rgb(color);
+		std::array<Brightness, COLOR_COMPONENTS> rgb{r, g, b};
+		rgb.at((slot - MATRIX_SLOT) % COLOR_COMPONENTS) = value;
+		color = F1Device::rgb2color(rgb[0], rgb[1], rgb[2]);
+	} else if (slot < STOP_SLOT) {
+		state.special_btns.at(slot - SPECIAL_SLOT) = value;
+	} else if (slot < SEGMENT_LEFT_SLOT) {
+		state.stop_btns.at(slot - STOP_SLOT) = value;
+	} else {
+		const bool left = slot < SEGMENT_RIGHT_SLOT;
+		switch ((slot - SEGMENT_LEFT_SLOT) % SEGMENT_SLOTS) {
+		case 0:
+			(left ? state.segment_left_char
+			      : state.segment_right_char) =
+				slot_to_segments(value);
+			break;
+		case 1:
+			(left ? state.segment_left_brightness
+			      : state.segment_right_brightness) = value;
+			break;
+		default:
+			(left ? state.segment_left_dot
+			      : state.segment_right_dot) = value;
+			break;
+		}
+	}
+}
+
+byte LedFrame::get_slot(const F1Device::OutputState& state, std::size_t slot)
+{
+	if (slot < SPECIAL_SLOT) {
+		const auto [r, g, b] = F1Device::color2rgb(state.matrix_btns.at(
+			(slot - MATRIX_SLOT) / COLOR_COMPONENTS
+		));
+		const std::array<Brightness, COLOR_COMPONENTS> rgb{r, g, b};
+		return rgb.at((slot - MATRIX_SLOT) % COLOR_COMPONENTS);
+	}
+	if (slot < STOP_SLOT)
+		return state.special_btns.at(slot - SPECIAL_SLOT);
+	if (slot < SEGMENT_LEFT_SLOT)
+		return state.stop_btns.at(slot - STOP_SLOT);
+
+	const bool left = slot < SEGMENT_RIGHT_SLOT;
+	switch ((slot - SEGMENT_LEFT_SLOT) % SEGMENT_SLOTS) {
+	case 0:
+		return segments_to_slot(
+			left ? state.segment_left_char
+			     : state.segment_right_char
+		);
+	case 1:
+		return left ? state.segment_left_brightness
+			    : state.segment_right_brightness;
+	default:
+		return left ? state.segment_left_dot : state.segment_right_dot;
+	}
+}
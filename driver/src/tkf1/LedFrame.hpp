@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "io/MidiEvent.hpp"
+#include "tkf1/F1Device.hpp"
+
+/**
+ * SysEx message carrying a complete or partial LED frame
+ *
+ * All LEDs are addressed as one array of 7-bit slots:
+ *
+ * | Slots    | LEDs                                                      |
+ * |----------|-----------------------------------------------------------|
+ * | 0 to 47  | red, green and blue of each matrix button, row by row     |
+ * | 48 to 56 | special buttons                                           |
+ * | 57 to 60 | stop buttons                                              |
+ * | 61 to 63 | left segment display: segments, brightness and dot        |
+ * | 64 to 66 | right segment display: segments, brightness and dot       |
+ *
+ * The segments are the bits of F1Device::SegmentChar shifted right by one.
+ * A message consists of the header, any number of runs of consecutive slots
+ * and the SysEx end byte:
+ *
+ *     F0 7D 46 31 01 (<first slot> <count> <value>...)... F7
+ *
+ * 7D is the manufacturer ID for non-commercial use, 46 31 is "F1" and 01
+ * the LED frame command. A complete frame is a single run starting at slot
+ * 0, see encode(). Sending it replaces dozens of note and controller
+ * messages, and the whole frame is shown with a single output report.
+ */
+class LedFrame final
+{
+public:
+	using byte = MidiEvent::byte;
+
+	constexpr static std::array<byte, 5> HEADER{
+		0xf0, 0x7d, 0x46, 0x31, 0x01
+	};
+	constexpr static byte SYSEX_END{0xf7};
+
+	constexpr static std::size_t MATRIX_SLOT{0};
+	constexpr static std::size_t SPECIAL_SLOT{
+		MATRIX_SLOT + (3 * F1Device::MATRIX_BUTTONS_NUM)
+	};
+	constexpr static std::size_t STOP_SLOT{
+		SPECIAL_SLOT + F1Device::SPECIAL_BUTTONS_NUM
+	};
+	constexpr static std::size_t SEGMENT_LEFT_SLOT{
+		STOP_SLOT + F1Device::STOP_BUTTONS_NUM
+	};
+	constexpr static std::size_t SEGMENT_RIGHT_SLOT{SEGMENT_LEFT_SLOT + 3};
+	constexpr static std::size_t SLOTS_NUM{SEGMENT_RIGHT_SLOT + 3};
+
+	/**
+	 * Size of a message with a complete frame
+	 */
+	constexpr static std::size_t FULL_FRAME_SIZE{
+		HEADER.size() + 2 + SLOTS_NUM + 1
+	};
+
+	static_assert(SLOTS_NUM < MidiEvent::STATUS_BYTE_MASK);
+
+	/**
+	 * Check whether a SysEx message is an LED frame
+	 *
+	 * This only checks the header, apply() validates the rest.
+	 */
+	[[nodiscard]] static bool is_led_frame(std::span<const byte> msg
+	) noexcept;
+
+	/**
+	 * Apply the runs of an LED frame message to an output state
+	 *
+	 * The message is validated before it is applied, so a malformed
+	 * message doesn't change the state at all.
+	 *
+	 * @return false if msg is not a well-formed LED frame
+	 */
+	static bool
+	apply(std::span<const byte> msg, F1Device::OutputState& state) noexcept;
+
+	/**
+	 * Encode a complete frame of an output state
+	 */
+	[[nodiscard]] static std::array<byte, FULL_FRAME_SIZE>
+	encode(const F1Device::OutputState& state) noexcept;
+
+private:
+	static void
+	set_slot(F1Device::OutputState& state, std::size_t slot, byte value);
+	static byte
+	get_slot(const F1Device::OutputState& state, std::size_t slot);
+};
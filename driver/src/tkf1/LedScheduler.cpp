@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cmath>
+
+#include "LedScheduler.hpp"
+
+namespace
+{
+/**
+ * Weight of a new sample in the write latency estimate, as a divisor
+ */
+constexpr int LATENCY_SMOOTHING{8};
+
+bool tempo_enabled(const Mapping::Tempo& tempo)
+{
+	return tempo.sync_animations || tempo.metronome || tempo.bar_counter;
+}
+
+bool same_beat(
+	const std::optional<LedScheduler::Beat>& a,
+	const std::optional<LedScheduler::Beat>& b
+)
+{
+	if (not a || not b)
+		return a.has_value() == b.has_value();
+	return a->bar == b->bar && a->beat == b->beat &&
+	       a->rolling == b->rolling;
+}
+} // namespace
+
+LedScheduler::LedScheduler(clock::time_point epoch) : animator(epoch) {}
+
+const F1Device::OutputReport*
+LedScheduler::tick(clock::time_point now, const Input& input, bool changed)
+{
+	const auto target = now + write_latency;
+
+	std::optional<Beat> target_beat;
+	if (tempo_enabled(input.tempo))
+		target_beat = beat_at(input.transport, target);
+	changed |= not same_beat(beat, target_beat);
+	beat = target_beat;
+
+	if (changed) {
+		auto state = input.state;
+		auto animations = input.animations;
+		if (beat) {
+			show_beat(state, input.tempo, *beat);
+			if (input.tempo.sync_animations) {
+				animations.period = beat->length;
+				animator.set_epoch(beat->start);
+			}
+		}
+		animator.compile(state, animations);
+	}
+
+	return animator.frame(target);
+}
+
+LedScheduler::clock::time_point LedScheduler::next_tick(clock::time_point now
+) const noexcept
+{
+	const auto target = now + write_latency;
+	auto next = animator.animated() ? animator.next_frame(target)
+					: target + IDLE_WAIT;
+	if (beat && beat->rolling)
+		next = std::min(next, beat->start + beat->length);
+	return next - write_latency;
+}
+
+void LedScheduler::write_done(clock::duration duration) noexcept
+{
+	const auto sample =
+		std::clamp(duration, clock::duration::zero(), MAX_LATENCY);
+	write_latency += (sample - write_latency) / LATENCY_SMOOTHING;
+}
+
+LedScheduler::clock::duration LedScheduler::latency() const noexcept
+{
+	return write_latency;
+}
+
+std::optional<LedScheduler::Beat>
+LedScheduler::beat_at(const Transport& transport, clock::time_point time)
+{
+	if (not transport.bbt_valid || transport.beats_per_minute <= 0. ||
+	    transport.ticks_per_beat <= 0.)
+		return std::nullopt;
+
+	const auto beats_per_bar = std::max<std::int64_t>(
+		1, std::lround(transport.beats_per_bar)
+	);
+	const std::chrono::duration<double> beat_length{
+		60. / transport.beats_per_minute
+	};
+
+	// position in beats since the start of the song
+	double position =
+		static_cast<double>(transport.bar - 1) *
+			static_cast<double>(beats_per_bar) +
+		static_cast<double>(transport.beat - 1) +
+		static_cast<double>(transport.tick) / transport.ticks_per_beat;
+	if (transport.rolling)
+		position += (time - transport.time) / beat_length;
+	position = std::max(position, 0.);
+
+	const double whole = std::floor(position);
+	const auto index = static_cast<std::int64_t>(whole);
+
+	Beat beat;
+	beat.bar = static_cast<std::int32_t>(index / beats_per_bar + 1);
+	beat.beat = static_cast<std::int32_t>(index % beats_per_bar);
+	beat.length = std::chrono::duration_cast<clock::duration>(beat_length);
+	beat.start = time - std::chrono::duration_cast<clock::duration>(
+				    beat_length * (position - whole)
+			    );
+	beat.rolling = transport.rolling;
+	return beat;
+}
+
+void LedScheduler::show_beat(
+	F1Device::OutputState& state,
+	const Mapping::Tempo& tempo,
+	const Beat& beat
+)
+{
+	if (tempo.metronome) {
+		const auto lit = static_cast<std::size_t>(beat.beat) %
+				 F1Device::STOP_BUTTONS_NUM;
+		state.stop_btns.fill(F1Device::DARK);
+		state.stop_btns.at(lit) = F1Device::FULL_BRIGHTNESS;
+	}
+
+	if (tempo.bar_counter) {
+		const auto [left, right] = F1Device::num_to_segments(
+			static_cast<std::uint8_t>(
+				beat.bar % F1Device::MAX_SEGMENT_NUM
+			)
+		);
+		state.segment_left_char = left;
+		state.segment_right_char = right;
+		state.segment_left_brightness = F1Device::FULL_BRIGHTNESS;
+		state.segment_right_brightness = F1Device::FULL_BRIGHTNESS;
+	}
+}
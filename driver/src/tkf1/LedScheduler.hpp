@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "io/Transport.hpp"
+#include "tkf1/Animator.hpp"
+#include "tkf1/F1Device.hpp"
+#include "tkf1/Mapping.hpp"
+
+/**
+ * Scheduler for the LED output
+ *
+ * The scheduler decides which output report to write when. It feeds the
+ * output state and the animations into an Animator and adds the JACK
+ * transport to the picture: Depending on Mapping::Tempo, animation cycles
+ * last one beat and start on the beat, the stop buttons light up as a
+ * metronome and the segment display counts the bars.
+ *
+ * Each report is picked for the point in time it should become visible. A
+ * HID write takes a while to reach the device, so the scheduler measures how
+ * long writes take and issues them that much in advance.
+ */
+class LedScheduler final
+{
+public:
+	using clock = Animator::clock;
+
+	/**
+	 * Upper bound of the write latency compensation
+	 */
+	constexpr static clock::duration MAX_LATENCY{
+		std::chrono::milliseconds{20}
+	};
+	/**
+	 * Time between ticks if no change is scheduled
+	 */
+	constexpr static clock::duration IDLE_WAIT{std::chrono::seconds{1}};
+
+	/**
+	 * Inputs of a tick
+	 */
+	struct Input {
+		F1Device::OutputState state{};
+		Animator::Animations animations{};
+		Mapping::Tempo tempo{};
+		Transport transport{};
+	};
+
+	/**
+	 * Beat of the JACK transport at some point in time
+	 */
+	struct Beat {
+		/** Bar, starting at 1 */
+		std::int32_t bar{1};
+		/** Beat within the bar, starting at 0 */
+		std::int32_t beat{0};
+		clock::time_point start{};
+		clock::duration length{};
+		bool rolling{false};
+	};
+
+	explicit LedScheduler(clock::time_point epoch = clock::now());
+
+	/**
+	 * Get the report to write now
+	 *
+	 * The report is picked for the time the write is expected to complete.
+	 * If changed is set, the output state, the animations or the tempo
+	 * settings have changed since the last tick.
+	 *
+	 * @return The report to write or nullptr if the LEDs are up to date.
+	 * The report stays valid until the next tick.
+	 */
+	const F1Device::OutputReport*
+	tick(clock::time_point now, const Input& input, bool changed);
+
+	/**
+	 * Get the point in time of the next tick
+	 */
+	[[nodiscard]] clock::time_point next_tick(clock::time_point now
+	) const noexcept;
+
+	/**
+	 * Record the duration of a HID write
+	 */
+	void write_done(clock::duration duration) noexcept;
+
+	/**
+	 * Get the current write latency estimate
+	 */
+	[[nodiscard]] clock::duration latency() const noexcept;
+
+	/**
+	 * Get the beat of the transport at the given point in time
+	 *
+	 * A rolling transport is extrapolated from its last position.
+	 *
+	 * @return The beat or an empty optional if the transport does not
+	 * provide bar and beat information.
+	 */
+	static std::optional<Beat>
+	beat_at(const Transport& transport, clock::time_point time);
+
+	/**
+	 * Show the metronome and bar counter of a beat
+	 */
+	static void show_beat(
+		F1Device::OutputState& state,
+		const Mapping::Tempo& tempo,
+		const Beat& beat
+	);
+
+private:
+	Animator animator;
+	std::optional<Beat> beat{};
+	clock::duration write_latency{0};
+};
@@ -0,0 +1,585 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+#include "Mapping.hpp"
+
+using Brightness = F1Device::Brightness;
+using ButtonColor = F1Device::ButtonColor;
+
+namespace
+{
+constexpr unsigned MIDI_MAX{127U};
+constexpr unsigned CHANNEL_MAX{15U};
+constexpr int HEX_BASE{16};
+constexpr int DEC_BASE{10};
+constexpr unsigned MIN_ANIMATION_PERIOD_MS{100U};
+constexpr unsigned MAX_ANIMATION_PERIOD_MS{10000U};
+constexpr std::string_view BANK_SECTION{"bank "};
+constexpr float MIN_GAMMA{1.F};
+constexpr float MAX_GAMMA{3.F};
+
+std::string_view trim(std::string_view str)
+{
+	const auto* first = std::find_if_not(
+		str.begin(), str.end(), [](unsigned char c) {
+			return std::isspace(c);
+		}
+	);
+	const auto* last = std::find_if_not(
+		str.rbegin(), str.rend(), [](unsigned char c) {
+			return std::isspace(c);
+		}
+	).base();
+	if (first >= last)
+		return {};
+	return std::string_view{first, last};
+}
+
+std::vector<std::string_view> split(std::string_view str)
+{
+	std::vector<std::string_view> tokens;
+	std::size_t pos = 0;
+	while (pos < str.size()) {
+		const std::size_t start = str.find_first_not_of(" \t,", pos);
+		if (start == std::string_view::npos)
+			break;
+		const std::size_t end = str.find_first_of(" \t,", start);
+		tokens.push_back(str.substr(start, end - start));
+		pos = end;
+	}
+	return tokens;
+}
+
+std::string lower(std::string_view str)
+{
+	std::string res{str};
+	std::transform(
+		res.begin(), res.end(), res.begin(), [](unsigned char c) {
+			return std::tolower(c);
+		}
+	);
+	return res;
+}
+
+/**
+ * Parser state for a single mapping file
+ */
+class Parser final
+{
+public:
+	Parser(Mapping& mapping, const std::string& name) :
+		mapping(mapping), name(name)
+	{
+	}
+
+	void parse(std::istream& in)
+	{
+		std::string raw_line;
+		while (std::getline(in, raw_line)) {
+			++line_no;
+			const std::string_view line = trim(raw_line);
+			if (line.empty() || line.front() == '#' ||
+			    line.front() == ';')
+				continue;
+
+			if (line.front() == '[') {
+				if (line.back() != ']')
+					fail("unterminated section header");
+				section = lower(
+					trim(line.substr(1, line.size() - 2))
+				);
+				continue;
+			}
+
+			const std::size_t eq = line.find('=');
+			if (eq == std::string_view::npos)
+				fail("expected key = value");
+
+			set(lower(trim(line.substr(0, eq))),
+			    trim(line.substr(eq + 1)));
+		}
+	}
+
+private:
+	[[noreturn]] void fail(const std::string& msg) const
+	{
+		throw MappingError{
+			name + ':' + std::to_string(line_no) + ": " + msg
+		};
+	}
+
+	void set(const std::string& key, std::string_view value)
+	{
+		auto& m = mapping;
+		if (section == "midi") {
+			if (key == "in_channel")
+				m.in_channel = parse_channel(value);
+			else if (key == "out_channel")
+				m.out_channel = parse_channel(value);
+			else if (key == "note_on_velocity")
+				m.note_on_velocity = parse_byte(value);
+			else if (key == "note_off_velocity")
+				m.note_off_velocity = parse_byte(value);
+			else
+				unknown_key(key);
+		} else if (section == "notes") {
+			set_buttons(
+				key,
+				value,
+				m.banks[0].notes,
+				m.notes,
+				&Parser::parse_note
+			);
+		} else if (section == "controllers") {
+			auto& ctls = m.controllers;
+			if (key == "knobs")
+				parse_list(
+					value, ctls.knobs, &Parser::parse_byte
+				);
+			else if (key == "faders")
+				parse_list(
+					value, ctls.faders, &Parser::parse_byte
+				);
+			else if (key == "wheel")
+				m.controllers.wheel = parse_byte(value);
+			else if (key == "wheel_dec_value")
+				m.wheel_dec_value = parse_byte(value);
+			else if (key == "wheel_inc_value")
+				m.wheel_inc_value = parse_byte(value);
+			else
+				unknown_key(key);
+		} else if (section == "curves") {
+			if (key == "knobs")
+				parse_list(
+					value,
+					m.curves.knobs,
+					&Parser::parse_curve
+				);
+			else if (key == "faders")
+				parse_list(
+					value,
+					m.curves.faders,
+					&Parser::parse_curve
+				);
+			else if (key == "user")
+				parse_list(
+					value, m.user_curve, &Parser::parse_byte
+				);
+			else
+				unknown_key(key);
+		} else if (section == "toggle") {
+			set_buttons(
+				key,
+				value,
+				m.button_toggle.matrix,
+				m.button_toggle,
+				&Parser::parse_bool
+			);
+		} else if (section == "brightness_mode") {
+			set_buttons(
+				key,
+				value,
+				m.brightness_mode.matrix,
+				m.brightness_mode,
+				&Parser::parse_mode
+			);
+		} else if (section == "brightness_controllers") {
+			set_buttons(
+				key,
+				value,
+				m.banks[0].controllers,
+				m.brightness_controllers,
+				&Parser::parse_byte
+			);
+		} else if (section == "brightness") {
+			if (key == "low")
+				m.brightness_low = parse_byte(value);
+			else if (key == "high")
+				m.brightness_high = parse_byte(value);
+			else if (key == "low_color")
+				m.brightness_low_color = parse_factor(value);
+			else if (key == "high_color")
+				m.brightness_high_color = parse_factor(value);
+			else
+				unknown_key(key);
+		} else if (section == "colors") {
+			if (key == "matrix")
+				parse_list(
+					value,
+					m.matrix_colors,
+					&Parser::parse_color
+				);
+			else
+				unknown_key(key);
+		} else if (section == "palette") {
+			set_palette(key, value);
+		} else if (section == "animation") {
+			set_animation(key, value);
+		} else if (section == "tempo") {
+			if (key == "sync_animations")
+				m.tempo.sync_animations = parse_bool(value);
+			else if (key == "metronome")
+				m.tempo.metronome = parse_bool(value);
+			else if (key == "bar_counter")
+				m.tempo.bar_counter = parse_bool(value);
+			else
+				unknown_key(key);
+		} else if (section == "banks") {
+			set_banks(key, value);
+		} else if (section.starts_with(BANK_SECTION)) {
+			const auto bank = parse_bank(
+				section.substr(BANK_SECTION.size())
+			);
+			set_bank(m.banks.at(bank), key, value);
+		} else {
+			fail("unknown section [" + section + ']');
+		}
+	}
+
+	void set_palette(const std::string& key, std::string_view value)
+	{
+		auto& m = mapping;
+		if (key == "enabled") {
+			m.use_palette = parse_bool(value);
+		} else if (key == "gamma") {
+			m.palette_gamma = parse_gamma(value);
+		} else if (not key.empty() &&
+			   std::isdigit(static_cast<unsigned char>(key[0]))) {
+			const unsigned idx =
+				parse_uint(key, Mapping::PALETTE_SIZE - 1);
+			m.palette.at(idx) = parse_color(value);
+		} else {
+			unknown_key(key);
+		}
+	}
+
+	void set_animation(const std::string& key, std::string_view value)
+	{
+		auto& m = mapping;
+		if (key == "blink") {
+			m.animation_channels[Mapping::BLINK] =
+				parse_optional_channel(value);
+		} else if (key == "pulse") {
+			m.animation_channels[Mapping::PULSE] =
+				parse_optional_channel(value);
+		} else if (key == "chase") {
+			m.animation_channels[Mapping::CHASE] =
+				parse_optional_channel(value);
+		} else if (key == "period") {
+			const unsigned ms =
+				parse_uint(value, MAX_ANIMATION_PERIOD_MS);
+			if (ms < MIN_ANIMATION_PERIOD_MS)
+				fail("animation period must be at least " +
+				     std::to_string(MIN_ANIMATION_PERIOD_MS) +
+				     " ms");
+			m.animation_period = std::chrono::milliseconds{ms};
+		} else {
+			unknown_key(key);
+		}
+	}
+
+	void set_banks(const std::string& key, std::string_view value)
+	{
+		auto& m = mapping;
+		if (key == "count")
+			m.banks_num = parse_uint(value, Mapping::MAX_BANKS);
+		else if (key == "prev")
+			m.bank_prev_button = parse_special_button(value);
+		else if (key == "next")
+			m.bank_next_button = parse_special_button(value);
+		else
+			unknown_key(key);
+
+		if (m.banks_num == 0)
+			fail("at least one bank is required");
+	}
+
+	void set_bank(
+		Mapping::Bank& bank,
+		const std::string& key,
+		std::string_view value
+	)
+	{
+		if (key == "notes")
+			parse_list(value, bank.notes, &Parser::parse_note);
+		else if (key == "controllers")
+			parse_list(
+				value, bank.controllers, &Parser::parse_byte
+			);
+		else
+			unknown_key(key);
+	}
+
+	template <typename Matrix, typename Group, typename ParseFn>
+	void set_buttons(
+		const std::string& key,
+		std::string_view value,
+		Matrix& matrix,
+		Group& group,
+		ParseFn fn
+	)
+	{
+		if (key == "matrix")
+			parse_list(value, matrix, fn);
+		else if (key == "special")
+			parse_list(value, group.special, fn);
+		else if (key == "stop")
+			parse_list(value, group.stop, fn);
+		else
+			unknown_key(key);
+	}
+
+	[[noreturn]] void unknown_key(const std::string& key) const
+	{
+		fail("unknown key '" + key + "' in section [" + section + ']');
+	}
+
+	template <typename Container, typename ParseFn>
+	void
+	parse_list(std::string_view value, Container& out, ParseFn fn) const
+	{
+		const auto tokens = split(value);
+		if (tokens.size() != out.size()) {
+			fail("expected " + std::to_string(out.size()) +
+			     " values, got " + std::to_string(tokens.size()));
+		}
+
+		for (std::size_t i = 0; i < tokens.size(); ++i) {
+			out[i] = (this->*fn)(tokens[i]);
+		}
+	}
+
+	unsigned parse_uint(std::string_view value, unsigned max) const
+	{
+		int base = DEC_BASE;
+		if (value.starts_with("0x") || value.starts_with("0X")) {
+			value.remove_prefix(2);
+			base = HEX_BASE;
+		}
+
+		unsigned res{0};
+		const auto [end, ec] = std::from_chars(
+			value.data(), value.data() + value.size(), res, base
+		);
+		if (ec != std::errc{} || end != value.data() + value.size() ||
+		    value.empty())
+			fail("invalid number '" + std::string{value} + '\'');
+		if (res > max)
+			fail("value " + std::to_string(res) + " exceeds " +
+			     std::to_string(max));
+		return res;
+	}
+
+	Mapping::byte parse_byte(std::string_view value) const
+	{
+		return static_cast<Mapping::byte>(parse_uint(value, MIDI_MAX));
+	}
+
+	Mapping::byte parse_channel(std::string_view value) const
+	{
+		return static_cast<Mapping::byte>(
+			parse_uint(value, CHANNEL_MAX)
+		);
+	}
+
+	Mapping::byte parse_optional_channel(std::string_view value) const
+	{
+		if (lower(value) == "off")
+			return Mapping::NO_CHANNEL;
+		return parse_channel(value);
+	}
+
+	Mapping::byte parse_note(std::string_view value) const
+	{
+		const std::size_t len = value.size();
+		const auto is_digit = [](char c) {
+			return std::isdigit(static_cast<unsigned char>(c)) != 0;
+		};
+		if (len > 0 && is_digit(value[0]))
+			return parse_byte(value);
+
+		// <letter>[#b]<octave>, as understood by note_from_name()
+		const bool valid_len = len == 2 || len == 3;
+		const bool valid_letter =
+			valid_len && value[0] >= 'A' && value[0] <= 'G';
+		const bool valid_accidental =
+			len != 3 || value[1] == '#' || value[1] == 'b';
+		const bool valid_octave = valid_len && is_digit(value[len - 1]);
+		if (not(valid_letter && valid_accidental && valid_octave))
+			fail("invalid note name '" + std::string{value} + '\'');
+
+		const unsigned note = MidiEvent::note_from_name(value);
+		if (note > MIDI_MAX)
+			fail("note '" + std::string{value} + "' out of range");
+		return static_cast<Mapping::byte>(note);
+	}
+
+	bool parse_bool(std::string_view value) const
+	{
+		const std::string v = lower(value);
+		if (v == "1" || v == "on" || v == "true" || v == "yes")
+			return true;
+		if (v == "0" || v == "off" || v == "false" || v == "no")
+			return false;
+		fail("invalid boolean '" + std::string{value} + '\'');
+	}
+
+	Mapping::BrightnessMode parse_mode(std::string_view value) const
+	{
+		const std::string v = lower(value);
+		if (v == "hid")
+			return Mapping::HID;
+		if (v == "note")
+			return Mapping::MIDI_NOTE;
+		if (v == "cc")
+			return Mapping::MIDI_CC;
+		fail("invalid brightness mode '" + std::string{value} +
+		     "' (expected hid, note or cc)");
+	}
+
+	Mapping::Curve parse_curve(std::string_view value) const
+	{
+		const std::string v = lower(value);
+		if (v == "linear")
+			return Mapping::LINEAR;
+		if (v == "log")
+			return Mapping::LOG;
+		if (v == "exp")
+			return Mapping::EXP;
+		if (v == "s")
+			return Mapping::S_CURVE;
+		if (v == "user")
+			return Mapping::USER;
+		fail("invalid curve '" + std::string{value} +
+		     "' (expected linear, log, exp, s or user)");
+	}
+
+	// Banks are numbered from 1, as on the segment display
+	std::size_t parse_bank(std::string_view value) const
+	{
+		const std::string_view number = trim(value);
+		if (number.empty() || number.front() == '0')
+			fail("invalid bank '" + std::string{value} + '\'');
+		return parse_uint(number, Mapping::MAX_BANKS) - 1;
+	}
+
+	std::uint8_t parse_special_button(std::string_view value) const
+	{
+		const std::string v = lower(value);
+		for (std::uint8_t i = 0; i < F1Device::SPECIAL_BUTTONS_NUM;
+		     ++i) {
+			if (v == lower(F1Device::special_btn_name(i)))
+				return i;
+		}
+		fail("invalid special button '" + std::string{value} + '\'');
+	}
+
+	float parse_factor(std::string_view value) const
+	{
+		float res{0.F};
+		const auto [end, ec] = std::from_chars(
+			value.data(), value.data() + value.size(), res
+		);
+		if (ec != std::errc{} || end != value.data() + value.size() ||
+		    res < 0.F || res > 1.F)
+			fail("invalid brightness factor '" +
+			     std::string{value} + "' (expected 0.0 to 1.0)");
+		return res;
+	}
+
+	float parse_gamma(std::string_view value) const
+	{
+		float res{0.F};
+		const auto [end, ec] = std::from_chars(
+			value.data(), value.data() + value.size(), res
+		);
+		if (ec != std::errc{} || end != value.data() + value.size() ||
+		    res < MIN_GAMMA || res > MAX_GAMMA)
+			fail("invalid gamma '" + std::string{value} +
+			     "' (expected 1.0 to 3.0)");
+		return res;
+	}
+
+	ButtonColor parse_color(std::string_view value) const
+	{
+		const std::string v = lower(value);
+		const Brightness full = F1Device::FULL_BRIGHTNESS;
+		const Brightness dark = F1Device::DARK;
+		if (v == "black")
+			return F1Device::BLACK;
+		if (v == "white")
+			return F1Device::WHITE;
+		if (v == "red")
+			return F1Device::rgb2color(full, dark, dark);
+		if (v == "green")
+			return F1Device::rgb2color(dark, full, dark);
+		if (v == "blue")
+			return F1Device::rgb2color(dark, dark, full);
+		if (v == "yellow")
+			return F1Device::rgb2color(full, full, dark);
+		if (v == "cyan")
+			return F1Device::rgb2color(dark, full, full);
+		if (v == "magenta")
+			return F1Device::rgb2color(full, dark, full);
+
+		// #rrggbb with 7-bit components
+		constexpr std::size_t HEX_COLOR_LEN{7};
+		if (v.size() != HEX_COLOR_LEN || v.front() != '#')
+			fail("invalid color '" + std::string{value} + '\'');
+
+		const std::string_view hex{v};
+		const auto component = [&](std::size_t i) {
+			const std::string digits{hex.substr(1 + i * 2, 2)};
+			return static_cast<Brightness>(
+				parse_uint("0x" + digits, MIDI_MAX)
+			);
+		};
+		return F1Device::rgb2color(
+			component(0), component(1), component(2)
+		);
+	}
+
+	Mapping& mapping;
+	const std::string& name;
+	std::string section{};
+	std::size_t line_no{0};
+};
+} // namespace
+
+Mapping Mapping::load(
+	std::istream& in, const Mapping& defaults, const std::string& name
+)
+{
+	Mapping mapping{defaults};
+	Parser{mapping, name}.parse(in);
+
+	if (mapping.banks_num > 1 &&
+	    mapping.bank_prev_button == mapping.bank_next_button) {
+		throw MappingError{
+			name + ": bank buttons must not be the same button"
+		};
+	}
+	return mapping;
+}
+
+Mapping
+Mapping::load(const std::filesystem::path& path, const Mapping& defaults)
+{
+	std::ifstream in{path};
+	if (not in)
+		throw MappingError{
+			"Failed to open mapping file " + path.string()
+		};
+
+	return load(in, defaults, path.string());
+}
+
+Mapping Mapping::load(const std::filesystem::path& path)
+{
+	return load(path, Mapping{});
+}
@@ -0,0 +1,860 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <stdexcept>
+#include <string>
+
+#include "io/MidiEvent.hpp"
+#include "tkf1/F1Device.hpp"
+
+/**
+ * Configuration of the mapping between MIDI and HID
+ *
+ * A Mapping is a plain value which can be modified freely. It is turned into
+ * a MappingTable to be used by the IOMapper.
+ *
+ * Mappings can also be loaded from a mapping file, see load().
+ */
+struct Mapping {
+	using byte = MidiEvent::byte;
+
+	constexpr static F1Device::ButtonColor WHITE = F1Device::WHITE;
+	constexpr static std::size_t MAX_BANKS{4};
+	constexpr static std::size_t USER_CURVE_POINTS{17};
+	constexpr static std::size_t PALETTE_SIZE{128};
+
+	enum BrightnessMode {
+		MIDI_NOTE,
+		MIDI_CC,
+		HID,
+	};
+
+	/**
+	 * Response curve of an encoder
+	 *
+	 * LOG rises quickly at first and flattens towards the end, EXP does
+	 * the opposite, S_CURVE is flat at both ends and steep in the middle.
+	 * USER interpolates the points of user_curve.
+	 */
+	enum Curve {
+		LINEAR,
+		LOG,
+		EXP,
+		S_CURVE,
+		USER,
+	};
+
+	enum Animation : std::size_t {
+		BLINK,
+		PULSE,
+		CHASE,
+		ANIMATIONS_NUM,
+	};
+
+	/**
+	 * Channel value disabling an animation
+	 */
+	constexpr static byte NO_CHANNEL{0xff};
+	constexpr static std::chrono::milliseconds DEFAULT_ANIMATION_PERIOD{
+		500
+	};
+
+	/**
+	 * Load a mapping file
+	 *
+	 * Mapping files use a simple INI format. Each section corresponds to a
+	 * group of settings in this struct, each key to a setting. Settings
+	 * for a group of buttons or encoders take a whitespace separated list
+	 * with one value per button or encoder:
+	 *
+	 *     # comment
+	 *     [notes]
+	 *     stop = C#3 D3 D#3 E3
+	 *
+	 * Settings missing from the file keep the value from defaults.
+	 *
+	 * @throw MappingError if the file is malformed.
+	 */
+	static Mapping load(
+		std::istream& in,
+		const Mapping& defaults,
+		const std::string& name
+	);
+	static Mapping
+	load(const std::filesystem::path& path, const Mapping& defaults);
+	static Mapping load(const std::filesystem::path& path);
+
+	// NOLINTBEGIN(*-magic-numbers)
+	/**
+	 * Control which buttons are toggle buttons
+	 */
+	struct {
+		std::bitset<F1Device::MATRIX_BUTTONS_NUM> matrix{};
+		std::bitset<F1Device::SPECIAL_BUTTONS_NUM> special{};
+		std::bitset<F1Device::STOP_BUTTONS_NUM> stop{};
+	} button_toggle;
+	/**
+	 * Configuration of note values to emit for buttons
+	 *
+	 * The notes of the matrix buttons are configured per bank, see banks.
+	 */
+	struct {
+		std::array<byte, F1Device::SPECIAL_BUTTONS_NUM> special{
+			MidiEvent::note_from_name_c("E2"),
+			MidiEvent::note_from_name_c("F2"),
+			MidiEvent::note_from_name_c("F#2"),
+			MidiEvent::note_from_name_c("G2"),
+			MidiEvent::note_from_name_c("G#2"),
+			MidiEvent::note_from_name_c("A2"),
+			MidiEvent::note_from_name_c("A#2"),
+			MidiEvent::note_from_name_c("B2"),
+			MidiEvent::note_from_name_c("C3"),
+		};
+		std::array<byte, F1Device::STOP_BUTTONS_NUM> stop{
+			MidiEvent::note_from_name_c("C#3"),
+			MidiEvent::note_from_name_c("D3"),
+			MidiEvent::note_from_name_c("D#3"),
+			MidiEvent::note_from_name_c("E3"),
+		};
+	} notes;
+	/**
+	 * Configuration of controller values to emit for encoders
+	 */
+	struct {
+		std::array<byte, F1Device::KNOBS_NUM> knobs{33, 34, 35, 36};
+		std::array<byte, F1Device::FADERS_NUM> faders{37, 38, 39, 40};
+		byte wheel{41};
+	} controllers;
+
+	/**
+	 * Value emitted by the wheel for a counterclockwise turn
+	 */
+	byte wheel_dec_value{0x00};
+	/**
+	 * Value emitted by the wheel for a clockwise turn
+	 */
+	byte wheel_inc_value{0x7f};
+
+	/**
+	 * Response curves mapping the encoder positions to controller values
+	 */
+	struct {
+		std::array<Curve, F1Device::KNOBS_NUM> knobs{
+			LINEAR, LINEAR, LINEAR, LINEAR
+		};
+		std::array<Curve, F1Device::FADERS_NUM> faders{
+			LINEAR, LINEAR, LINEAR, LINEAR
+		};
+	} curves;
+	/**
+	 * Points of the USER response curve
+	 *
+	 * Controller values at evenly spaced encoder positions, from the lowest
+	 * to the highest position. Positions in between are interpolated
+	 * linearly. The default is a linear curve.
+	 */
+	std::array<byte, USER_CURVE_POINTS> user_curve{
+		// clang-format off
+		0, 8, 16, 24, 32, 40, 48, 56,
+		64, 71, 79, 87, 95, 103, 111, 119,
+		127,
+		// clang-format on
+	};
+
+	/**
+	 * Control button brightness mode
+	 *
+	 * If a button's mode is MIDI_NOTE, it is controlled by a MIDI event
+	 * with the same note number as the event emitted when pressing the
+	 * corresponding button. If the button's mode is HID, it is solely
+	 * controlled by the HID input, i.e. pressing the button uses high
+	 * brightness, while releasing it uses low brightness.
+	 *
+	 * The MIDI_CC mode allows for fine grained control of the button
+	 * brightess with MIDI CC events. The corresponding CC numbers can be
+	 * configured in brightness_controllers.
+	 */
+	struct {
+		std::array<BrightnessMode, F1Device::MATRIX_BUTTONS_NUM> matrix{
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+		};
+		std::array<BrightnessMode, F1Device::SPECIAL_BUTTONS_NUM>
+			special{
+				BrightnessMode::HID,
+				BrightnessMode::HID,
+				BrightnessMode::HID,
+				BrightnessMode::HID,
+				BrightnessMode::HID,
+				BrightnessMode::HID,
+				BrightnessMode::HID,
+				BrightnessMode::HID,
+				BrightnessMode::HID,
+			};
+		std::array<BrightnessMode, F1Device::STOP_BUTTONS_NUM> stop{
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+			BrightnessMode::HID,
+		};
+	} brightness_mode;
+	/**
+	 * Set brightness controllers
+	 *
+	 * If, for any button, its brightness mode is MIDI_CC, the controller
+	 * number that should control the brightness is set in this struct.
+	 * The controllers of the matrix buttons are configured per bank, see
+	 * banks.
+	 */
+	struct {
+		std::array<byte, F1Device::SPECIAL_BUTTONS_NUM> special{
+			86, 87, 88, 89, 90, 91, 92, 93, 94
+		};
+		std::array<byte, F1Device::STOP_BUTTONS_NUM> stop{
+			102, 103, 104, 105
+		};
+	} brightness_controllers;
+
+	/**
+	 * Matrix button configuration of a bank
+	 */
+	struct Bank {
+		std::array<byte, F1Device::MATRIX_BUTTONS_NUM> notes{};
+		/**
+		 * Brightness controllers, see brightness_controllers
+		 */
+		std::array<byte, F1Device::MATRIX_BUTTONS_NUM> controllers{};
+	};
+
+	/**
+	 * Number of banks of the matrix buttons
+	 *
+	 * With more than one bank, the bank_prev_button and bank_next_button
+	 * special buttons switch between the banks instead of emitting MIDI
+	 * events, and the current bank is shown on the segment display. Each
+	 * bank has its own notes and brightness controllers as well as its
+	 * own LED and toggle state. All other settings are shared.
+	 */
+	std::size_t banks_num{1};
+	std::uint8_t bank_prev_button{F1Device::SpecialButtons::BROWSE};
+	std::uint8_t bank_next_button{F1Device::SpecialButtons::SIZE};
+	std::array<Bank, MAX_BANKS> banks{{
+		{
+			.notes{
+				MidiEvent::note_from_name_c("C1"),
+				MidiEvent::note_from_name_c("C#1"),
+				MidiEvent::note_from_name_c("D1"),
+				MidiEvent::note_from_name_c("D#1"),
+				MidiEvent::note_from_name_c("E1"),
+				MidiEvent::note_from_name_c("F1"),
+				MidiEvent::note_from_name_c("F#1"),
+				MidiEvent::note_from_name_c("G1"),
+				MidiEvent::note_from_name_c("G#1"),
+				MidiEvent::note_from_name_c("A1"),
+				MidiEvent::note_from_name_c("A#1"),
+				MidiEvent::note_from_name_c("B1"),
+				MidiEvent::note_from_name_c("C2"),
+				MidiEvent::note_from_name_c("C#2"),
+				MidiEvent::note_from_name_c("D2"),
+				MidiEvent::note_from_name_c("D#2"),
+			},
+			.controllers{
+				// clang-format off
+				70, 71, 72, 73,
+				74, 75, 76, 77,
+				78, 79, 80, 81,
+				82, 83, 84, 85,
+				// clang-format on
+			},
+		},
+		{
+			.notes{
+				// clang-format off
+				53, 54, 55, 56,
+				57, 58, 59, 60,
+				61, 62, 63, 64,
+				65, 66, 67, 68,
+				// clang-format on
+			},
+			.controllers{
+				// clang-format off
+				106, 107, 108, 109,
+				110, 111, 112, 113,
+				114, 115, 116, 117,
+				118, 119, 120, 121,
+				// clang-format on
+			},
+		},
+		{
+			.notes{
+				// clang-format off
+				69, 70, 71, 72,
+				73, 74, 75, 76,
+				77, 78, 79, 80,
+				81, 82, 83, 84,
+				// clang-format on
+			},
+			.controllers{
+				// clang-format off
+				42, 43, 44, 45,
+				46, 47, 48, 49,
+				50, 51, 52, 53,
+				54, 55, 56, 57,
+				// clang-format on
+			},
+		},
+		{
+			.notes{
+				// clang-format off
+				85, 86, 87, 88,
+				89, 90, 91, 92,
+				93, 94, 95, 96,
+				97, 98, 99, 100,
+				// clang-format on
+			},
+			.controllers{
+				// clang-format off
+				14, 15, 16, 17,
+				18, 19, 20, 21,
+				22, 23, 24, 25,
+				26, 27, 28, 29,
+				// clang-format on
+			},
+		},
+	}};
+
+	/**
+	 * Colors of the matrix buttons
+	 *
+	 * This color is multiplied with the brightness factor to obtain the
+	 * actual color value.
+	 */
+	std::array<F1Device::ButtonColor, F1Device::MATRIX_BUTTONS_NUM>
+		matrix_colors{
+			// clang-format off
+			WHITE, WHITE, WHITE, WHITE,
+			WHITE, WHITE, WHITE, WHITE,
+			WHITE, WHITE, WHITE, WHITE,
+			WHITE, WHITE, WHITE, WHITE,
+			// clang-format on
+		};
+
+	float brightness_low_color{0.2F};
+	float brightness_high_color{1.F};
+
+	/**
+	 * Select the matrix colors from palette
+	 *
+	 * If set, the velocity of Note On events and the value of CC events
+	 * select the color of the matrix buttons in MIDI_NOTE and MIDI_CC
+	 * brightness mode from the palette, instead of switching between low
+	 * and high brightness or scaling the button's color. A single event
+	 * thus sets any color. Note Off events select color 0.
+	 */
+	bool use_palette{false};
+	/**
+	 * Gamma applied to the palette colors
+	 *
+	 * The LED brightness is linear in the color values, so the palette
+	 * colors are corrected to appear evenly spaced. 1.0 disables the
+	 * correction.
+	 */
+	float palette_gamma{2.2F};
+	/**
+	 * Colors selected by note velocity or controller value
+	 *
+	 * The default palette has 16 hues with 8 brightness levels each:
+	 * entry i has hue i / 8 and brightness i % 8, from off to full. Hues
+	 * 0 to 14 go around the color wheel starting at red, hue 15 is white.
+	 * Thus, entry 0 is off and entry 127 is full white.
+	 */
+	std::array<F1Device::ButtonColor, PALETTE_SIZE> palette{
+		default_palette()
+	};
+	F1Device::Brightness brightness_low{0x29};
+	F1Device::Brightness brightness_high{0x7f};
+
+	byte out_channel{0};
+	byte in_channel{1};
+	byte note_on_velocity{127};
+	byte note_off_velocity{0};
+
+	/**
+	 * MIDI input channels of the LED animations
+	 *
+	 * Note events on these channels control the buttons in MIDI_NOTE
+	 * brightness mode just like those on in_channel, but a note on also
+	 * animates the buttons until the next note event for them: BLINK
+	 * switches them on and off, PULSE fades them in and out and CHASE
+	 * lights one of all chasing buttons after another. Use NO_CHANNEL to
+	 * disable an animation.
+	 */
+	std::array<byte, ANIMATIONS_NUM> animation_channels{13, 14, 15};
+	/**
+	 * Duration of one animation cycle
+	 */
+	std::chrono::milliseconds animation_period{DEFAULT_ANIMATION_PERIOD};
+
+	/**
+	 * Synchronization of the LEDs to the JACK transport
+	 *
+	 * These only take effect while a JACK timebase master provides bar and
+	 * beat information.
+	 */
+	struct Tempo {
+		/** Run one animation cycle per beat, starting on the beat */
+		bool sync_animations{false};
+		/** Light the stop button of the current beat */
+		bool metronome{false};
+		/** Show the current bar on the segment display */
+		bool bar_counter{false};
+	} tempo;
+
+	/**
+	 * Build the default palette, see palette
+	 */
+	constexpr static std::array<F1Device::ButtonColor, PALETTE_SIZE>
+	default_palette()
+	{
+		constexpr unsigned LEVELS{8};
+		constexpr unsigned WHITE_HUE{(PALETTE_SIZE / LEVELS) - 1};
+		constexpr unsigned HUE_STEP{360 / WHITE_HUE};
+		// Components of the hues range from 0 to SECTOR
+		constexpr unsigned SECTOR{60};
+
+		std::array<F1Device::ButtonColor, PALETTE_SIZE> res{};
+		for (unsigned i = 0; i < PALETTE_SIZE; ++i) {
+			const unsigned hue = i / LEVELS;
+			const unsigned level = i % LEVELS;
+			const unsigned angle = hue * HUE_STEP;
+			const unsigned up = angle % SECTOR;
+			const unsigned down = SECTOR - up;
+
+			std::array<unsigned, 3> rgb{SECTOR, SECTOR, SECTOR};
+			if (hue != WHITE_HUE) {
+				switch (angle / SECTOR) {
+				case 0:
+					rgb = {SECTOR, up, 0};
+					break;
+				case 1:
+					rgb = {down, SECTOR, 0};
+					break;
+				case 2:
+					rgb = {0, SECTOR, up};
+					break;
+				case 3:
+					rgb = {0, down, SECTOR};
+					break;
+				case 4:
+					rgb = {up, 0, SECTOR};
+					break;
+				default:
+					rgb = {SECTOR, 0, down};
+					break;
+				}
+			}
+
+			constexpr unsigned div{SECTOR * (LEVELS - 1)};
+			const auto scale = [&](unsigned component) {
+				return static_cast<F1Device::Brightness>(
+					(component * level *
+						 F1Device::FULL_BRIGHTNESS +
+					 (div / 2)) /
+					div
+				);
+			};
+			res.at(i) = F1Device::rgb2color(
+				scale(rgb[0]), scale(rgb[1]), scale(rgb[2])
+			);
+		}
+		return res;
+	}
+	// NOLINTEND(*-magic-numbers)
+};
+
+class MappingError : public std::runtime_error
+{
+public:
+	explicit MappingError(const std::string& msg) : std::runtime_error(msg)
+	{
+	}
+};
+
+/**
+ * Compiled form of a Mapping
+ *
+ * Besides the mapping itself, the table contains reverse lookup tables from
+ * MIDI note and controller numbers to the buttons whose brightness they
+ * control, the precomputed matrix colors for low and high brightness and for
+ * each brightness controller value, and the controller value of each encoder
+ * position. Processing an event thus takes a single lookup instead of a
+ * search through all buttons, and no floating point arithmetic.
+ *
+ * Tables are immutable once compiled, so they can be shared between threads.
+ */
+class MappingTable final
+{
+public:
+	/**
+	 * Set of buttons, one bit per button
+	 *
+	 * Matrix buttons start at MATRIX_SHIFT, special buttons at
+	 * SPECIAL_SHIFT and stop buttons at STOP_SHIFT.
+	 */
+	using ButtonMask = std::uint32_t;
+
+	constexpr static std::size_t MATRIX_SHIFT{0};
+	constexpr static std::size_t SPECIAL_SHIFT{
+		MATRIX_SHIFT + F1Device::MATRIX_BUTTONS_NUM
+	};
+	constexpr static std::size_t STOP_SHIFT{
+		SPECIAL_SHIFT + F1Device::SPECIAL_BUTTONS_NUM
+	};
+	constexpr static std::size_t MIDI_VALUES_NUM{128};
+	constexpr static ButtonMask MATRIX_MASK{
+		((ButtonMask{1} << F1Device::MATRIX_BUTTONS_NUM) - 1)
+		<< MATRIX_SHIFT
+	};
+
+	constexpr static std::size_t ENCODER_VALUES_NUM{
+		F1Device::FADERS_MAX + 1U
+	};
+
+	using ButtonTable = std::array<ButtonMask, MIDI_VALUES_NUM>;
+	/**
+	 * Controller values, indexed by encoder position
+	 */
+	using EncoderTable = std::array<Mapping::byte, ENCODER_VALUES_NUM>;
+	/**
+	 * Colors of a matrix button, indexed by brightness controller value
+	 */
+	using ColorTable = std::array<F1Device::ButtonColor, MIDI_VALUES_NUM>;
+
+	static_assert(STOP_SHIFT + F1Device::STOP_BUTTONS_NUM <= 32);
+	static_assert(Mapping::PALETTE_SIZE == MIDI_VALUES_NUM);
+
+	/**
+	 * Compile a mapping
+	 *
+	 * This is constexpr, so fixed mappings can be compiled at compile
+	 * time, see StaticIOMapper.
+	 */
+	constexpr explicit MappingTable(const Mapping& mapping) :
+		config(mapping)
+	{
+		for (std::size_t b = 0; b < Mapping::MAX_BANKS; ++b) {
+			const auto& bank = config.banks.at(b);
+			add_bank_buttons(
+				note_buttons.at(b),
+				config,
+				bank.notes,
+				config.notes,
+				Mapping::MIDI_NOTE
+			);
+			add_bank_buttons(
+				cc_buttons.at(b),
+				config,
+				bank.controllers,
+				config.brightness_controllers,
+				Mapping::MIDI_CC
+			);
+		}
+
+		for (std::size_t i = 0; i < F1Device::MATRIX_BUTTONS_NUM; ++i) {
+			matrix_low.at(i) = scale_color(
+				config.matrix_colors.at(i),
+				config.brightness_low_color
+			);
+			matrix_high.at(i) = scale_color(
+				config.matrix_colors.at(i),
+				config.brightness_high_color
+			);
+			add_cc_colors(
+				matrix_cc.at(i), config.matrix_colors.at(i)
+			);
+		}
+
+		for (std::size_t i = 0; i < Mapping::PALETTE_SIZE; ++i) {
+			palette.at(i) = gamma_correct(
+				config.palette.at(i), config.palette_gamma
+			);
+		}
+		if (config.use_palette)
+			matrix_cc.fill(palette);
+
+		for (std::size_t value = 0; value < MIDI_VALUES_NUM; ++value) {
+			constexpr std::size_t full{F1Device::FULL_BRIGHTNESS};
+			cc_brightness.at(value) =
+				static_cast<F1Device::Brightness>(
+					(value * full + (MIDI_MAX / 2)) /
+					MIDI_MAX
+				);
+		}
+
+		for (std::size_t i = 0; i < F1Device::KNOBS_NUM; ++i) {
+			add_curve(
+				knob_values.at(i),
+				config,
+				config.curves.knobs.at(i)
+			);
+		}
+		for (std::size_t i = 0; i < F1Device::FADERS_NUM; ++i) {
+			add_curve(
+				fader_values.at(i),
+				config,
+				config.curves.faders.at(i)
+			);
+		}
+	}
+
+	const Mapping config;
+
+	/**
+	 * Buttons in MIDI_NOTE brightness mode, indexed by bank and note number
+	 *
+	 * The special and stop buttons are the same in all banks.
+	 */
+	std::array<ButtonTable, Mapping::MAX_BANKS> note_buttons{};
+	/**
+	 * Buttons in MIDI_CC brightness mode, indexed by bank and controller
+	 * number
+	 */
+	std::array<ButtonTable, Mapping::MAX_BANKS> cc_buttons{};
+
+	std::array<F1Device::ButtonColor, F1Device::MATRIX_BUTTONS_NUM>
+		matrix_low{};
+	std::array<F1Device::ButtonColor, F1Device::MATRIX_BUTTONS_NUM>
+		matrix_high{};
+	/**
+	 * Matrix colors in MIDI_CC brightness mode
+	 */
+	std::array<ColorTable, F1Device::MATRIX_BUTTONS_NUM> matrix_cc{};
+	/**
+	 * Special and stop button brightness in MIDI_CC brightness mode,
+	 * indexed by controller value
+	 */
+	std::array<F1Device::Brightness, MIDI_VALUES_NUM> cc_brightness{};
+	/**
+	 * Gamma corrected palette
+	 */
+	ColorTable palette{};
+
+	std::array<EncoderTable, F1Device::KNOBS_NUM> knob_values{};
+	std::array<EncoderTable, F1Device::FADERS_NUM> fader_values{};
+
+private:
+	constexpr static std::size_t MIDI_MAX{MIDI_VALUES_NUM - 1};
+
+	template <std::size_t size>
+	constexpr static void add_buttons(
+		ButtonTable& table,
+		const std::array<Mapping::byte, size>& numbers,
+		const std::array<Mapping::BrightnessMode, size>& modes,
+		Mapping::BrightnessMode mode,
+		std::size_t shift
+	)
+	{
+		for (std::size_t i = 0; i < size; ++i) {
+			if (modes.at(i) == mode) {
+				table.at(numbers.at(i)) |= ButtonMask{1U}
+							   << (shift + i);
+			}
+		}
+	}
+
+	/**
+	 * Add the buttons in the given brightness mode of one bank to a table
+	 */
+	template <typename Group>
+	constexpr static void add_bank_buttons(
+		ButtonTable& table,
+		const Mapping& mapping,
+		const std::array<Mapping::byte, F1Device::MATRIX_BUTTONS_NUM>&
+			matrix,
+		const Group& group,
+		Mapping::BrightnessMode mode
+	)
+	{
+		const auto& modes = mapping.brightness_mode;
+		add_buttons(table, matrix, modes.matrix, mode, MATRIX_SHIFT);
+		add_buttons(
+			table, group.special, modes.special, mode, SPECIAL_SHIFT
+		);
+		add_buttons(table, group.stop, modes.stop, mode, STOP_SHIFT);
+	}
+
+	constexpr static F1Device::ButtonColor
+	scale_color(const F1Device::ButtonColor& color, float brightness)
+	{
+		// Round to nearest, std::lround() is not constexpr
+		const auto scale = [&](F1Device::Brightness value) {
+			return static_cast<F1Device::Brightness>(
+				brightness * static_cast<float>(value) + 0.5F
+			);
+		};
+		const auto& [b, r, g] = color;
+		return F1Device::rgb2color(scale(r), scale(g), scale(b));
+	}
+
+	/**
+	 * Scale a color linearly with each brightness controller value
+	 *
+	 * The components are truncated, so only the full controller value
+	 * reaches the full color.
+	 */
+	constexpr static void
+	add_cc_colors(ColorTable& table, const F1Device::ButtonColor& color)
+	{
+		const auto& [b, r, g] = color;
+		for (std::size_t value = 0; value < MIDI_VALUES_NUM; ++value) {
+			const double brightness =
+				static_cast<double>(value) *
+				(1.0 / static_cast<double>(MIDI_MAX));
+			const auto scale = [&](F1Device::Brightness component) {
+				return static_cast<F1Device::Brightness>(
+					brightness * component
+				);
+			};
+			table.at(value) = F1Device::rgb2color(
+				scale(r), scale(g), scale(b)
+			);
+		}
+	}
+
+	constexpr static F1Device::ButtonColor
+	gamma_correct(const F1Device::ButtonColor& color, float gamma)
+	{
+		constexpr auto max = static_cast<double>(MIDI_MAX);
+		const auto correct = [&](F1Device::Brightness value) {
+			const double x = static_cast<double>(value) / max;
+			return static_cast<F1Device::Brightness>(
+				(pow_unit(x, gamma) * max) + 0.5
+			);
+		};
+		const auto& [b, r, g] = color;
+		return F1Device::rgb2color(correct(r), correct(g), correct(b));
+	}
+
+	/**
+	 * Raise x in [0, 1] to the power of e >= 0
+	 *
+	 * std::pow() is not constexpr, so this computes exp(e * ln(x)) with
+	 * series, which are exact enough for 7-bit colors.
+	 */
+	constexpr static double pow_unit(double x, double e)
+	{
+		constexpr double LN2{0.6931471805599453};
+		constexpr int TERMS{24};
+		if (x <= 0.0)
+			return e == 0.0 ? 1.0 : 0.0;
+
+		// x = m * 2^k with m in [0.5, 1]
+		int k{0};
+		while (x < 0.5) {
+			x *= 2.0;
+			--k;
+		}
+		// ln(m) = 2 atanh(z), with z in [-1/3, 0]
+		const double z = (x - 1.0) / (x + 1.0);
+		double power = z;
+		double atanh{0.0};
+		for (int n = 1; n < 2 * TERMS; n += 2) {
+			atanh += power / n;
+			power *= z * z;
+		}
+		double y = e * ((2.0 * atanh) + (k * LN2));
+
+		// exp(y) = exp(y / 2^s)^(2^s), with y / 2^s in [-0.5, 0]
+		int s{0};
+		while (y < -0.5) {
+			y /= 2.0;
+			++s;
+		}
+		double res{1.0};
+		double term{1.0};
+		for (int n = 1; n < TERMS; ++n) {
+			term *= y / n;
+			res += term;
+		}
+		for (; s > 0; --s)
+			res *= res;
+		return res;
+	}
+
+	/**
+	 * Sample a response curve at each encoder position
+	 */
+	constexpr static void add_curve(
+		EncoderTable& table,
+		const Mapping& mapping,
+		Mapping::Curve curve
+	)
+	{
+		constexpr auto in_max =
+			static_cast<double>(F1Device::FADERS_MAX);
+		constexpr auto out_max = static_cast<double>(MIDI_MAX);
+		for (std::size_t pos = 0; pos < ENCODER_VALUES_NUM; ++pos) {
+			const double x = static_cast<double>(pos) / in_max;
+			double y = x;
+			switch (curve) {
+			case Mapping::LINEAR:
+				break;
+			case Mapping::LOG:
+				y = 1.0 - ((1.0 - x) * (1.0 - x) * (1.0 - x));
+				break;
+			case Mapping::EXP:
+				y = x * x * x;
+				break;
+			case Mapping::S_CURVE:
+				y = x * x * (3.0 - (2.0 * x));
+				break;
+			case Mapping::USER:
+				y = user_curve(mapping.user_curve, x) / out_max;
+				break;
+			}
+			// Round to nearest, std::lround() is not constexpr
+			table.at(pos) =
+				static_cast<Mapping::byte>(y * out_max + 0.5);
+		}
+	}
+
+	/**
+	 * Interpolate the points of a USER curve at x in [0, 1]
+	 */
+	constexpr static double user_curve(
+		const std::array<Mapping::byte, Mapping::USER_CURVE_POINTS>&
+			points,
+		double x
+	)
+	{
+		constexpr std::size_t segments = Mapping::USER_CURVE_POINTS - 1;
+		const double pos = x * static_cast<double>(segments);
+		const std::size_t seg =
+			std::min(static_cast<std::size_t>(pos), segments - 1);
+		const double frac = pos - static_cast<double>(seg);
+		const auto from = static_cast<double>(points.at(seg));
+		const auto to = static_cast<double>(points.at(seg + 1));
+		return from + ((to - from) * frac);
+	}
+};
@@ -0,0 +1,120 @@
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "StateExport.hpp"
+#include "io/FileDescriptor.hpp"
+
+namespace
+{
+constexpr mode_t SEGMENT_MODE{0644};
+
+[[noreturn]] void throw_strerror(const std::string& what)
+{
+	throw StateExportError{what + ": " + strerror(errno)};
+}
+
+void* map_segment(const FileDescriptor<>& fd, int prot)
+{
+	void* addr =
+		mmap(nullptr, sizeof(StateSegment), prot, MAP_SHARED, *fd, 0);
+	if (addr == MAP_FAILED) { // NOLINT(*-cstyle-cast, *-int-to-ptr)
+		throw_strerror("Failed to map state segment");
+	}
+	return addr;
+}
+} // namespace
+
+StateSegment::StateSegment() noexcept : pid(getpid())
+{
+	version.store(VERSION, std::memory_order_release);
+}
+
+StateExport::StateExport(std::string name) : name(std::move(name))
+{
+	const FileDescriptor<> fd{
+		shm_open(this->name.c_str(), O_RDWR | O_CREAT, SEGMENT_MODE)
+	};
+	if (not fd) {
+		throw_strerror("Failed to create state segment " + this->name);
+	}
+	if (ftruncate(*fd, sizeof(StateSegment)) != 0) {
+		throw_strerror("Failed to resize state segment " + this->name);
+	}
+
+	void* addr = map_segment(fd, PROT_READ | PROT_WRITE);
+	// Invalidate a segment left behind by an earlier driver before
+	// initializing it, so no reader uses it while it is inconsistent
+	static_cast<StateSegment*>(addr)->version.store(
+		0, std::memory_order_release
+	);
+	segment = new (addr) StateSegment{};
+}
+
+StateExport::~StateExport()
+{
+	munmap(segment, sizeof(StateSegment));
+	shm_unlink(name.c_str());
+}
+
+StateReader::StateReader(const std::string& name)
+{
+	const FileDescriptor<> fd{shm_open(name.c_str(), O_RDONLY, 0)};
+	if (not fd) {
+		throw_strerror("Failed to open state segment " + name);
+	}
+
+	struct stat st {};
+	if (fstat(*fd, &st) != 0) {
+		throw_strerror("Failed to inspect state segment " + name);
+	}
+	if (static_cast<std::size_t>(st.st_size) < sizeof(StateSegment)) {
+		throw StateExportError{
+			"State segment " + name + " is too small"
+		};
+	}
+
+	const auto* mapped =
+		static_cast<const StateSegment*>(map_segment(fd, PROT_READ));
+	if (mapped->version.load(std::memory_order_acquire) !=
+		    StateSegment::VERSION ||
+	    mapped->magic != StateSegment::MAGIC ||
+	    mapped->size != sizeof(StateSegment)) {
+		munmap(const_cast<StateSegment*>(mapped), sizeof(StateSegment));
+		throw StateExportError{
+			"State segment " + name + " has an incompatible layout"
+		};
+	}
+	segment = mapped;
+}
+
+StateReader::~StateReader()
+{
+	munmap(const_cast<StateSegment*>(segment), sizeof(StateSegment));
+}
+
+F1Device::InputState StateReader::input() const noexcept
+{
+	F1Device::InputState state{};
+	F1Device::decode_input(input_report(), state);
+	return state;
+}
+
+F1Device::OutputState StateReader::output() const noexcept
+{
+	F1Device::OutputState state{};
+	F1Device::decode_output(output_report(), state);
+	return state;
+}
+
+bool StateReader::writer_alive() const noexcept
+{
+	return kill(segment->pid, 0) == 0 || errno == EPERM;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "rt/Seqlock.hpp"
+#include "tkf1/F1Device.hpp"
+
+/**
+ * Layout of the shared memory segment exported by StateExport
+ *
+ * The input and output state are stored as raw HID reports, which have a
+ * fixed layout independent of the compiler and standard library. Each report
+ * is protected by a sequence lock, so the driver never waits for readers and
+ * readers always get a consistent snapshot.
+ *
+ * Any change to this struct must increment VERSION.
+ */
+struct StateSegment {
+	constexpr static std::uint32_t MAGIC{0x31464b54}; // "TKF1"
+	constexpr static std::uint32_t VERSION{1};
+
+	StateSegment() noexcept;
+
+	std::uint32_t magic{MAGIC};
+	/**
+	 * Layout version, which is written last when the segment is created
+	 *
+	 * A reader must not access any other member until it has seen a
+	 * matching version.
+	 */
+	std::atomic<std::uint32_t> version{0};
+	std::uint32_t size{sizeof(StateSegment)};
+	/**
+	 * Process ID of the driver which created the segment
+	 */
+	std::int32_t pid{0};
+
+	rt::Seqlock<F1Device::InputReport> input;
+	rt::Seqlock<F1Device::OutputReport> output;
+};
+
+/**
+ * Writer of the live device state into POSIX shared memory
+ *
+ * External tools (e.g. visualisers) can read the state with StateReader
+ * without touching the HID device. The segment is created and mapped on
+ * construction, so publishing only copies a report into it and never makes a
+ * syscall.
+ *
+ * Each of publish_input() and publish_output() may only be called from one
+ * thread at a time.
+ */
+class StateExport final
+{
+public:
+	/**
+	 * Name of the shared memory segment, i.e. /dev/shm/tkf1-state
+	 */
+	constexpr static const char* DEFAULT_NAME{"/tkf1-state"};
+
+	/**
+	 * Create (or take over) the shared memory segment with the given name
+	 *
+	 * @throw StateExportError if the segment cannot be created or mapped
+	 */
+	explicit StateExport(std::string name = DEFAULT_NAME);
+	StateExport(const StateExport&) = delete;
+	StateExport& operator=(const StateExport&) = delete;
+	StateExport(StateExport&&) = delete;
+	StateExport& operator=(StateExport&&) = delete;
+	/**
+	 * Unmap and remove the segment
+	 *
+	 * Readers keep their mapping, but won't see any further updates.
+	 */
+	~StateExport();
+
+	void publish_input(const F1Device::InputReport& report) noexcept
+	{
+		segment->input.store(report);
+	}
+
+	void publish_output(const F1Device::OutputReport& report) noexcept
+	{
+		segment->output.store(report);
+	}
+
+private:
+	std::string name;
+	StateSegment* segment{nullptr};
+};
+
+/**
+ * Reader of the state exported by a StateExport
+ *
+ * The segment is mapped read-only, and reading a snapshot never blocks the
+ * driver. Reads retry while the driver is updating the requested report, so
+ * they are lock-free but not wait-free.
+ */
+class StateReader final
+{
+public:
+	/**
+	 * Map the shared memory segment with the given name
+	 *
+	 * @throw StateExportError if the segment does not exist or has an
+	 * incompatible layout version
+	 */
+	explicit StateReader(
+		const std::string& name = StateExport::DEFAULT_NAME
+	);
+	StateReader(const StateReader&) = delete;
+	StateReader& operator=(const StateReader&) = delete;
+	StateReader(StateReader&&) = delete;
+	StateReader& operator=(StateReader&&) = delete;
+	~StateReader();
+
+	[[nodiscard]] F1Device::InputReport input_report() const noexcept
+	{
+		return segment->input.load();
+	}
+
+	[[nodiscard]] F1Device::OutputReport output_report() const noexcept
+	{
+		return segment->output.load();
+	}
+
+	/**
+	 * Get a snapshot of the decoded input state
+	 */
+	[[nodiscard]] F1Device::InputState input() const noexcept;
+
+	/**
+	 * Get a snapshot of the decoded output state
+	 *
+	 * This is the state as shown on the device, see
+	 * F1Device::decode_output().
+	 */
+	[[nodiscard]] F1Device::OutputState output() const noexcept;
+
+	/**
+	 * Check whether the driver which created the segment is still running
+	 */
+	[[nodiscard]] bool writer_alive() const noexcept;
+
+private:
+	const StateSegment* segment{nullptr};
+};
+
+class StateExportError : public std::runtime_error
+{
+public:
+	explicit StateExportError(const std::string& msg) :
+		std::runtime_error(msg)
+	{
+	}
+};
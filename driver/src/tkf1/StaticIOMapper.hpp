@@ -0,0 +1,53 @@
+#pragma once
+
+#include <concepts>
+
+#include "tkf1/IOMapper.hpp"
+#include "tkf1/IOMapperImpl.hpp"
+#include "tkf1/Mapping.hpp"
+
+/**
+ * Fixed mapping known at compile time
+ *
+ * A preset is a type with a constexpr static Mapping named MAPPING, e.g.
+ *
+ *     struct MyRig {
+ *             constexpr static Mapping MAPPING = []() {
+ *                     Mapping m;
+ *                     m.out_channel = 2;
+ *                     return m;
+ *             }();
+ *     };
+ */
+template <typename Preset>
+concept MappingPreset = requires {
+	{ Preset::MAPPING } -> std::convertible_to<const Mapping&>;
+};
+
+/**
+ * Mapping table compiled at compile time from a preset
+ */
+template <MappingPreset Preset>
+class StaticMappingTables final
+{
+public:
+	constexpr static MappingTable TABLE{Preset::MAPPING};
+
+	[[nodiscard]] constexpr const MappingTable*
+	read([[maybe_unused]] MappingReader reader) const noexcept
+	{
+		return &TABLE;
+	}
+};
+
+/**
+ * Mapper between MIDI and HID with a mapping fixed at compile time
+ *
+ * This behaves like IOMapper with the preset's mapping, but the mapping
+ * cannot be replaced. Since the mapping tables are constants, the compiler
+ * can fold the settings into the event processing code, and no read-copy-update
+ * section is entered per event. This is meant for fixed deployments, where
+ * the mapping never changes.
+ */
+template <MappingPreset Preset>
+using StaticIOMapper = BasicIOMapper<StaticMappingTables<Preset>>;
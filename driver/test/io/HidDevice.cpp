@@ -0,0 +1,183 @@
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "io/HidDevice.hpp"
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+using Report = std::array<std::uint8_t, 22>;
+
+/**
+ * FIFO standing in for a hidraw device
+ *
+ * Reports written to the device are read back from it, in order.
+ */
+class Fifo final
+{
+public:
+	Fifo() :
+		path(std::filesystem::temp_directory_path() /
+		     ("tkf1-test-hid-" + std::to_string(getpid())))
+	{
+		std::filesystem::remove(path);
+		REQUIRE(mkfifo(path.c_str(), 0600) == 0);
+	}
+	Fifo(const Fifo&) = delete;
+	Fifo& operator=(const Fifo&) = delete;
+	Fifo(Fifo&&) = delete;
+	Fifo& operator=(Fifo&&) = delete;
+	~Fifo()
+	{
+		std::filesystem::remove(path);
+	}
+
+	[[nodiscard]] HidDevice open(bool io_uring) const
+	{
+		HidDevice dev{path.c_str()};
+		if (io_uring && not dev.enable_io_uring()) {
+			SKIP("io_uring with multishot reads is not available");
+		}
+		return dev;
+	}
+
+private:
+	std::filesystem::path path;
+};
+
+Report report(std::uint8_t n)
+{
+	Report r{};
+	r.fill(n);
+	return r;
+}
+
+void write(const HidDevice& dev, const Report& r)
+{
+	dev.write({r.data(), r.size()});
+}
+
+Report read(const HidDevice& dev)
+{
+	Report r{};
+	dev.read(r.data(), r.size());
+	return r;
+}
+} // namespace
+
+TEST_CASE("HidDevice", "[io][hid]")
+{
+	const bool io_uring = GENERATE(false, true);
+	CAPTURE(io_uring);
+	const Fifo fifo;
+	const auto dev = fifo.open(io_uring);
+
+	SECTION("Reports are read in order")
+	{
+		write(dev, report(1));
+		REQUIRE(read(dev) == report(1));
+
+		write(dev, report(2));
+		write(dev, report(3));
+		write(dev, report(4));
+		REQUIRE(read(dev) == report(2));
+		REQUIRE(read(dev) == report(3));
+		REQUIRE(read(dev) == report(4));
+	}
+
+	SECTION("Backlogs larger than the read-ahead are read in order")
+	{
+		for (std::uint8_t i = 0; i < 40; ++i) {
+			write(dev, report(i));
+		}
+		for (std::uint8_t i = 0; i < 40; ++i) {
+			REQUIRE(read(dev) == report(i));
+		}
+	}
+
+	SECTION("Reads wait for reports from another thread")
+	{
+		std::thread writer{[&]() {
+			for (std::uint8_t i = 0; i < 100; ++i) {
+				write(dev, report(i));
+			}
+		}};
+		for (std::uint8_t i = 0; i < 100; ++i) {
+			REQUIRE(read(dev) == report(i));
+		}
+		writer.join();
+	}
+
+	SECTION("Oversized reports are rejected")
+	{
+		if (io_uring) {
+			std::array<std::uint8_t,
+				   HidDevice::MAX_URING_REPORT_SIZE + 1>
+				large{};
+			REQUIRE_THROWS_AS(
+				dev.write({large.data(), large.size()}),
+				HidDeviceError
+			);
+		}
+	}
+}
+
+/*
+ * Compare the syscalls and io_uring, for single reports and for bursts of
+ * reports read in one go, which io_uring reads ahead without any syscall.
+ * Hidden by default, run with: tests "[benchmark]"
+ */
+TEST_CASE("HidDevice benchmark", "[.][benchmark][io][hid]")
+{
+	constexpr std::uint8_t BURST_SIZE{8};
+	const Fifo fifo;
+	const auto r = report(7);
+
+	// Writes the bursts, and never reads once io_uring is enabled
+	const auto syscalls = fifo.open(false);
+	BENCHMARK("Syscalls")
+	{
+		write(syscalls, r);
+		return read(syscalls);
+	};
+	BENCHMARK("Syscalls, burst")
+	{
+		for (std::uint8_t i = 0; i < BURST_SIZE; ++i) {
+			write(syscalls, r);
+		}
+		for (std::uint8_t i = 0; i < BURST_SIZE - 1; ++i) {
+			read(syscalls);
+		}
+		return read(syscalls);
+	};
+
+	const auto uring = fifo.open(true);
+	BENCHMARK("io_uring")
+	{
+		write(uring, r);
+		return read(uring);
+	};
+	BENCHMARK("io_uring, burst")
+	{
+		for (std::uint8_t i = 0; i < BURST_SIZE; ++i) {
+			write(syscalls, r);
+		}
+		for (std::uint8_t i = 0; i < BURST_SIZE - 1; ++i) {
+			read(uring);
+		}
+		return read(uring);
+	};
+}
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,309 @@
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "io/MidiEvent.hpp"
+#include "io/MidiParser.hpp"
+#include "io/RingbufferIterator.hpp"
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+using byte = MidiParser::byte;
+using Result = MidiParser::Result;
+
+std::vector<MidiEvent>
+parse_events(MidiParser& parser, std::span<const byte> bytes)
+{
+	std::vector<MidiEvent> events;
+	parser.parse(bytes, [&](Result res, const MidiParser& p) {
+		if (res == Result::EVENT) {
+			events.push_back(p.event());
+		}
+	});
+	return events;
+}
+} // namespace
+
+TEST_CASE("MidiParser", "[midiparser][io]")
+{
+	MidiParser parser;
+
+	SECTION("Complete messages")
+	{
+		const std::vector<byte> data{
+			0x00, 0x00, // leading data without status is skipped
+			0x80, 0x01, 0x00, // note off
+			0x91, 0x01, 0x7f, // note on, channel 1
+			0xc2, 0x05,       // program change, channel 2
+			0xb0, 0x04, 0x60, // CC04 = 60
+		};
+		const auto events = parse_events(parser, data);
+
+		REQUIRE(events.size() == 4);
+		REQUIRE(events[0] ==
+			MidiEvent{MidiEvent::Type::NOTE_OFF, 0, 0x01, 0x00});
+		REQUIRE(events[1] ==
+			MidiEvent{MidiEvent::Type::NOTE_ON, 1, 0x01, 0x7f});
+		REQUIRE(events[2] ==
+			MidiEvent{MidiEvent::Type::PROGRAM_CHANGE, 2, 0x05, 0});
+		REQUIRE(events[3] == MidiEvent::control_change(0x04, 0x60));
+	}
+
+	SECTION("Running status")
+	{
+		const std::vector<byte> data{
+			0xb0, 0x04, 0x7f, 0x05, 0x60, 0x04, 0x00,
+		};
+		const auto events = parse_events(parser, data);
+
+		REQUIRE(events.size() == 3);
+		REQUIRE(events[0] == MidiEvent::control_change(0x04, 0x7f));
+		REQUIRE(events[1] == MidiEvent::control_change(0x05, 0x60));
+		REQUIRE(events[2] == MidiEvent::control_change(0x04, 0x00));
+	}
+
+	SECTION("System common messages cancel running status")
+	{
+		const std::vector<byte> data{
+			0x90, 0x01, 0x7f, 0xf3, 0x02, 0x01, 0x7f,
+		};
+		const auto events = parse_events(parser, data);
+
+		REQUIRE(events.size() == 2);
+		REQUIRE(events[1] ==
+			MidiEvent{MidiEvent::Type::SYSTEM_MESSAGE, 3, 0x02, 0});
+	}
+
+	SECTION("Realtime bytes within a message")
+	{
+		const std::vector<byte> data{
+			0xb0, 0xf8, 0x04, 0xfa, 0x7f, 0x05, 0xfe, 0x60,
+		};
+		std::vector<byte> realtime;
+		std::vector<MidiEvent> events;
+		parser.parse(data, [&](Result res, const MidiParser& p) {
+			if (res == Result::REALTIME) {
+				realtime.push_back(p.realtime());
+			} else if (res == Result::EVENT) {
+				events.push_back(p.event());
+			}
+		});
+
+		REQUIRE(realtime == std::vector<byte>{0xf8, 0xfa, 0xfe});
+		REQUIRE(events.size() == 2);
+		REQUIRE(events[0] == MidiEvent::control_change(0x04, 0x7f));
+		REQUIRE(events[1] == MidiEvent::control_change(0x05, 0x60));
+	}
+
+	SECTION("Messages split across reads")
+	{
+		const std::vector<byte> data{
+			0x90, 0x01, 0x7f, 0x02, 0x7f, 0xf0, 0x7e, 0x01, 0xf7,
+		};
+
+		for (std::size_t split = 0; split <= data.size(); ++split) {
+			MidiParser p;
+			auto events = parse_events(
+				p, std::span{data}.first(split)
+			);
+			const auto rest =
+				parse_events(p, std::span{data}.subspan(split));
+			events.insert(events.end(), rest.begin(), rest.end());
+
+			REQUIRE(events.size() == 2);
+			REQUIRE(events[1] == MidiEvent{
+				MidiEvent::Type::NOTE_ON, 0, 0x02, 0x7f
+			});
+			const auto msg = p.sysex();
+			REQUIRE(std::vector<byte>(msg.begin(), msg.end()) ==
+				std::vector<byte>{0xf0, 0x7e, 0x01, 0xf7});
+		}
+	}
+
+	SECTION("SysEx")
+	{
+		const std::vector<byte> data{
+			0xf0, 0x00, 0x21, 0xf8, 0x09, 0xf7, 0x01, 0x02,
+		};
+		std::size_t sysex_num{0};
+		std::vector<byte> sysex;
+		parser.parse(data, [&](Result res, const MidiParser& p) {
+			if (res == Result::SYSEX) {
+				++sysex_num;
+				const auto msg = p.sysex();
+				sysex.assign(msg.begin(), msg.end());
+			}
+			REQUIRE(res != Result::EVENT);
+		});
+
+		REQUIRE(sysex_num == 1);
+		REQUIRE(sysex ==
+			std::vector<byte>{0xf0, 0x00, 0x21, 0x09, 0xf7});
+	}
+
+	SECTION("Interrupted SysEx")
+	{
+		const std::vector<byte> data{
+			0xf0, 0x00, 0x21, 0x90, 0x01, 0x7f, 0xf7,
+		};
+		std::vector<Result> results;
+		parser.parse(data, [&](Result res, const MidiParser&) {
+			results.push_back(res);
+		});
+
+		REQUIRE(results == std::vector<Result>{Result::EVENT});
+		REQUIRE(parser.event() ==
+			MidiEvent{MidiEvent::Type::NOTE_ON, 0, 0x01, 0x7f});
+	}
+
+	SECTION("Oversized SysEx is dropped")
+	{
+		std::vector<byte> data(MidiParser::MAX_SYSEX_SIZE, 0x01);
+		data.front() = MidiParser::SYSEX_START;
+		data.push_back(MidiParser::SYSEX_END);
+		data.insert(data.end(), {0x80, 0x01, 0x00});
+
+		std::vector<Result> results;
+		parser.parse(data, [&](Result res, const MidiParser&) {
+			results.push_back(res);
+		});
+
+		REQUIRE(results == std::vector<Result>{Result::EVENT});
+	}
+
+	SECTION("Data runs")
+	{
+		REQUIRE(parser.takes_data_run());
+		parser.push_data(std::vector<byte>{0x01, 0x02});
+		REQUIRE(parser.push(0xf0) == Result::NONE);
+		REQUIRE(parser.takes_data_run());
+		parser.push_data(std::vector<byte>{0x00, 0x21});
+		parser.push_data(std::vector<byte>{0x09});
+		REQUIRE(parser.push(0xf7) == Result::SYSEX);
+		REQUIRE(std::vector<byte>(
+				parser.sysex().begin(), parser.sysex().end()
+			) == std::vector<byte>{0xf0, 0x00, 0x21, 0x09, 0xf7});
+
+		REQUIRE(parser.push(0x90) == Result::NONE);
+		REQUIRE_FALSE(parser.takes_data_run());
+	}
+
+	SECTION("Oversized data runs are dropped")
+	{
+		REQUIRE(parser.push(0xf0) == Result::NONE);
+		parser.push_data(
+			std::vector<byte>(MidiParser::MAX_SYSEX_SIZE, 0x01)
+		);
+		REQUIRE(parser.push(0xf7) == Result::NONE);
+	}
+
+	SECTION("Data lengths")
+	{
+		STATIC_REQUIRE(MidiParser::data_length(0x8f) == 2);
+		STATIC_REQUIRE(MidiParser::data_length(0xc0) == 1);
+		STATIC_REQUIRE(MidiParser::data_length(0xd3) == 1);
+		STATIC_REQUIRE(MidiParser::data_length(0xe0) == 2);
+		STATIC_REQUIRE(MidiParser::data_length(0xf1) == 1);
+		STATIC_REQUIRE(MidiParser::data_length(0xf2) == 2);
+		STATIC_REQUIRE(MidiParser::data_length(0xf6) == 0);
+	}
+}
+
+/*
+ * Compare the parser to MidiEvent::parse() on a typical stream of controller
+ * messages. Hidden by default, run with: tests "[benchmark]"
+ */
+TEST_CASE("MidiParser benchmark", "[.][benchmark][midiparser][io]")
+{
+	constexpr std::size_t MESSAGES{4096};
+	std::vector<byte> data;
+	data.reserve(MESSAGES * 3);
+	for (std::size_t i = 0; i < MESSAGES; ++i) {
+		data.insert(data.end(), {
+			static_cast<byte>(0xb0 | (i % 16)),
+			static_cast<byte>(i % 128),
+			static_cast<byte>((i * 7) % 128),
+		});
+	}
+
+	BENCHMARK("MidiEvent::parse")
+	{
+		std::size_t sum{0};
+		for (auto it = data.cbegin(); it != data.cend();) {
+			MidiEvent event;
+			std::tie(event, it) = MidiEvent::parse(it, data.cend());
+			sum += event.data.controller.value;
+		}
+		return sum;
+	};
+
+	BENCHMARK("MidiParser")
+	{
+		MidiParser parser;
+		std::size_t sum{0};
+		parser.parse(data, [&](Result, const MidiParser& p) {
+			sum += p.event().data.controller.value;
+		});
+		return sum;
+	};
+}
+
+/*
+ * Compare parsing a backlog of large SysEx messages, like LED frames, byte by
+ * byte to passing their payload as data runs, as MidiStream does. Hidden by
+ * default, run with: tests "[benchmark]"
+ */
+TEST_CASE("MidiParser SysEx benchmark", "[.][benchmark][midiparser][io]")
+{
+	constexpr std::size_t MESSAGES{64};
+	constexpr std::size_t PAYLOAD_SIZE{200};
+	std::vector<byte> data;
+	for (std::size_t i = 0; i < MESSAGES; ++i) {
+		data.push_back(MidiParser::SYSEX_START);
+		for (std::size_t j = 0; j < PAYLOAD_SIZE; ++j) {
+			data.push_back(static_cast<byte>((i + j) % 128));
+		}
+		data.push_back(MidiParser::SYSEX_END);
+	}
+
+	BENCHMARK("Byte by byte")
+	{
+		MidiParser parser;
+		std::size_t sum{0};
+		parser.parse(data, [&](Result, const MidiParser& p) {
+			sum += p.sysex().size();
+		});
+		return sum;
+	};
+
+	BENCHMARK("Data runs")
+	{
+		MidiParser parser;
+		std::size_t sum{0};
+		const std::span<const byte> bytes{data};
+		for (std::size_t i = 0; i < bytes.size();) {
+			if (parser.takes_data_run()) {
+				using Iter = RingbufferReadIterator;
+				const auto run = bytes.subspan(i);
+				const std::size_t len =
+					Iter::find_status_byte(run);
+				parser.push_data(run.first(len));
+				i += len;
+				if (i == bytes.size())
+					break;
+			}
+			if (parser.push(bytes[i++]) == Result::SYSEX) {
+				sum += parser.sysex().size();
+			}
+		}
+		return sum;
+	};
+}
+
+// NOLINTEND(*-magic-numbers)
@@ -3,6 +3,7 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "io/MidiEvent.hpp"
+#include "io/MidiParser.hpp"
 #include "io/MidiStream.hpp"
 
 TEST_CASE("MidiStream", "[midistream][io]")
@@ -113,4 +114,124 @@ TEST_CASE("MidiStream", "[midistream][io]")
 		}
 		REQUIRE(expected_iter == expected.end());
 	}
+
+	SECTION("Consuming events")
+	{
+		std::vector<MidiEvent> events;
+		const auto collect = [&](const MidiEvent& e) {
+			events.push_back(e);
+		};
+
+		SECTION("Passes all events and empties the stream")
+		{
+			REQUIRE(stream.consume(collect) == 6);
+			REQUIRE(events.size() == 6);
+			REQUIRE(events.back() ==
+				MidiEvent::control_change(0x05, 0x00));
+			REQUIRE(stream.size() == 0);
+			REQUIRE(stream.consume(collect) == 0);
+		}
+
+		SECTION("Stops after the maximum number of events")
+		{
+			REQUIRE(stream.consume(collect, 2) == 2);
+			REQUIRE(stream.consume(collect) == 4);
+			REQUIRE(events.size() == 6);
+			REQUIRE(events[2] ==
+				MidiEvent::control_change(0x04, 0x7f));
+		}
+	}
+}
+
+TEST_CASE("MidiStream writes complete messages", "[midistream][io]")
+{
+	// jack_ringbuffer_create() rounds up to a power of two and keeps one
+	// byte free
+	MidiStream stream{8};
+	const std::vector<MidiEvent::byte> msg{0x90, 0x01, 0x7f};
+	const auto* data = reinterpret_cast<const char*>(msg.data());
+
+	REQUIRE(stream.write(data, msg.size()) == msg.size());
+	REQUIRE(stream.write(data, msg.size()) == msg.size());
+	REQUIRE(stream.write(data, msg.size()) == 0);
+	REQUIRE(stream.size() == 2 * msg.size());
+	REQUIRE(stream.consume([](const MidiEvent&) {}) == 2);
+}
+
+TEST_CASE("MidiStream passes all kinds of messages", "[midistream][io]")
+{
+	using Result = MidiParser::Result;
+	MidiStream stream{16};
+
+	const auto write = [&](const std::vector<MidiEvent::byte>& msg) {
+		return stream.write(
+			reinterpret_cast<const char*>(msg.data()), msg.size()
+		);
+	};
+
+	std::vector<Result> results;
+	std::vector<MidiEvent::byte> sysex;
+	const auto collect = [&](Result res, const MidiParser& parser) {
+		results.push_back(res);
+		if (res == Result::SYSEX) {
+			const auto msg = parser.sysex();
+			sysex.assign(msg.begin(), msg.end());
+		}
+	};
+
+	// Move the read pointer, so the SysEx message wraps around
+	REQUIRE(write({0x90, 0x01, 0x7f, 0xf8, 0x80, 0x01, 0x00}) == 7);
+	REQUIRE(stream.consume_messages(collect, 2) == 2);
+	REQUIRE(stream.size() == 3);
+	REQUIRE(write({0xf0, 0x7d, 0x01, 0x02, 0x03, 0x04, 0x05, 0xf7}) == 8);
+
+	REQUIRE(stream.consume_messages(collect) == 2);
+	REQUIRE(results ==
+		std::vector<Result>{
+			Result::EVENT, Result::REALTIME, Result::EVENT,
+			Result::SYSEX
+		});
+	REQUIRE(sysex == std::vector<MidiEvent::byte>{
+		0xf0, 0x7d, 0x01, 0x02, 0x03, 0x04, 0x05, 0xf7
+	});
+	REQUIRE(stream.size() == 0);
+}
+
+TEST_CASE("MidiStream skips runs of data bytes", "[midistream][io]")
+{
+	using Result = MidiParser::Result;
+	MidiStream stream{256};
+
+	// Stray data, then a SysEx message long enough for the vector scan,
+	// interrupted by a realtime byte
+	std::vector<MidiEvent::byte> data(5, 0x01);
+	std::vector<MidiEvent::byte> expected{0xf0};
+	for (MidiEvent::byte i = 0; i < 40; ++i) {
+		expected.push_back(i);
+	}
+	expected.push_back(0xf7);
+	data.insert(data.end(), expected.begin(), expected.begin() + 20);
+	data.push_back(0xfe);
+	data.insert(data.end(), expected.begin() + 20, expected.end());
+	data.insert(data.end(), {0x90, 0x01, 0x7f});
+	REQUIRE(stream.write(
+			reinterpret_cast<const char*>(data.data()), data.size()
+		) == data.size());
+
+	std::vector<Result> results;
+	std::vector<MidiEvent::byte> sysex;
+	REQUIRE(stream.consume_messages([&](Result res,
+					    const MidiParser& parser) {
+		results.push_back(res);
+		if (res == Result::SYSEX) {
+			const auto msg = parser.sysex();
+			sysex.assign(msg.begin(), msg.end());
+		}
+	}) == 3);
+	REQUIRE(results ==
+		std::vector<Result>{
+			Result::REALTIME, Result::SYSEX, Result::EVENT
+		});
+	REQUIRE(sysex == expected);
+	REQUIRE(stream.size() == 0);
 }
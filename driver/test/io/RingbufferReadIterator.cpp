@@ -1,10 +1,14 @@
 #include <functional>
 #include <memory>
+#include <vector>
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include <jack/ringbuffer.h>
 
+#include "io/MidiEvent.hpp"
+#include "io/MidiParser.hpp"
 #include "io/RingbufferIterator.hpp"
 
 namespace
@@ -140,6 +144,54 @@ TEST_CASE("RingbufferReadIterator", "[iterator][io]")
 			}
 		}
 
+		SECTION("Reads the wrapped segment from its start")
+		{
+			// Overwrite the stale data of the first write, which
+			// follows the wrapped part in memory
+			jack_ringbuffer_data_t vec[2];
+			jack_ringbuffer_get_read_vector(buf.get(), vec);
+			REQUIRE(vec[1].len == DATA_SIZE / 2);
+			vec[1].buf[DATA_SIZE / 2] = 0x7f;
+
+			RingbufferReadIterator it{buf.get()};
+			it += DATA_SIZE / 2;
+			REQUIRE(*it == example_data.at(DATA_SIZE / 2));
+		}
+
+		SECTION("Segments")
+		{
+			RingbufferReadIterator it{buf.get()};
+			auto segments = it.segments();
+			REQUIRE(segments[0].size() == DATA_SIZE / 2);
+			REQUIRE(segments[1].size() == DATA_SIZE / 2);
+			REQUIRE(segments[1][0] ==
+				example_data.at(DATA_SIZE / 2));
+
+			it += DATA_SIZE / 2 + 1;
+			segments = it.segments();
+			REQUIRE(segments[0].size() == DATA_SIZE / 2 - 1);
+			REQUIRE(segments[0][0] ==
+				example_data.at(DATA_SIZE / 2 + 1));
+			REQUIRE(segments[1].empty());
+		}
+
+		SECTION("Finds status bytes past overroll")
+		{
+			jack_ringbuffer_data_t vec[2];
+			jack_ringbuffer_get_read_vector(buf.get(), vec);
+			vec[1].buf[2] = static_cast<char>(0x90);
+
+			const RingbufferReadIterator it{buf.get()};
+			const auto last = end(buf.get());
+			const auto found = it.find_status_byte(last);
+			REQUIRE(found - it == DATA_SIZE / 2 + 2);
+			REQUIRE(*found == 0x90);
+
+			RingbufferReadIterator before = it;
+			before += DATA_SIZE / 2 + 1;
+			REQUIRE(it.find_status_byte(before) == before);
+		}
+
 		SECTION("Read until end iterator reads correctly")
 		{
 			std::size_t items_read{0};
@@ -156,6 +208,26 @@ TEST_CASE("RingbufferReadIterator", "[iterator][io]")
 		}
 	}
 
+	SECTION("Finding status bytes")
+	{
+		SECTION("Returns the end if there is none")
+		{
+			REQUIRE(iter.find_status_byte(end(buf.get())) ==
+				end(buf.get()));
+		}
+
+		SECTION("Stops at the first status byte")
+		{
+			jack_ringbuffer_data_t vec[2];
+			jack_ringbuffer_get_read_vector(buf.get(), vec);
+			vec[0].buf[DATA_SIZE - 1] = static_cast<char>(0xf8);
+			vec[0].buf[DATA_SIZE - 3] = static_cast<char>(0xb0);
+
+			REQUIRE(iter.find_status_byte(end(buf.get())) - iter ==
+				DATA_SIZE - 3);
+		}
+	}
+
 	SECTION("End iterator")
 	{
 		RingbufferReadIterator end_iter{
@@ -202,3 +274,85 @@ TEST_CASE("RingbufferReadIterator", "[iterator][io]")
 		}
 	}
 }
+
+TEST_CASE("RingbufferReadIterator::find_status_byte", "[iterator][io]")
+{
+	std::vector<RingbufferReadIterator::byte> data(100, 0x7f);
+	REQUIRE(RingbufferReadIterator::find_status_byte(data) == data.size());
+	REQUIRE(RingbufferReadIterator::find_status_byte({}) == 0);
+
+	// Status bytes within vector blocks and the scalar remainder
+	for (std::size_t pos = 0; pos < data.size(); ++pos) {
+		data.at(pos) = 0x80;
+		REQUIRE(RingbufferReadIterator::find_status_byte(data) == pos);
+		REQUIRE(RingbufferReadIterator::find_status_byte(
+				std::span{data}.subspan(pos + 1)
+			) == data.size() - pos - 1);
+		data.at(pos) = 0;
+	}
+}
+
+/*
+ * Parse a full input buffer of controller messages, as it is read after a
+ * stall of the driver. Hidden by default, run with: tests "[benchmark]"
+ */
+TEST_CASE("RingbufferReadIterator benchmark", "[.][benchmark][iterator][io]")
+{
+	constexpr std::size_t BACKLOG_SIZE{8192};
+	std::unique_ptr<
+		jack_ringbuffer_t,
+		std::function<void(jack_ringbuffer_t*)>>
+		buf{jack_ringbuffer_create(BACKLOG_SIZE + 1),
+		    jack_ringbuffer_free};
+
+	// Make the backlog wrap around the end of the ringbuffer
+	jack_ringbuffer_write_advance(buf.get(), BACKLOG_SIZE / 2);
+	jack_ringbuffer_read_advance(buf.get(), BACKLOG_SIZE / 2);
+
+	std::vector<char> backlog;
+	for (std::size_t i = 0; backlog.size() + 3 <= BACKLOG_SIZE; ++i) {
+		const auto msg = MidiEvent::control_change(
+			i % 128, (i * 7) % 128, i % 16
+		).to_bytes();
+		backlog.insert(backlog.end(), msg.begin(), msg.end());
+	}
+	REQUIRE(jack_ringbuffer_write(
+			buf.get(), backlog.data(), backlog.size()
+		) == backlog.size());
+
+	BENCHMARK("Parse backlog")
+	{
+		std::size_t sum{0};
+		const auto last = end(buf.get());
+		for (auto it = begin(buf.get()); it != last;) {
+			MidiEvent event;
+			std::tie(event, it) = MidiEvent::parse(it, last);
+			sum += event.data.controller.value;
+		}
+		return sum;
+	};
+
+	BENCHMARK("Parse backlog segments")
+	{
+		std::size_t sum{0};
+		MidiParser parser;
+		for (const auto segment : begin(buf.get()).segments()) {
+			parser.parse(segment, [&](auto, const MidiParser& p) {
+				sum += p.event().data.controller.value;
+			});
+		}
+		return sum;
+	};
+
+	BENCHMARK("Scan backlog for status bytes")
+	{
+		std::size_t num{0};
+		const auto last = end(buf.get());
+		for (auto it = begin(buf.get()); it != last; ++it, ++num) {
+			it = it.find_status_byte(last);
+			if (it == last)
+				break;
+		}
+		return num;
+	};
+}
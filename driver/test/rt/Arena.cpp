@@ -0,0 +1,170 @@
+#include <array>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <fcntl.h>
+#include <malloc.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "rt/Arena.hpp"
+#include "rt/HeapGuard.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+struct Tracked {
+	explicit Tracked(int& destroyed) : destroyed(destroyed)
+	{
+	}
+	Tracked(const Tracked&) = delete;
+	Tracked& operator=(const Tracked&) = delete;
+	Tracked(Tracked&&) = delete;
+	Tracked& operator=(Tracked&&) = delete;
+	~Tracked()
+	{
+		++destroyed;
+	}
+
+	int& destroyed;
+};
+} // namespace
+
+TEST_CASE("rt::Arena", "[rt][arena]")
+{
+	rt::Arena arena{1024};
+
+	REQUIRE(arena.used() == 0);
+	REQUIRE(arena.capacity() == 1024);
+
+	SECTION("Allocations respect alignment")
+	{
+		void* a = arena.allocate(1, 1);
+		void* b = arena.allocate(8, 64);
+		REQUIRE(a != b);
+		REQUIRE(reinterpret_cast<std::uintptr_t>(b) % 64 == 0);
+		REQUIRE(arena.used() >= 9);
+	}
+
+	SECTION("Exhausting the arena throws")
+	{
+		[[maybe_unused]] void* chunk = arena.allocate(1000, 1);
+		REQUIRE_THROWS_AS(arena.allocate(100, 1), std::bad_alloc);
+	}
+
+	SECTION("pmr containers allocate from the arena")
+	{
+		std::pmr::vector<std::uint32_t> vec{&arena};
+		vec.reserve(16);
+		REQUIRE(arena.used() >= 16 * sizeof(std::uint32_t));
+	}
+
+	SECTION("make_pmr_unique constructs and destroys in the arena")
+	{
+		int destroyed{0};
+		{
+			auto ptr = rt::make_pmr_unique<Tracked>(&arena, destroyed);
+			REQUIRE(arena.used() >= sizeof(Tracked));
+			REQUIRE(destroyed == 0);
+		}
+		REQUIRE(destroyed == 1);
+	}
+}
+
+TEST_CASE("rt::forbid_heap_allocations", "[rt][heapguard]")
+{
+	REQUIRE(rt::heap_allocations_allowed());
+
+	rt::forbid_heap_allocations();
+	REQUIRE_FALSE(rt::heap_allocations_allowed());
+
+	rt::allow_heap_allocations();
+	REQUIRE(rt::heap_allocations_allowed());
+}
+
+#ifdef TKF1_HEAP_GUARD
+namespace
+{
+struct alignas(64) Aligned {
+	std::array<std::byte, 64> data;
+};
+
+// Keeps the allocations from being optimized away
+void* volatile sink{nullptr};
+
+/**
+ * Check that allocate() aborts once heap allocations are forbidden
+ *
+ * The assertion kills the process, so allocate() runs in a child.
+ */
+template <typename F>
+void require_caught(F allocate)
+{
+	const pid_t pid = fork();
+	REQUIRE(pid >= 0);
+	if (pid == 0) {
+		// Silence the assertion message and bypass the crash report
+		// of the test runner
+		const int null = open("/dev/null", O_WRONLY);
+		dup2(null, STDERR_FILENO);
+		std::signal(SIGABRT, SIG_DFL);
+		rt::forbid_heap_allocations();
+		allocate();
+		_exit(0);
+	}
+
+	int status{0};
+	REQUIRE(waitpid(pid, &status, 0) == pid);
+	REQUIRE(WIFSIGNALED(status));
+	REQUIRE(WTERMSIG(status) == SIGABRT);
+}
+} // namespace
+
+// NOLINTBEGIN(*-no-malloc,*-owning-memory)
+TEST_CASE("rt::forbid_heap_allocations catches", "[rt][heapguard]")
+{
+	SECTION("new")
+	{
+		require_caught([]() { sink = new int{}; });
+	}
+
+	SECTION("Aligned new")
+	{
+		require_caught([]() { sink = new Aligned{}; });
+	}
+
+	SECTION("aligned_alloc()")
+	{
+		require_caught([]() { sink = aligned_alloc(64, 64); });
+	}
+
+	SECTION("posix_memalign()")
+	{
+		require_caught([]() {
+			void* ptr{nullptr};
+			if (posix_memalign(&ptr, 64, 64) == 0)
+				sink = ptr;
+		});
+	}
+
+	SECTION("memalign()")
+	{
+		require_caught([]() { sink = memalign(64, 64); });
+	}
+
+	SECTION("valloc()")
+	{
+		require_caught([]() { sink = valloc(64); });
+	}
+}
+// NOLINTEND(*-no-malloc,*-owning-memory)
+#endif
+
+// NOLINTEND(*-magic-numbers)
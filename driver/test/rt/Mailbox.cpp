@@ -0,0 +1,96 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "rt/Mailbox.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+using namespace std::chrono_literals;
+
+namespace
+{
+struct Value {
+	std::array<std::uint64_t, 10> words{};
+};
+} // namespace
+
+TEST_CASE("rt::Mailbox", "[rt][mailbox]")
+{
+	const auto soon = []() {
+		return std::chrono::steady_clock::now() + 1ms;
+	};
+
+	SECTION("The latest value is taken")
+	{
+		rt::Mailbox<int> mailbox{1};
+		REQUIRE(mailbox.value() == 1);
+		REQUIRE_FALSE(mailbox.try_take());
+		REQUIRE_FALSE(mailbox.take_until(soon()));
+
+		mailbox.post(2);
+		mailbox.post(3);
+		REQUIRE(mailbox.take_until(soon()));
+		REQUIRE(mailbox.value() == 3);
+		// The notification of 2 doesn't count as a new value
+		REQUIRE_FALSE(mailbox.take_until(soon()));
+		REQUIRE(mailbox.value() == 3);
+
+		mailbox.post(4);
+		REQUIRE(mailbox.try_take());
+		REQUIRE(mailbox.value() == 4);
+	}
+
+	SECTION("A waiting receiver is woken up")
+	{
+		rt::Mailbox<int> mailbox{};
+		std::thread sender{[&]() {
+			std::this_thread::sleep_for(1ms);
+			mailbox.post(5);
+		}};
+		REQUIRE(mailbox.take_until(
+			std::chrono::steady_clock::now() + 10s
+		));
+		REQUIRE(mailbox.value() == 5);
+		sender.join();
+	}
+
+	SECTION("A slow receiver gets complete values and the last one")
+	{
+		rt::Mailbox<Value> mailbox{};
+		std::atomic<bool> done{false};
+
+		std::thread sender{[&]() {
+			Value value{};
+			for (std::uint64_t i = 1; i <= 100000; ++i) {
+				value.words.fill(i);
+				mailbox.post(value);
+			}
+			done = true;
+		}};
+
+		std::uint64_t last{0};
+		while (not done) {
+			if (not mailbox.take_until(soon()))
+				continue;
+			const Value& value = mailbox.value();
+			for (const auto word : value.words) {
+				REQUIRE(word == value.words[0]);
+			}
+			REQUIRE(value.words[0] > last);
+			last = value.words[0];
+		}
+		sender.join();
+
+		if (last < 100000) {
+			REQUIRE(mailbox.try_take());
+		}
+		REQUIRE(mailbox.value().words[0] == 100000);
+	}
+}
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,81 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "rt/Rcu.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+struct Value {
+	Value(int value, int& destroyed) : value(value), destroyed(destroyed)
+	{
+	}
+	Value(const Value&) = delete;
+	Value& operator=(const Value&) = delete;
+	Value(Value&&) = delete;
+	Value& operator=(Value&&) = delete;
+	~Value()
+	{
+		++destroyed;
+	}
+
+	int value;
+	int& destroyed;
+};
+
+std::unique_ptr<const Value> make_value(int value, int& destroyed)
+{
+	return std::make_unique<const Value>(value, destroyed);
+}
+} // namespace
+
+TEST_CASE("rt::Rcu", "[rt][rcu]")
+{
+	int destroyed{0};
+	{
+		rt::Rcu<Value, 2> rcu{make_value(1, destroyed)};
+
+		REQUIRE(rcu.read(0)->value == 1);
+
+		SECTION("publish replaces the value and frees the old one")
+		{
+			rcu.publish(make_value(2, destroyed));
+			REQUIRE(destroyed == 1);
+			REQUIRE(rcu.read(0)->value == 2);
+			REQUIRE(rcu.read(1)->value == 2);
+		}
+
+		SECTION("publish waits for readers of the old value")
+		{
+			std::atomic<bool> published{false};
+			std::jthread writer;
+			{
+				const auto guard = rcu.read(1);
+				writer = std::jthread{[&]() {
+					rcu.publish(make_value(2, destroyed));
+					published = true;
+				}};
+
+				// New readers see the new value as soon as it
+				// has been published...
+				while (rcu.read(0)->value != 2) {
+					std::this_thread::yield();
+				}
+				// ...while the old one is still alive
+				REQUIRE(guard->value == 1);
+				REQUIRE_FALSE(published);
+				REQUIRE(destroyed == 0);
+			}
+			writer.join();
+			REQUIRE(published);
+			REQUIRE(destroyed == 1);
+		}
+	}
+	REQUIRE(destroyed == 2);
+}
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,39 @@
+#include <sched.h>
+
+#include "rt/Realtime.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators_all.hpp>
+
+TEST_CASE("rt::priority_below_jack", "[rt]")
+{
+	const int min_prio = sched_get_priority_min(SCHED_FIFO);
+	const int max_prio = sched_get_priority_max(SCHED_FIFO);
+
+	SECTION("Priority is offset below JACK's priority")
+	{
+		const int offset = GENERATE(1, 2, 5);
+		REQUIRE(rt::priority_below_jack(max_prio, offset) ==
+			max_prio - offset);
+	}
+
+	SECTION("Non-realtime JACK uses the default priority")
+	{
+		REQUIRE(rt::priority_below_jack(-1, 1) ==
+			rt::DEFAULT_JACK_PRIORITY - 1);
+	}
+
+	SECTION("Priority is clamped to the SCHED_FIFO range")
+	{
+		REQUIRE(rt::priority_below_jack(min_prio, 10) == min_prio);
+		REQUIRE(rt::priority_below_jack(max_prio, -10) == max_prio);
+	}
+}
+
+TEST_CASE("rt::pin_thread", "[rt]")
+{
+	SECTION("Pinning to a CPU outside of the affinity mask fails")
+	{
+		REQUIRE(rt::pin_thread(CPU_SETSIZE));
+	}
+}
@@ -0,0 +1,67 @@
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "rt/Seqlock.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+struct Value {
+	std::array<std::uint64_t, 5> words{};
+	std::uint8_t tail{0};
+};
+} // namespace
+
+TEST_CASE("Seqlock", "[rt][seqlock]")
+{
+	SECTION("Stored values are loaded")
+	{
+		rt::Seqlock<Value> lock{};
+		REQUIRE(lock.load().tail == 0);
+
+		Value value{};
+		value.words[4] = 42;
+		value.tail = 7;
+		lock.store(value);
+		REQUIRE(lock.load().words[4] == 42);
+		REQUIRE(lock.load().tail == 7);
+	}
+
+	SECTION("Readers never see partial updates")
+	{
+		rt::Seqlock<Value> lock{};
+		std::atomic<bool> done{false};
+
+		std::thread writer{[&]() {
+			Value value{};
+			for (std::uint64_t i = 1; i <= 100000; ++i) {
+				value.words.fill(i);
+				value.tail = static_cast<std::uint8_t>(i);
+				lock.store(value);
+			}
+			done = true;
+		}};
+
+		std::uint64_t last{0};
+		while (not done) {
+			const Value value = lock.load();
+			for (const auto word : value.words) {
+				REQUIRE(word == value.words[0]);
+			}
+			REQUIRE(
+				value.tail ==
+				static_cast<std::uint8_t>(value.words[0])
+			);
+			REQUIRE(value.words[0] >= last);
+			last = value.words[0];
+		}
+		writer.join();
+	}
+}
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,174 @@
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "rt/SharedFrame.hpp"
+#include "tkf1/F1Device.hpp"
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+/**
+ * Two counters incremented together, so a + b == 2 * total in every frame
+ */
+struct Counters {
+	std::uint64_t a{0};
+	std::uint64_t b{0};
+	std::uint64_t total{0};
+};
+
+/**
+ * Set all LEDs of a state to the same brightness
+ */
+void fill(F1Device::OutputState& state, unsigned brightness)
+{
+	const auto b = static_cast<F1Device::Brightness>(brightness);
+	state.matrix_btns.fill(F1Device::rgb2color(b, b, b));
+	state.special_btns.fill(b);
+	state.stop_btns.fill(b);
+}
+} // namespace
+
+TEST_CASE("rt::SharedFrame", "[rt][sharedframe]")
+{
+	SECTION("Only changes are published")
+	{
+		rt::SharedFrame<int> frame{1};
+		REQUIRE(frame.latest() == 1);
+
+		frame.update([](int& value) { value = 2; });
+		REQUIRE(frame.latest() == 2);
+
+		REQUIRE_FALSE(frame.update([](int& value) {
+			value = 3;
+			return false;
+		}));
+		REQUIRE(frame.latest() == 2);
+
+		const auto res = frame.update([](int& value) {
+			++value;
+			return std::optional<int>{value};
+		});
+		REQUIRE(res == 4);
+		REQUIRE(frame.latest() == 4);
+	}
+
+	SECTION("A concurrent reader never sees a torn frame")
+	{
+		rt::SharedFrame<Counters> frame{};
+		std::atomic<bool> done{false};
+		std::thread writer{[&]() {
+			for (int i = 0; i < 100000; ++i) {
+				frame.update([](Counters& c) {
+					++c.a;
+					++c.b;
+					++c.total;
+				});
+			}
+			done = true;
+		}};
+
+		std::uint64_t last{0};
+		while (not done) {
+			const Counters& c = frame.latest();
+			REQUIRE(c.a == c.total);
+			REQUIRE(c.b == c.total);
+			REQUIRE(c.total >= last);
+			last = c.total;
+		}
+		writer.join();
+		REQUIRE(frame.latest().total == 100000);
+	}
+
+	SECTION("Output states are read as complete frames")
+	{
+		rt::SharedFrame<F1Device::OutputState> frame{};
+		std::atomic<bool> done{false};
+
+		std::thread writer{[&]() {
+			for (unsigned i = 0; i < 20000; ++i) {
+				frame.update([&](F1Device::OutputState& state) {
+					fill(state, i % 128);
+				});
+			}
+			done = true;
+		}};
+
+		while (not done) {
+			const auto& state = frame.latest();
+			const auto brightness = state.stop_btns[0];
+			const auto color = F1Device::rgb2color(
+				brightness, brightness, brightness
+			);
+			for (const auto& btn : state.matrix_btns) {
+				REQUIRE(btn == color);
+			}
+			for (const auto& btn : state.special_btns) {
+				REQUIRE(btn == brightness);
+			}
+		}
+		writer.join();
+	}
+}
+
+/*
+ * Compare reading the output state through a SharedFrame to copying it under
+ * a mutex, while another thread keeps modifying it. Hidden by default, run
+ * with: tests "[benchmark]"
+ */
+TEST_CASE("rt::SharedFrame benchmark", "[.][benchmark][rt][sharedframe]")
+{
+	std::atomic<bool> done{false};
+	F1Device::OutputState copy;
+
+	SECTION("Mutex")
+	{
+		std::mutex mutex;
+		F1Device::OutputState state;
+		std::thread writer{[&]() {
+			unsigned i{0};
+			while (not done) {
+				const std::scoped_lock lock{mutex};
+				fill(state, ++i & 0x7fU);
+			}
+		}};
+
+		BENCHMARK("Copy under mutex")
+		{
+			const std::scoped_lock lock{mutex};
+			copy = state;
+			return copy.stop_btns[0];
+		};
+		done = true;
+		writer.join();
+	}
+
+	SECTION("SharedFrame")
+	{
+		rt::SharedFrame<F1Device::OutputState> frame{};
+		std::thread writer{[&]() {
+			unsigned i{0};
+			while (not done) {
+				frame.update([&](F1Device::OutputState& state) {
+					fill(state, ++i & 0x7fU);
+				});
+			}
+		}};
+
+		BENCHMARK("Copy latest frame")
+		{
+			copy = frame.latest();
+			return copy.stop_btns[0];
+		};
+		done = true;
+		writer.join();
+	}
+}
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,72 @@
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "rt/TripleBuffer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+struct Value {
+	std::array<std::uint64_t, 8> words{};
+};
+} // namespace
+
+TEST_CASE("rt::TripleBuffer", "[rt][triplebuffer]")
+{
+	SECTION("Published values are picked up")
+	{
+		rt::TripleBuffer<int> buffer{3};
+		REQUIRE(buffer.front() == 3);
+		REQUIRE_FALSE(buffer.update());
+
+		buffer.back() = 4;
+		buffer.publish();
+		buffer.back() = 5;
+		buffer.publish();
+		REQUIRE(buffer.update());
+		REQUIRE(buffer.front() == 5);
+		REQUIRE_FALSE(buffer.update());
+		REQUIRE(buffer.front() == 5);
+
+		buffer.back() = 6;
+		buffer.publish();
+		REQUIRE(buffer.update());
+		REQUIRE(buffer.front() == 6);
+	}
+
+	SECTION("The reader never sees partial values")
+	{
+		rt::TripleBuffer<Value> buffer{};
+		std::atomic<bool> done{false};
+
+		std::thread writer{[&]() {
+			for (std::uint64_t i = 1; i <= 100000; ++i) {
+				buffer.back().words.fill(i);
+				buffer.publish();
+			}
+			done = true;
+		}};
+
+		std::uint64_t last{0};
+		while (not done) {
+			buffer.update();
+			const Value& value = buffer.front();
+			for (const auto word : value.words) {
+				REQUIRE(word == value.words[0]);
+			}
+			REQUIRE(value.words[0] >= last);
+			last = value.words[0];
+		}
+		writer.join();
+
+		buffer.update();
+		REQUIRE(buffer.front().words[0] == 100000);
+	}
+}
+
+// NOLINTEND(*-magic-numbers)
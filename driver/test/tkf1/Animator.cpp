@@ -0,0 +1,225 @@
+#include <chrono>
+
+#include "io/MidiEvent.hpp"
+#include "tkf1/Animator.hpp"
+#include "tkf1/F1Device.hpp"
+#include "tkf1/IOMapper.hpp"
+#include "tkf1/Mapping.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+using namespace std::chrono_literals;
+using clock = Animator::clock;
+
+constexpr Animator::ButtonMask button_bit(std::size_t shift, std::size_t idx)
+{
+	return Animator::ButtonMask{1} << (shift + idx);
+}
+
+constexpr Animator::ButtonMask matrix_bit(std::size_t idx)
+{
+	return button_bit(MappingTable::MATRIX_SHIFT, idx);
+}
+} // namespace
+
+TEST_CASE("Animator", "[tkf1][animator]")
+{
+	const clock::time_point epoch{};
+	// 10ms per frame
+	const auto frame_time = [&](std::size_t frame) {
+		return epoch + frame * 10ms;
+	};
+
+	Animator animator{epoch};
+	Animator::Animations animations{};
+	animations.period = 320ms;
+
+	F1Device::OutputState state{};
+	state.matrix_btns[0] = F1Device::WHITE;
+	state.matrix_btns[1] = F1Device::WHITE;
+	state.matrix_btns[2] = F1Device::WHITE;
+	state.stop_btns[0] = F1Device::FULL_BRIGHTNESS;
+
+	SECTION("Static output is written once")
+	{
+		animator.compile(state, animations);
+		REQUIRE_FALSE(animator.animated());
+
+		const auto* report = animator.frame(frame_time(0));
+		REQUIRE(report != nullptr);
+		F1Device::OutputReport expected{};
+		F1Device::encode_output(state, expected);
+		REQUIRE(*report == expected);
+
+		REQUIRE(animator.frame(frame_time(5)) == nullptr);
+
+		// Recompiling the same state doesn't write it again
+		animator.compile(state, animations);
+		REQUIRE(animator.frame(frame_time(7)) == nullptr);
+
+		state.stop_btns[0] = F1Device::DARK;
+		animator.compile(state, animations);
+		REQUIRE(animator.frame(frame_time(8)) != nullptr);
+	}
+
+	SECTION("Blinking buttons are only written on changes")
+	{
+		animations.buttons[Mapping::BLINK] = matrix_bit(1);
+		animator.compile(state, animations);
+		REQUIRE(animator.animated());
+
+		const auto* on = animator.frame(frame_time(0));
+		REQUIRE(on != nullptr);
+		// first color component of the second matrix button
+		constexpr std::size_t offset{0x19 + 3};
+		REQUIRE((*on)[offset] == F1Device::FULL_BRIGHTNESS);
+		for (std::size_t f = 1; f < Animator::FRAMES_NUM / 2; ++f) {
+			REQUIRE(animator.frame(frame_time(f)) == nullptr);
+		}
+
+		const auto* off = animator.frame(frame_time(16));
+		REQUIRE(off != nullptr);
+		REQUIRE((*off)[offset] == F1Device::DARK);
+		REQUIRE(animator.frame(frame_time(31)) == nullptr);
+		REQUIRE(animator.frame(frame_time(32)) != nullptr);
+	}
+
+	SECTION("Next frame is aligned to the epoch")
+	{
+		animations.buttons[Mapping::PULSE] = matrix_bit(1);
+		animator.compile(state, animations);
+		REQUIRE(animator.next_frame(epoch + 15ms) == epoch + 20ms);
+		REQUIRE(animator.next_frame(epoch + 20ms) == epoch + 30ms);
+	}
+
+	SECTION("Next frame skips identical frames")
+	{
+		animations.buttons[Mapping::BLINK] = matrix_bit(1);
+		animator.compile(state, animations);
+		REQUIRE(animator.next_frame(epoch + 15ms) == epoch + 160ms);
+		REQUIRE(animator.next_frame(epoch + 160ms) == epoch + 320ms);
+	}
+}
+
+TEST_CASE("Animator::apply", "[tkf1][animator]")
+{
+	F1Device::OutputState state{};
+	state.matrix_btns.fill(F1Device::WHITE);
+	state.special_btns.fill(F1Device::FULL_BRIGHTNESS);
+
+	Animator::Animations animations{};
+
+	SECTION("Pulse fades between full and low brightness")
+	{
+		constexpr unsigned max = Animator::LEVEL_MAX;
+		REQUIRE(Animator::level(Mapping::PULSE, 0) == max);
+		REQUIRE(Animator::level(Mapping::PULSE, 16) < max / 4);
+		REQUIRE(Animator::level(Mapping::PULSE, 16) > 0);
+		REQUIRE(Animator::level(Mapping::BLINK, 15) == max);
+		REQUIRE(Animator::level(Mapping::BLINK, 16) == 0);
+
+		animations.buttons[Mapping::PULSE] =
+			button_bit(MappingTable::SPECIAL_SHIFT, 2);
+		Animator::apply(state, animations, 16);
+		REQUIRE(state.special_btns[2] < F1Device::FULL_BRIGHTNESS / 4);
+		REQUIRE(state.special_btns[3] == F1Device::FULL_BRIGHTNESS);
+	}
+
+	SECTION("Chasing buttons light up one after another")
+	{
+		animations.buttons[Mapping::CHASE] =
+			matrix_bit(4) | matrix_bit(5) | matrix_bit(6) |
+			matrix_bit(7);
+
+		for (std::size_t f = 0; f < Animator::FRAMES_NUM; ++f) {
+			auto frame_state = state;
+			Animator::apply(frame_state, animations, f);
+			const std::size_t lit = 4 + f / 8;
+			for (std::size_t i = 4; i < 8; ++i) {
+				const auto expected = i == lit
+							      ? F1Device::WHITE
+							      : F1Device::BLACK;
+				REQUIRE(frame_state.matrix_btns[i] == expected);
+			}
+			REQUIRE(frame_state.matrix_btns[3] == F1Device::WHITE);
+		}
+	}
+}
+
+TEST_CASE("IOMapper animations", "[tkf1][animator]")
+{
+	Mapping mapping;
+	mapping.banks_num = 2;
+	mapping.brightness_mode.matrix.fill(Mapping::MIDI_NOTE);
+	mapping.brightness_mode.stop.fill(Mapping::MIDI_NOTE);
+	mapping.brightness_mode.special.fill(Mapping::MIDI_CC);
+
+	IOMapper io_mapper{mapping};
+	F1Device::OutputState output;
+
+	const auto note = [&](MidiEvent::Type type,
+			      MidiEvent::byte channel,
+			      MidiEvent::byte note) {
+		return io_mapper.process_MIDI_event(
+			MidiEvent{type, channel, note, 127}, output
+		);
+	};
+	const auto blink = mapping.animation_channels[Mapping::BLINK];
+	const auto chase = mapping.animation_channels[Mapping::CHASE];
+
+	SECTION("Note ons on animation channels animate buttons")
+	{
+		const auto matrix_note = mapping.banks[0].notes[3];
+		REQUIRE(note(MidiEvent::Type::NOTE_ON, blink, matrix_note));
+		const auto stop_note = mapping.notes.stop[1];
+		REQUIRE(note(MidiEvent::Type::NOTE_ON, chase, stop_note));
+		REQUIRE(output.matrix_btns[3] != F1Device::BLACK);
+
+		auto animations = io_mapper.animations();
+		REQUIRE(animations.period == mapping.animation_period);
+		REQUIRE(animations.buttons[Mapping::BLINK] == matrix_bit(3));
+		REQUIRE(
+			animations.buttons[Mapping::CHASE] ==
+			button_bit(MappingTable::STOP_SHIFT, 1)
+		);
+
+		// any note event for the button stops the animation
+		const auto in = mapping.in_channel;
+		REQUIRE(note(MidiEvent::Type::NOTE_ON, in, matrix_note));
+		animations = io_mapper.animations();
+		REQUIRE(animations.buttons[Mapping::BLINK] == 0);
+		REQUIRE(animations.buttons[Mapping::CHASE] != 0);
+	}
+
+	SECTION("Matrix animations are kept per bank")
+	{
+		const auto bank_note = mapping.banks[1].notes[2];
+		REQUIRE_FALSE(note(MidiEvent::Type::NOTE_ON, blink, bank_note));
+		REQUIRE(io_mapper.animations().buttons[Mapping::BLINK] == 0);
+	}
+
+	SECTION("Controllers on animation channels are ignored")
+	{
+		const auto& controllers = mapping.brightness_controllers;
+		const auto controller = controllers.special[1];
+		const auto cc = [&](MidiEvent::byte channel) {
+			return io_mapper.process_MIDI_event(
+				MidiEvent{
+					MidiEvent::Type::CONTROL_CHANGE,
+					channel,
+					controller,
+					127
+				},
+				output
+			);
+		};
+		REQUIRE_FALSE(cc(blink));
+		REQUIRE(cc(mapping.in_channel));
+	}
+}
+
+// NOLINTEND(*-magic-numbers)
@@ -188,3 +188,70 @@ TEST_CASE("F1Device::num_to_segments")
 		REQUIRE_THROWS(F1Device::num_to_segments(val));
 	}
 }
+
+TEST_CASE("F1Device::decode_input")
+{
+	F1Device::InputReport report{};
+	report[0] = F1Device::INPUT_REPORT_ID;
+	report[1] = 0x80; // first matrix button
+	report[2] = 0x01; // last matrix button
+	report[3] = 0x04; // first special button
+	report[4] = 0x82; // stop button 0, special button 6
+	report[5] = 0x42; // wheel
+	report[6] = 0x34; // knob 0
+	report[7] = 0x12;
+	report[20] = 0xff; // fader 3
+	report[21] = 0x0f;
+
+	F1Device::InputState state{};
+	F1Device::decode_input(report, state);
+
+	REQUIRE(state.report_id == F1Device::INPUT_REPORT_ID);
+	REQUIRE(state.matrix_btns.to_ulong() == 0x8001U);
+	REQUIRE(state.special_btns.to_ulong() == 0x41U);
+	REQUIRE(state.stop_btns.to_ulong() == 0x1U);
+	REQUIRE(state.wheel == 0x42);
+	REQUIRE(state.knobs[0] == 0x1234);
+	REQUIRE(state.faders[3] == 0xfff);
+
+	SECTION("other reports are ignored")
+	{
+		report[0] = 0x00;
+		report[5] = 0x00;
+		F1Device::decode_input(report, state);
+		REQUIRE(state.wheel == 0x42);
+	}
+}
+
+TEST_CASE("F1Device::decode_output")
+{
+	F1Device::OutputState state{};
+	state.matrix_btns[3] = F1Device::rgb2color(0x10, 0x20, 0x30);
+	state.stop_btns[0] = F1Device::FULL_BRIGHTNESS;
+	state.special_btns[F1Device::SpecialButtons::SYNC] = 0x40;
+	const auto [left, right] = F1Device::num_to_segments(42);
+	state.segment_left_char = left;
+	state.segment_right_char = right;
+	state.segment_left_brightness = 0x50;
+	state.segment_right_brightness = 0x60;
+	state.segment_right_dot = 0x70;
+
+	F1Device::OutputReport report{};
+	F1Device::encode_output(state, report);
+
+	F1Device::OutputState decoded{};
+	F1Device::decode_output(report, decoded);
+
+	REQUIRE(decoded.matrix_btns == state.matrix_btns);
+	REQUIRE(decoded.stop_btns == state.stop_btns);
+	REQUIRE(decoded.special_btns == state.special_btns);
+	REQUIRE(decoded.segment_left_char == left);
+	REQUIRE(decoded.segment_right_char == right);
+	REQUIRE(decoded.segment_left_brightness == 0x50);
+	REQUIRE(decoded.segment_right_brightness == 0x60);
+	REQUIRE(decoded.segment_right_dot == 0x70);
+
+	F1Device::OutputReport reencoded{};
+	F1Device::encode_output(decoded, reencoded);
+	REQUIRE(reencoded == report);
+}
@@ -0,0 +1,186 @@
+#include <cstddef>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "io/MidiEvent.hpp"
+#include "tkf1/F1Device.hpp"
+#include "tkf1/IOMapper.hpp"
+#include "tkf1/LedFrame.hpp"
+#include "tkf1/Mapping.hpp"
+
+#include "OutputReport.hpp"
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+using byte = LedFrame::byte;
+using SegmentChar = F1Device::SegmentChar;
+
+std::vector<byte> message(const std::vector<byte>& runs)
+{
+	std::vector<byte> msg{LedFrame::HEADER.begin(), LedFrame::HEADER.end()};
+	msg.insert(msg.end(), runs.begin(), runs.end());
+	msg.push_back(LedFrame::SYSEX_END);
+	return msg;
+}
+
+F1Device::OutputState example_state()
+{
+	F1Device::OutputState state;
+	for (std::size_t i = 0; i < F1Device::MATRIX_BUTTONS_NUM; ++i) {
+		const auto v = static_cast<F1Device::Brightness>(i * 8);
+		state.matrix_btns.at(i) =
+			F1Device::rgb2color(v, 0x7f - v, v / 2);
+	}
+	state.special_btns.fill(0x11);
+	state.stop_btns = {0x7f, 0x00, 0x22, 0x33};
+	state.segment_left_char = SegmentChar::D4;
+	state.segment_right_char = SegmentChar::H;
+	state.segment_left_brightness = 0x40;
+	state.segment_right_dot = 0x7f;
+	return state;
+}
+} // namespace
+
+TEST_CASE("LedFrame", "[tkf1][ledframe]")
+{
+	F1Device::OutputState state;
+
+	SECTION("A complete frame restores the output state")
+	{
+		const auto expected = example_state();
+		const auto msg = LedFrame::encode(expected);
+		REQUIRE(msg.front() == 0xf0);
+		REQUIRE(msg.back() == 0xf7);
+		for (std::size_t i = 1; i + 1 < msg.size(); ++i) {
+			REQUIRE(not MidiEvent::is_status_byte(msg.at(i)));
+		}
+
+		REQUIRE(LedFrame::apply(msg, state));
+		REQUIRE(encode(state) == encode(expected));
+	}
+
+	SECTION("Runs update only their slots")
+	{
+		const auto before = example_state();
+		state = before;
+		REQUIRE(LedFrame::apply(
+			message({
+				// green and blue of matrix button 1
+				4, 2, 0x01, 0x02,
+				// stop button 2 and the left segments
+				LedFrame::STOP_SLOT + 2, 1, 0x05,
+				LedFrame::SEGMENT_LEFT_SLOT, 1,
+				static_cast<byte>(SegmentChar::L) >> 1,
+			}),
+			state
+		));
+
+		const auto [r, g, b] =
+			F1Device::color2rgb(state.matrix_btns[1]);
+		const auto [old_r, old_g, old_b] =
+			F1Device::color2rgb(before.matrix_btns[1]);
+		REQUIRE(r == old_r);
+		REQUIRE(g == 0x01);
+		REQUIRE(b == 0x02);
+		REQUIRE(state.matrix_btns[0] == before.matrix_btns[0]);
+		REQUIRE(state.stop_btns[2] == 0x05);
+		REQUIRE(state.stop_btns[1] == before.stop_btns[1]);
+		REQUIRE(state.segment_left_char == SegmentChar::L);
+		REQUIRE(state.segment_left_brightness ==
+			before.segment_left_brightness);
+	}
+
+	SECTION("Malformed messages don't change the state")
+	{
+		const auto before = encode(state);
+		const std::vector<std::vector<byte>> invalid{
+			// other manufacturer
+			{0xf0, 0x7e, 0x46, 0x31, 0x01, 0x00, 0x01, 0x7f, 0xf7},
+			// run exceeds the slots
+			message({LedFrame::SLOTS_NUM - 1, 2, 0x7f, 0x7f}),
+			// run exceeds the message
+			message({0, 3, 0x7f, 0x7f}),
+			// incomplete run after a valid one
+			message({0, 1, 0x7f, 5}),
+			// no SysEx end
+			{0xf0, 0x7d, 0x46, 0x31, 0x01, 0x00, 0x01, 0x7f},
+		};
+		for (const auto& msg : invalid) {
+			REQUIRE_FALSE(LedFrame::apply(msg, state));
+			REQUIRE(encode(state) == before);
+		}
+	}
+}
+
+TEST_CASE("IOMapper LED frames", "[tkf1][ledframe][mapping]")
+{
+	Mapping mapping;
+	mapping.banks_num = 2;
+	IOMapper io_mapper{mapping};
+	F1Device::OutputState output;
+	io_mapper.init_output(output);
+
+	const auto frame = example_state();
+	REQUIRE(io_mapper.process_MIDI_sysex(LedFrame::encode(frame), output));
+	REQUIRE(encode(output) == encode(frame));
+	REQUIRE_FALSE(io_mapper.process_MIDI_sysex(
+		std::vector<byte>{0xf0, 0x7e, 0x00, 0xf7}, output
+	));
+
+	// The frame is cached for the bank
+	const auto next_bank = [&]() {
+		io_mapper.process_HID_input(
+			{F1Device::InputEvent::EventType::BUTTON,
+			 F1Device::InputEvent::InputType::SPECIAL,
+			 F1Device::InputEvent::ButtonEvent{
+				 mapping.bank_next_button, true
+			 }},
+			output
+		);
+	};
+	next_bank();
+	REQUIRE(output.matrix_btns != frame.matrix_btns);
+	next_bank();
+	REQUIRE(output.matrix_btns == frame.matrix_btns);
+}
+
+/*
+ * Compare redrawing the matrix with one palette note per button to a single
+ * LED frame. Hidden by default, run with: tests "[benchmark]"
+ */
+TEST_CASE("LedFrame benchmark", "[.][benchmark][tkf1][ledframe]")
+{
+	Mapping mapping;
+	mapping.use_palette = true;
+	mapping.brightness_mode.matrix.fill(Mapping::MIDI_NOTE);
+	IOMapper io_mapper{mapping};
+	F1Device::OutputState output;
+
+	std::vector<MidiEvent> notes;
+	for (const auto note : mapping.banks[0].notes) {
+		notes.emplace_back(
+			MidiEvent::Type::NOTE_ON, mapping.in_channel, note, 15
+		);
+	}
+	const auto frame = LedFrame::encode(example_state());
+
+	BENCHMARK("Note per button")
+	{
+		bool changed{false};
+		for (const auto& note : notes) {
+			changed |= io_mapper.process_MIDI_event(note, output);
+		}
+		return changed;
+	};
+
+	BENCHMARK("LED frame")
+	{
+		return io_mapper.process_MIDI_sysex(frame, output);
+	};
+}
+
+// NOLINTEND(*-magic-numbers)
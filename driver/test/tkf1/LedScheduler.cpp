@@ -0,0 +1,141 @@
+#include <chrono>
+
+#include "io/Transport.hpp"
+#include "tkf1/F1Device.hpp"
+#include "tkf1/LedScheduler.hpp"
+#include "tkf1/Mapping.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+using namespace std::chrono_literals;
+using clock = LedScheduler::clock;
+
+Transport rolling_transport(clock::time_point time)
+{
+	Transport transport;
+	transport.rolling = true;
+	transport.bbt_valid = true;
+	transport.bar = 3;
+	transport.beat = 2;
+	transport.tick = 960;
+	transport.beats_per_minute = 120.;
+	transport.time = time;
+	return transport;
+}
+} // namespace
+
+TEST_CASE("LedScheduler::beat_at", "[tkf1][tempo]")
+{
+	const clock::time_point t0{1s};
+	auto transport = rolling_transport(t0);
+
+	SECTION("Beats are extrapolated while rolling")
+	{
+		const auto beat = LedScheduler::beat_at(transport, t0);
+		REQUIRE(beat);
+		REQUIRE(beat->bar == 3);
+		REQUIRE(beat->beat == 1);
+		REQUIRE(beat->length == 500ms);
+		REQUIRE(beat->start == t0 - 250ms);
+
+		// half a beat later, the third beat of the bar starts
+		const auto next = LedScheduler::beat_at(transport, t0 + 250ms);
+		REQUIRE(next->bar == 3);
+		REQUIRE(next->beat == 2);
+		REQUIRE(next->start == t0 + 250ms);
+
+		const auto next_bar =
+			LedScheduler::beat_at(transport, t0 + 1250ms);
+		REQUIRE(next_bar->bar == 4);
+		REQUIRE(next_bar->beat == 0);
+	}
+
+	SECTION("A stopped transport stays on its beat")
+	{
+		transport.rolling = false;
+		const auto beat = LedScheduler::beat_at(transport, t0 + 10s);
+		REQUIRE(beat->bar == 3);
+		REQUIRE(beat->beat == 1);
+	}
+
+	SECTION("Without BBT information there are no beats")
+	{
+		transport.bbt_valid = false;
+		REQUIRE_FALSE(LedScheduler::beat_at(transport, t0));
+	}
+}
+
+TEST_CASE("LedScheduler", "[tkf1][tempo]")
+{
+	const clock::time_point t0{1s};
+
+	LedScheduler::Input input;
+	input.tempo.metronome = true;
+	input.tempo.bar_counter = true;
+	input.transport = rolling_transport(t0);
+
+	LedScheduler scheduler{t0};
+
+	SECTION("Metronome and bar counter follow the transport")
+	{
+		const auto* report = scheduler.tick(t0, input, true);
+		REQUIRE(report != nullptr);
+
+		F1Device::OutputState expected = input.state;
+		expected.stop_btns = {
+			F1Device::DARK,
+			F1Device::FULL_BRIGHTNESS,
+			F1Device::DARK,
+			F1Device::DARK
+		};
+		const auto [left, right] = F1Device::num_to_segments(3);
+		expected.segment_left_char = left;
+		expected.segment_right_char = right;
+		expected.segment_left_brightness = F1Device::FULL_BRIGHTNESS;
+		expected.segment_right_brightness = F1Device::FULL_BRIGHTNESS;
+		F1Device::OutputReport expected_report{};
+		F1Device::encode_output(expected, expected_report);
+		REQUIRE(*report == expected_report);
+
+		// nothing changes until the next beat
+		REQUIRE(scheduler.next_tick(t0) == t0 + 250ms);
+		REQUIRE(scheduler.tick(t0 + 100ms, input, false) == nullptr);
+		REQUIRE(scheduler.tick(t0 + 250ms, input, false) != nullptr);
+	}
+
+	SECTION("Writes are issued ahead by the write latency")
+	{
+		scheduler.tick(t0, input, true);
+		for (int i = 0; i < 100; ++i) {
+			scheduler.write_done(4ms);
+		}
+		REQUIRE(scheduler.latency() > 3ms);
+		REQUIRE(scheduler.latency() <= 4ms);
+
+		const auto latency = scheduler.latency();
+		REQUIRE(scheduler.next_tick(t0) == t0 + 250ms - latency);
+		REQUIRE(
+			scheduler.tick(t0 + 250ms - latency, input, false) !=
+			nullptr
+		);
+	}
+
+	SECTION("Animations last one beat when synced")
+	{
+		input.tempo = {};
+		input.tempo.sync_animations = true;
+		input.state.matrix_btns[0] = F1Device::WHITE;
+		input.animations.buttons[Mapping::BLINK] = 1;
+
+		REQUIRE(scheduler.tick(t0, input, true) != nullptr);
+		// the blink cycle started with the beat, 250ms ago
+		REQUIRE(scheduler.next_tick(t0) == t0 + 250ms);
+		REQUIRE(scheduler.tick(t0 + 250ms, input, false) != nullptr);
+	}
+}
+
+// NOLINTEND(*-magic-numbers)
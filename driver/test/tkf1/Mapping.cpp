@@ -0,0 +1,549 @@
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+#include "io/MidiEvent.hpp"
+#include "tkf1/F1Device.hpp"
+#include "tkf1/IOMapper.hpp"
+#include "tkf1/Mapping.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+Mapping parse(const std::string& text)
+{
+	std::istringstream in{text};
+	return Mapping::load(in, Mapping{}, "test");
+}
+} // namespace
+
+TEST_CASE("Mapping::load", "[tkf1][mapping]")
+{
+	SECTION("Empty file keeps the defaults")
+	{
+		const Mapping mapping = parse("# nothing here\n\n");
+		REQUIRE(mapping.notes.stop == Mapping{}.notes.stop);
+		REQUIRE(mapping.in_channel == Mapping{}.in_channel);
+	}
+
+	SECTION("Settings are parsed")
+	{
+		const Mapping mapping = parse(
+			"[midi]\n"
+			"in_channel = 3\n"
+			"out_channel = 0x0f\n"
+			"; other comment style\n"
+			"[notes]\n"
+			"stop = C4, 61 D4 Eb4\n"
+			"[toggle]\n"
+			"stop = on off yes no\n"
+			"[brightness_mode]\n"
+			"special = note note cc cc hid hid hid hid hid\n"
+			"[brightness]\n"
+			"low_color = 0.5\n"
+			"[colors]\n"
+			"matrix = red green blue #7f0001 "
+			"white white white white "
+			"black black black black "
+			"cyan cyan magenta yellow\n"
+		);
+
+		REQUIRE(mapping.in_channel == 3);
+		REQUIRE(mapping.out_channel == 15);
+		const auto note = &MidiEvent::note_from_name;
+		REQUIRE(mapping.notes.stop[0] == note("C4"));
+		REQUIRE(mapping.notes.stop[1] == 61);
+		REQUIRE(mapping.notes.stop[3] == note("D#4"));
+		REQUIRE(mapping.button_toggle.stop == std::bitset<4>{0b0101});
+		const auto& modes = mapping.brightness_mode.special;
+		REQUIRE(modes[0] == Mapping::MIDI_NOTE);
+		REQUIRE(modes[2] == Mapping::MIDI_CC);
+		REQUIRE(modes[4] == Mapping::HID);
+		REQUIRE(mapping.brightness_low_color == 0.5F);
+		REQUIRE(
+			mapping.matrix_colors[0] ==
+			F1Device::rgb2color(F1Device::FULL_BRIGHTNESS, 0, 0)
+		);
+		REQUIRE(
+			mapping.matrix_colors[3] ==
+			F1Device::rgb2color(0x7f, 0, 1)
+		);
+	}
+
+	SECTION("Banks are parsed")
+	{
+		const Mapping mapping = parse(
+			"[notes]\n"
+			"matrix = 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15\n"
+			"[banks]\n"
+			"count = 2\n"
+			"prev = shift\n"
+			"next = Capture\n"
+			"[bank 2]\n"
+			"notes = 16 17 18 19 20 21 22 23 "
+			"24 25 26 27 28 29 30 31\n"
+		);
+
+		REQUIRE(mapping.banks_num == 2);
+		using Buttons = F1Device::SpecialButtons;
+		REQUIRE(mapping.bank_prev_button == Buttons::SHIFT);
+		REQUIRE(mapping.bank_next_button == Buttons::CAPTURE);
+		REQUIRE(mapping.banks[0].notes[15] == 15);
+		REQUIRE(mapping.banks[1].notes[0] == 16);
+		REQUIRE(
+			mapping.banks[1].controllers ==
+			Mapping{}.banks[1].controllers
+		);
+	}
+
+	SECTION("Animations are parsed")
+	{
+		const Mapping mapping = parse(
+			"[animation]\n"
+			"blink = 5\n"
+			"pulse = off\n"
+			"period = 1000\n"
+		);
+
+		const auto& channels = mapping.animation_channels;
+		REQUIRE(channels[Mapping::BLINK] == 5);
+		REQUIRE(channels[Mapping::PULSE] == Mapping::NO_CHANNEL);
+		REQUIRE(
+			channels[Mapping::CHASE] ==
+			Mapping{}.animation_channels[Mapping::CHASE]
+		);
+		REQUIRE(mapping.animation_period.count() == 1000);
+	}
+
+	SECTION("Tempo settings are parsed")
+	{
+		const Mapping mapping = parse(
+			"[tempo]\n"
+			"metronome = on\n"
+			"bar_counter = yes\n"
+		);
+
+		REQUIRE(mapping.tempo.metronome);
+		REQUIRE(mapping.tempo.bar_counter);
+		REQUIRE_FALSE(mapping.tempo.sync_animations);
+	}
+
+	SECTION("Curves are parsed")
+	{
+		const Mapping mapping = parse(
+			"[curves]\n"
+			"knobs = linear log exp s\n"
+			"faders = user USER linear linear\n"
+			"user = 0 0 0 0 0 0 0 0 "
+			"127 127 127 127 127 127 127 127 127\n"
+		);
+
+		const auto& knobs = mapping.curves.knobs;
+		REQUIRE(knobs[1] == Mapping::LOG);
+		REQUIRE(knobs[2] == Mapping::EXP);
+		REQUIRE(knobs[3] == Mapping::S_CURVE);
+		REQUIRE(mapping.curves.faders[1] == Mapping::USER);
+		REQUIRE(mapping.user_curve[7] == 0);
+		REQUIRE(mapping.user_curve[8] == 127);
+	}
+
+	SECTION("Palette is parsed")
+	{
+		const Mapping mapping = parse(
+			"[palette]\n"
+			"enabled = on\n"
+			"gamma = 1.8\n"
+			"5 = #010203\n"
+			"0x7f = red\n"
+		);
+
+		REQUIRE(mapping.use_palette);
+		REQUIRE(mapping.palette_gamma == 1.8F);
+		REQUIRE(mapping.palette[5] == F1Device::rgb2color(1, 2, 3));
+		REQUIRE(mapping.palette[127] ==
+			F1Device::rgb2color(0x7f, 0, 0));
+		REQUIRE(mapping.palette[6] == Mapping{}.palette[6]);
+	}
+
+	SECTION("Errors are reported with the line number")
+	{
+		const auto require_error = [](const std::string& text,
+					      const std::string& msg) {
+			try {
+				parse(text);
+				FAIL("no error for " << text);
+			} catch (MappingError& e) {
+				INFO(e.what());
+				REQUIRE(std::string{e.what()}.starts_with(msg));
+			}
+		};
+
+		require_error("[foo]\nbar = 1\n", "test:2: unknown section");
+		require_error("[midi]\nfoo = 1\n", "test:2: unknown key");
+		require_error("[midi\n", "test:1: unterminated");
+		require_error("[midi]\nin_channel\n", "test:2: expected key");
+		require_error("[midi]\nin_channel = 16\n", "test:2: value 16");
+		require_error(
+			"[midi]\nin_channel = x\n", "test:2: invalid number"
+		);
+		require_error("[notes]\nstop = C1 D1\n", "test:2: expected 4");
+		require_error("[bank 5]\nnotes = 1\n", "test:2: value 5");
+		require_error("[banks]\ncount = 0\n", "test:2: at least one");
+		require_error(
+			"[banks]\nprev = foo\n", "test:2: invalid special"
+		);
+		require_error(
+			"[banks]\ncount = 2\nprev = shift\nnext = shift\n",
+			"test: bank buttons"
+		);
+		require_error(
+			"[notes]\nstop = C1 D1 E1 H1\n", "test:2: invalid note"
+		);
+		require_error(
+			"[toggle]\nstop = 1 0 1 maybe\n", "test:2: invalid bool"
+		);
+		require_error(
+			"[animation]\nperiod = 10\n", "test:2: animation period"
+		);
+		require_error(
+			"[brightness]\nlow_color = 2\n",
+			"test:2: invalid brightness"
+		);
+		require_error(
+			"[curves]\nknobs = log log log cubic\n",
+			"test:2: invalid curve"
+		);
+		require_error("[palette]\n128 = red\n", "test:2: value 128");
+		require_error(
+			"[palette]\ngamma = 5\n", "test:2: invalid gamma"
+		);
+		require_error("[palette]\nfoo = 1\n", "test:2: unknown key");
+	}
+}
+
+TEST_CASE("MappingTable", "[tkf1][mapping]")
+{
+	Mapping mapping;
+	mapping.brightness_mode.matrix[2] = Mapping::MIDI_NOTE;
+	mapping.brightness_mode.stop[1] = Mapping::MIDI_NOTE;
+	mapping.notes.stop[1] = mapping.banks[0].notes[2];
+	mapping.brightness_mode.special[3] = Mapping::MIDI_CC;
+
+	const MappingTable table{mapping};
+
+	SECTION("Notes map to all buttons using them")
+	{
+		REQUIRE(
+			table.note_buttons[0].at(mapping.banks[0].notes[2]) ==
+			((1U << (MappingTable::MATRIX_SHIFT + 2)) |
+			 (1U << (MappingTable::STOP_SHIFT + 1)))
+		);
+		// HID mode buttons are not controlled by MIDI
+		const auto note = mapping.banks[0].notes[0];
+		REQUIRE(table.note_buttons[0].at(note) == 0);
+	}
+
+	SECTION("Controllers map to buttons in MIDI_CC mode")
+	{
+		const auto cc = mapping.brightness_controllers.special[3];
+		REQUIRE(
+			table.cc_buttons[0].at(cc) ==
+			1U << (MappingTable::SPECIAL_SHIFT + 3)
+		);
+	}
+
+	SECTION("Encoder positions map through the response curves")
+	{
+		// The linear curve rounds like std::lround()
+		for (std::size_t pos = 0; pos <= F1Device::FADERS_MAX; ++pos) {
+			const auto expected = std::lround(
+				static_cast<double>(pos) * 127.0 /
+				F1Device::FADERS_MAX
+			);
+			REQUIRE(table.fader_values[0][pos] == expected);
+		}
+
+		Mapping curved;
+		curved.curves.knobs = {
+			Mapping::LOG,
+			Mapping::EXP,
+			Mapping::S_CURVE,
+			Mapping::USER,
+		};
+		curved.user_curve.fill(0);
+		curved.user_curve.back() = 127;
+		const MappingTable curved_table{curved};
+
+		constexpr std::size_t mid{F1Device::FADERS_MAX / 2};
+		const auto& knobs = curved_table.knob_values;
+		for (const auto& values : knobs) {
+			REQUIRE(values.front() == 0);
+			REQUIRE(values.back() == 127);
+			REQUIRE(std::is_sorted(values.begin(), values.end()));
+		}
+		REQUIRE(knobs[0][mid] > 100);
+		REQUIRE(knobs[1][mid] < 20);
+		// The S-curve is point symmetric around the center
+		REQUIRE(knobs[2][mid] + knobs[2][F1Device::FADERS_MAX - mid] ==
+			127);
+		REQUIRE(knobs[2][mid / 4] < knobs[0][mid / 4] / 2);
+		// Only the last segment of the user curve rises
+		REQUIRE(knobs[3][F1Device::FADERS_MAX * 15 / 16] == 0);
+		const auto user_mid = knobs[3][F1Device::FADERS_MAX * 31 / 32];
+		REQUIRE((user_mid > 60 && user_mid < 68));
+
+		IOMapper io_mapper{curved};
+		F1Device::OutputState output;
+		const auto event = io_mapper.process_HID_input(
+			{F1Device::InputEvent::EventType::ENCODER,
+			 F1Device::InputEvent::InputType::KNOB,
+			 F1Device::InputEvent::EncoderEvent{1, mid}},
+			output
+		);
+		REQUIRE(event);
+		REQUIRE(event->data.controller.value == knobs[1][mid]);
+	}
+
+	SECTION("Controller values scale the button brightness")
+	{
+		Mapping cc_mapping;
+		cc_mapping.brightness_mode.matrix[0] = Mapping::MIDI_CC;
+		cc_mapping.brightness_mode.special[3] = Mapping::MIDI_CC;
+		cc_mapping.matrix_colors[0] =
+			F1Device::rgb2color(0x7f, 0x40, 1);
+		IOMapper io_mapper{cc_mapping};
+		F1Device::OutputState output;
+
+		const auto send = [&](MidiEvent::byte cc,
+				      MidiEvent::byte value) {
+			return io_mapper.process_MIDI_event(
+				MidiEvent::control_change(
+					cc, value, cc_mapping.in_channel
+				),
+				output
+			);
+		};
+
+		const auto matrix_cc = cc_mapping.banks[0].controllers[0];
+		REQUIRE(send(matrix_cc, 127));
+		REQUIRE(output.matrix_btns[0] == cc_mapping.matrix_colors[0]);
+		REQUIRE(send(matrix_cc, 64));
+		REQUIRE(output.matrix_btns[0] ==
+			F1Device::rgb2color(0x40, 0x20, 0));
+		REQUIRE(send(matrix_cc, 0));
+		REQUIRE(output.matrix_btns[0] == F1Device::rgb2color(0, 0, 0));
+
+		const auto special_cc =
+			cc_mapping.brightness_controllers.special[3];
+		REQUIRE(send(special_cc, 0x42));
+		REQUIRE(output.special_btns[3] == 0x42);
+	}
+
+	SECTION("Palette colors are gamma corrected")
+	{
+		const auto& palette = Mapping{}.palette;
+		REQUIRE(palette[0] == F1Device::BLACK);
+		REQUIRE(palette[7] == F1Device::rgb2color(0x7f, 0, 0));
+		REQUIRE(palette[127] == F1Device::WHITE);
+		REQUIRE(palette[123] == F1Device::rgb2color(54, 54, 54));
+
+		for (std::size_t i = 0; i < Mapping::PALETTE_SIZE; ++i) {
+			const auto [r, g, b] = F1Device::color2rgb(palette[i]);
+			const auto correct = [](F1Device::Brightness value) {
+				const double x = value / 127.0;
+				return static_cast<F1Device::Brightness>(
+					std::lround(std::pow(x, 2.2) * 127.0)
+				);
+			};
+			REQUIRE(table.palette[i] ==
+				F1Device::rgb2color(
+					correct(r), correct(g), correct(b)
+				));
+		}
+
+		Mapping linear;
+		linear.palette_gamma = 1.F;
+		REQUIRE(MappingTable{linear}.palette == linear.palette);
+	}
+
+	SECTION("Note velocity and controller value select palette colors")
+	{
+		Mapping palette_mapping{mapping};
+		palette_mapping.use_palette = true;
+		palette_mapping.brightness_mode.matrix[5] = Mapping::MIDI_CC;
+		const MappingTable palette_table{palette_mapping};
+		IOMapper io_mapper{palette_mapping};
+		F1Device::OutputState output;
+
+		const auto note = palette_mapping.banks[0].notes[2];
+		const auto channel = palette_mapping.in_channel;
+		REQUIRE(io_mapper.process_MIDI_event(
+			MidiEvent{MidiEvent::Type::NOTE_ON, channel, note, 21},
+			output
+		));
+		REQUIRE(output.matrix_btns[2] == palette_table.palette[21]);
+		// Special and stop buttons still use the brightness settings
+		REQUIRE(output.stop_btns[1] == mapping.brightness_high);
+
+		REQUIRE(io_mapper.process_MIDI_event(
+			MidiEvent{MidiEvent::Type::NOTE_OFF, channel, note, 21},
+			output
+		));
+		REQUIRE(output.matrix_btns[2] == palette_table.palette[0]);
+
+		const auto cc = palette_mapping.banks[0].controllers[5];
+		REQUIRE(io_mapper.process_MIDI_event(
+			MidiEvent::control_change(cc, 98, channel), output
+		));
+		REQUIRE(output.matrix_btns[5] == palette_table.palette[98]);
+	}
+
+	SECTION("IOMapper lights all buttons mapped to a note")
+	{
+		IOMapper io_mapper{mapping};
+		F1Device::OutputState output;
+
+		REQUIRE(io_mapper.process_MIDI_event(
+			MidiEvent{
+				MidiEvent::Type::NOTE_ON,
+				mapping.in_channel,
+				mapping.banks[0].notes[2],
+				127
+			},
+			output
+		));
+		REQUIRE(output.matrix_btns[2] == table.matrix_high[2]);
+		REQUIRE(output.stop_btns[1] == mapping.brightness_high);
+
+		// Messages on other channels are ignored
+		REQUIRE_FALSE(io_mapper.process_MIDI_event(
+			MidiEvent{
+				MidiEvent::Type::NOTE_OFF,
+				static_cast<MidiEvent::byte>(
+					mapping.in_channel + 1
+				),
+				mapping.banks[0].notes[2],
+				0
+			},
+			output
+		));
+	}
+
+	SECTION("set_mapping replaces the mapping")
+	{
+		IOMapper io_mapper{};
+		F1Device::OutputState output;
+		const MidiEvent note{
+			MidiEvent::Type::NOTE_ON,
+			mapping.in_channel,
+			mapping.banks[0].notes[2],
+			127
+		};
+
+		REQUIRE_FALSE(io_mapper.process_MIDI_event(note, output));
+		io_mapper.set_mapping(mapping);
+		REQUIRE(io_mapper.process_MIDI_event(note, output));
+	}
+}
+
+TEST_CASE("IOMapper banks", "[tkf1][mapping]")
+{
+	using InputEvent = F1Device::InputEvent;
+	using Buttons = F1Device::SpecialButtons;
+
+	Mapping mapping;
+	mapping.banks_num = 3;
+	mapping.brightness_mode.matrix.fill(Mapping::MIDI_NOTE);
+	const MappingTable table{mapping};
+
+	IOMapper io_mapper{mapping};
+	F1Device::OutputState output;
+	io_mapper.init_output(output);
+
+	const auto special = [&](std::uint8_t idx, bool press) {
+		return io_mapper.process_HID_input(
+			InputEvent{
+				InputEvent::EventType::BUTTON,
+				InputEvent::InputType::SPECIAL,
+				InputEvent::ButtonEvent{idx, press}
+			},
+			output
+		);
+	};
+	const auto matrix = [&](std::uint8_t idx, bool press) {
+		return io_mapper.process_HID_input(
+			InputEvent{
+				InputEvent::EventType::BUTTON,
+				InputEvent::InputType::MATRIX,
+				InputEvent::ButtonEvent{idx, press}
+			},
+			output
+		);
+	};
+	const auto note_on = [&](std::size_t bank, std::size_t idx) {
+		return io_mapper.process_MIDI_event(
+			MidiEvent{
+				MidiEvent::Type::NOTE_ON,
+				mapping.in_channel,
+				mapping.banks.at(bank).notes.at(idx),
+				127
+			},
+			output
+		);
+	};
+
+	REQUIRE(io_mapper.current_bank() == 0);
+	REQUIRE(output.segment_right_char == F1Device::SegmentChar::D1);
+
+	SECTION("Bank buttons switch banks and don't emit MIDI events")
+	{
+		REQUIRE_FALSE(special(Buttons::SIZE, true));
+		REQUIRE_FALSE(special(Buttons::SIZE, false));
+		REQUIRE(io_mapper.current_bank() == 1);
+		REQUIRE(output.segment_right_char == F1Device::SegmentChar::D2);
+
+		REQUIRE_FALSE(special(Buttons::BROWSE, true));
+		REQUIRE_FALSE(special(Buttons::BROWSE, false));
+		REQUIRE_FALSE(special(Buttons::BROWSE, true));
+		REQUIRE(io_mapper.current_bank() == 2);
+		REQUIRE(output.segment_right_char == F1Device::SegmentChar::D3);
+	}
+
+	SECTION("Matrix buttons emit the notes of the current bank")
+	{
+		special(Buttons::SIZE, true);
+		const auto pressed = matrix(5, true);
+		REQUIRE(pressed);
+		REQUIRE(pressed->data.note.note == mapping.banks[1].notes[5]);
+
+		// released in the bank it was pressed in
+		special(Buttons::SIZE, true);
+		const auto released = matrix(5, false);
+		REQUIRE(released);
+		REQUIRE(released->data.note.note == mapping.banks[1].notes[5]);
+	}
+
+	SECTION("LED state is cached per bank")
+	{
+		REQUIRE_FALSE(note_on(1, 4));
+		REQUIRE(output.matrix_btns[4] == F1Device::BLACK);
+		REQUIRE(note_on(0, 3));
+		REQUIRE(output.matrix_btns[3] == table.matrix_high[3]);
+
+		special(Buttons::SIZE, true);
+		REQUIRE(output.matrix_btns[3] == F1Device::BLACK);
+		REQUIRE(output.matrix_btns[4] == table.matrix_high[4]);
+
+		special(Buttons::BROWSE, true);
+		REQUIRE(output.matrix_btns[3] == table.matrix_high[3]);
+		REQUIRE(output.matrix_btns[4] == F1Device::BLACK);
+	}
+}
+
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "tkf1/F1Device.hpp"
+
+/**
+ * Encode an output state into a new report
+ *
+ * Output states have no comparison operator, so tests compare their reports.
+ */
+inline F1Device::OutputReport encode(const F1Device::OutputState& state)
+{
+	F1Device::OutputReport report{};
+	F1Device::encode_output(state, report);
+	return report;
+}
@@ -0,0 +1,110 @@
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "tkf1/StateExport.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+std::string segment_name()
+{
+	return "/tkf1-test-" + std::to_string(getpid());
+}
+
+/**
+ * Count the bytes of a report not matching its first byte
+ */
+std::size_t count_torn(const F1Device::OutputReport& report)
+{
+	std::size_t torn{0};
+	for (const auto byte : report) {
+		if (byte != report[0]) {
+			++torn;
+		}
+	}
+	return torn;
+}
+} // namespace
+
+TEST_CASE("StateExport", "[tkf1][shm]")
+{
+	const std::string name = segment_name();
+
+	SECTION("Readers need an existing segment")
+	{
+		REQUIRE_THROWS_AS(StateReader{name}, StateExportError);
+	}
+
+	SECTION("Published reports are read")
+	{
+		StateExport exporter{name};
+		const StateReader reader{name};
+		REQUIRE(reader.writer_alive());
+
+		F1Device::InputReport input{};
+		input[0] = F1Device::INPUT_REPORT_ID;
+		input[5] = 0x42; // wheel
+		exporter.publish_input(input);
+		REQUIRE(reader.input_report() == input);
+		REQUIRE(reader.input().wheel == 0x42);
+
+		F1Device::OutputState state{};
+		state.stop_btns[2] = F1Device::FULL_BRIGHTNESS;
+		F1Device::OutputReport output{};
+		F1Device::encode_output(state, output);
+		exporter.publish_output(output);
+		REQUIRE(reader.output_report() == output);
+		REQUIRE(reader.output().stop_btns == state.stop_btns);
+	}
+
+	SECTION("The segment is removed with the exporter")
+	{
+		{
+			const StateExport exporter{name};
+		}
+		REQUIRE_THROWS_AS(StateReader{name}, StateExportError);
+	}
+
+	SECTION("Concurrent readers never see partial reports")
+	{
+		constexpr std::size_t READERS{4};
+		constexpr std::uint32_t UPDATES{50000};
+
+		StateExport exporter{name};
+		std::atomic<bool> done{false};
+		std::atomic<std::size_t> torn{0};
+
+		std::vector<std::thread> readers;
+		for (std::size_t i = 0; i < READERS; ++i) {
+			readers.emplace_back([&]() {
+				const StateReader reader{name};
+				while (not done) {
+					torn += count_torn(reader.output_report());
+				}
+			});
+		}
+
+		F1Device::OutputReport report{};
+		for (std::uint32_t i = 1; i <= UPDATES; ++i) {
+			report.fill(static_cast<std::uint8_t>(i));
+			exporter.publish_output(report);
+		}
+		done = true;
+		for (auto& reader : readers) {
+			reader.join();
+		}
+
+		REQUIRE(torn == 0);
+	}
+}
+
+// NOLINTEND(*-magic-numbers)
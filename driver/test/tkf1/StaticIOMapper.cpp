@@ -0,0 +1,191 @@
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "io/MidiEvent.hpp"
+#include "tkf1/F1Device.hpp"
+#include "tkf1/IOMapper.hpp"
+#include "tkf1/Mapping.hpp"
+#include "tkf1/StaticIOMapper.hpp"
+
+#include "OutputReport.hpp"
+
+// NOLINTBEGIN(*-magic-numbers)
+
+namespace
+{
+using InputEvent = F1Device::InputEvent;
+
+struct TestRig {
+	constexpr static Mapping MAPPING = []() {
+		Mapping m;
+		m.out_channel = 2;
+		m.in_channel = 3;
+		m.button_toggle.matrix = std::bitset<16>{0x00ff};
+		m.brightness_mode.matrix.fill(Mapping::MIDI_NOTE);
+		m.brightness_mode.special.at(0) = Mapping::MIDI_CC;
+		m.brightness_mode.stop.at(1) = Mapping::MIDI_NOTE;
+		return m;
+	}();
+};
+
+struct DefaultRig {
+	constexpr static Mapping MAPPING{};
+};
+
+/**
+ * A mix of all kinds of input events
+ */
+std::vector<InputEvent> input_events()
+{
+	std::vector<InputEvent> events;
+	for (std::uint8_t i = 0; i < F1Device::MATRIX_BUTTONS_NUM; ++i) {
+		for (const bool press : {true, false}) {
+			events.push_back(
+				{InputEvent::EventType::BUTTON,
+				 InputEvent::InputType::MATRIX,
+				 InputEvent::ButtonEvent{i, press}}
+			);
+		}
+	}
+	for (std::uint8_t i = 0; i < F1Device::STOP_BUTTONS_NUM; ++i) {
+		events.push_back(
+			{InputEvent::EventType::BUTTON,
+			 InputEvent::InputType::STOP,
+			 InputEvent::ButtonEvent{i, true}}
+		);
+		events.push_back(
+			{InputEvent::EventType::ENCODER,
+			 InputEvent::InputType::FADER,
+			 InputEvent::EncoderEvent{i, static_cast<std::uint16_t>(
+							     i * 1000U
+						     )}}
+		);
+	}
+	events.push_back(
+		{InputEvent::EventType::BUTTON,
+		 InputEvent::InputType::SPECIAL,
+		 InputEvent::ButtonEvent{0, true}}
+	);
+	events.push_back(
+		{InputEvent::EventType::ENCODER,
+		 InputEvent::InputType::WHEEL,
+		 InputEvent::WheelEvent{1, 0}}
+	);
+	return events;
+}
+
+/**
+ * A mix of note and controller messages on the input channel
+ */
+std::vector<MidiEvent> midi_events(const Mapping& mapping)
+{
+	std::vector<MidiEvent> events;
+	for (const auto note : mapping.banks[0].notes) {
+		events.emplace_back(
+			MidiEvent::Type::NOTE_ON, mapping.in_channel, note, 127
+		);
+	}
+	for (const auto note : mapping.notes.stop) {
+		events.emplace_back(
+			MidiEvent::Type::NOTE_OFF, mapping.in_channel, note, 0
+		);
+	}
+	const auto cc = mapping.brightness_controllers.special[0];
+	events.push_back(
+		MidiEvent::control_change(cc, 64, mapping.in_channel)
+	);
+	return events;
+}
+} // namespace
+
+TEST_CASE("StaticIOMapper", "[tkf1][mapping]")
+{
+	constexpr const MappingTable& table = StaticMappingTables<
+		TestRig>::TABLE;
+	constexpr auto note = TestRig::MAPPING.banks[0].notes[5];
+	STATIC_REQUIRE(table.config.out_channel == 2);
+	STATIC_REQUIRE(table.note_buttons[0].at(note) == 1U << 5);
+
+	StaticIOMapper<TestRig> static_mapper;
+	IOMapper runtime_mapper{TestRig::MAPPING};
+	F1Device::OutputState static_output;
+	F1Device::OutputState runtime_output;
+	static_mapper.init_output(static_output);
+	runtime_mapper.init_output(runtime_output);
+
+	SECTION("Behaves like IOMapper for HID input")
+	{
+		for (const auto& event : input_events()) {
+			const auto expected = runtime_mapper.process_HID_input(
+				event, runtime_output
+			);
+			const auto midi = static_mapper.process_HID_input(
+				event, static_output
+			);
+			REQUIRE(midi.has_value() == expected.has_value());
+			if (midi) {
+				REQUIRE(*midi == *expected);
+				REQUIRE(midi->channel == 2);
+			}
+			REQUIRE(encode(static_output) ==
+				encode(runtime_output));
+		}
+	}
+
+	SECTION("Behaves like IOMapper for MIDI input")
+	{
+		for (const auto& event : midi_events(TestRig::MAPPING)) {
+			const bool expected = runtime_mapper.process_MIDI_event(
+				event, runtime_output
+			);
+			REQUIRE(static_mapper.process_MIDI_event(
+					event, static_output
+				) == expected);
+			REQUIRE(encode(static_output) ==
+				encode(runtime_output));
+		}
+	}
+}
+
+/*
+ * Compare the runtime-configurable and the static mapper with the default
+ * mapping. Hidden by default, run with: tests "[benchmark]"
+ */
+TEST_CASE("StaticIOMapper benchmark", "[.][benchmark][tkf1][mapping]")
+{
+	const auto hid_events = input_events();
+	const auto midi = midi_events(DefaultRig::MAPPING);
+	F1Device::OutputState output;
+
+	IOMapper runtime_mapper{DefaultRig::MAPPING};
+	StaticIOMapper<DefaultRig> static_mapper;
+
+	const auto run = [&](auto& mapper) {
+		std::size_t emitted{0};
+		for (const auto& event : hid_events) {
+			emitted += mapper.process_HID_input(event, output)
+					   .has_value();
+		}
+		for (const auto& event : midi) {
+			emitted += mapper.process_MIDI_event(event, output);
+		}
+		return emitted;
+	};
+
+	BENCHMARK("IOMapper")
+	{
+		return run(runtime_mapper);
+	};
+
+	BENCHMARK("StaticIOMapper")
+	{
+		return run(static_mapper);
+	};
+}
+
+// NOLINTEND(*-magic-numbers)